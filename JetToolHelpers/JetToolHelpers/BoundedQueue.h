@@ -0,0 +1,80 @@
+/**
+ * @file BoundedQueue.h
+ * @author S. Schramm, A. Freeman
+ * @brief Blocking FIFO of fixed capacity used to connect the stages of a pipeline
+ * running on different threads.
+ * @copyright Copyright (C) 2002-2022 CERN for the benefit of the ATLAS collaboration
+ *
+ */
+
+#ifndef JET_BOUNDEDQUEUE_H
+#define JET_BOUNDEDQUEUE_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+
+/**
+ * @brief FIFO connecting a producer stage to a consumer stage. A full queue blocks
+ * the producer, which bounds the memory held by the stages in flight.
+ *
+ * @tparam T the work item, moved in and out of the queue.
+ */
+template <typename T> class BoundedQueue {
+    public:
+        explicit BoundedQueue(const std::size_t capacity) : m_capacity{capacity ? capacity : 1} {}
+
+        /**
+         * @brief Push an item, waiting while the queue is full.
+         * @return false if the queue was closed, the item is then dropped.
+         */
+        bool push(T item) {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_notFull.wait(lock, [this] { return m_closed || m_items.size() < m_capacity; });
+            if (m_closed)
+                return false;
+            m_items.push_back(std::move(item));
+            lock.unlock();
+            m_notEmpty.notify_one();
+            return true;
+        }
+
+        /**
+         * @brief Pop the oldest item, waiting while the queue is empty.
+         * @return false once the queue is closed and drained.
+         */
+        bool pop(T& item) {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_notEmpty.wait(lock, [this] { return m_closed || !m_items.empty(); });
+            if (m_items.empty())
+                return false;
+            item = std::move(m_items.front());
+            m_items.pop_front();
+            lock.unlock();
+            m_notFull.notify_one();
+            return true;
+        }
+
+        /**
+         * @brief No more items will be pushed, consumers drain what is left.
+         */
+        void close() {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_closed = true;
+            }
+            m_notEmpty.notify_all();
+            m_notFull.notify_all();
+        }
+
+    private:
+        const std::size_t m_capacity;
+        bool m_closed {false};
+        std::deque<T> m_items;
+        std::mutex m_mutex;
+        std::condition_variable m_notEmpty;
+        std::condition_variable m_notFull;
+};
+
+#endif
@@ -0,0 +1,140 @@
+/**
+ * @file ChebyshevSurrogate.h
+ * @author S. Schramm, A. Freeman
+ * @brief Chebyshev expansion replacing the bin search and interpolation of a smooth
+ * histogram by a fixed sequence of multiply-adds.
+ * @copyright Copyright (C) 2002-2022 CERN for the benefit of the ATLAS collaboration
+ *
+ */
+
+#ifndef JET_CHEBYSHEVSURROGATE_H
+#define JET_CHEBYSHEVSURROGATE_H
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "HistoTable.h"
+
+/**
+ * @brief Tensor product Chebyshev expansion of HistoTable::interpolate() over the
+ * bin centers of the table. Outside of the centers the interpolation is flat, which
+ * the surrogate reproduces by clamping its inputs to them.
+ */
+class ChebyshevSurrogate {
+    public:
+        static constexpr int MAXDEGREE {64};
+
+        /**
+         * @brief Fit expansions of increasing degree until one is within maxError of the
+         * table interpolation everywhere. The difference is measured on the edges, quarter
+         * and center points of every bin (every cell in 2D) and on 4*(degree+1) points per
+         * axis between the outer bin centers. Between them, the interpolation being
+         * linear along each axis, it is bounded by adding gap^2/8 times the second
+         * derivative of the expansion, bounded by Markov's inequality on each Chebyshev
+         * term. Gaps are split, up to 16 times, until that takes at most half of maxError.
+         * @param maxDegree highest degree tried along each axis, at most MAXDEGREE.
+         * @param achievedError set to the bound on the error of the returned surrogate,
+         * or to the smallest bound reached if none was within maxError.
+         * @return nullptr if no expansion up to maxDegree is within maxError.
+         */
+        static std::shared_ptr<const ChebyshevSurrogate> fit(const HistoTable& table, const double maxError,
+            const int maxDegree, double& achievedError);
+
+        double evaluate(const double x) const {
+            return clenshaw(m_coefficients.data(), m_nCoefficients[0], toUnit(0, x));
+        }
+
+        double evaluate(const double x, const double y) const {
+            const int nX {m_nCoefficients[0]};
+            const double tX {toUnit(0, x)};
+            const double tY {toUnit(1, y)};
+            // Clenshaw along y, on the x expansions of each y coefficient
+            double b1 {0}, b2 {0};
+            for (int j = m_nCoefficients[1] - 1; j > 0; --j) {
+                const double b0 {clenshaw(m_coefficients.data() + nX*j, nX, tX) + 2*tY*b1 - b2};
+                b2 = b1;
+                b1 = b0;
+            }
+            return clenshaw(m_coefficients.data(), nX, tX) + tY*b1 - b2;
+        }
+
+        /**
+         * @brief evaluate() and its derivative along x in gradient[0], 0 outside of the
+         * bin centers where the inputs are clamped.
+         */
+        double evaluate(const double x, double* gradient) const {
+            const double tX {toUnit(0, x)};
+            gradient[0] = derivative(m_coefficients.data(), m_nCoefficients[0], tX) * unitSlope(0, x);
+            return clenshaw(m_coefficients.data(), m_nCoefficients[0], tX);
+        }
+
+        /**
+         * @brief evaluate() and its partial derivatives along x and y in gradient[0]
+         * and gradient[1].
+         */
+        double evaluate(const double x, const double y, double* gradient) const {
+            const int nX {m_nCoefficients[0]};
+            const int nY {m_nCoefficients[1]};
+            const double tX {toUnit(0, x)};
+            const double tY {toUnit(1, y)};
+            // The x expansion of each y coefficient and its derivative, then both along y
+            double rows[MAXDEGREE + 1];
+            double rowDerivatives[MAXDEGREE + 1];
+            for (int j = 0; j < nY; ++j) {
+                rows[j] = clenshaw(m_coefficients.data() + nX*j, nX, tX);
+                rowDerivatives[j] = derivative(m_coefficients.data() + nX*j, nX, tX);
+            }
+            gradient[0] = clenshaw(rowDerivatives, nY, tY) * unitSlope(0, x);
+            gradient[1] = derivative(rows, nY, tY) * unitSlope(1, y);
+            return clenshaw(rows, nY, tY);
+        }
+
+        int getNDims() const { return m_nDims; }
+        int getDegree(const int axis) const { return m_nCoefficients[axis] - 1; }
+        std::size_t getNumBytes() const { return sizeof(*this) + m_coefficients.size() * sizeof(double); }
+
+    private:
+        ChebyshevSurrogate() = default;
+
+        // Maps [low, high] to [-1, 1], values outside are clamped
+        double toUnit(const int axis, const double x) const {
+            const double clamped {std::min(std::max(x, m_low[axis]), m_high[axis])};
+            return (2*clamped - m_low[axis] - m_high[axis]) * m_invWidth[axis];
+        }
+
+        // Derivative of toUnit()
+        double unitSlope(const int axis, const double x) const {
+            return x < m_low[axis] || x > m_high[axis] ? 0 : 2*m_invWidth[axis];
+        }
+
+        // Derivative of the expansion : sum of k*c_k*U_{k-1}(t), Clenshaw on the U basis
+        static double derivative(const double* coefficients, const int n, const double t) {
+            double b1 {0}, b2 {0};
+            for (int k = n - 1; k > 0; --k) {
+                const double b0 {k*coefficients[k] + 2*t*b1 - b2};
+                b2 = b1;
+                b1 = b0;
+            }
+            return b1;
+        }
+
+        static double clenshaw(const double* coefficients, const int n, const double t) {
+            double b1 {0}, b2 {0};
+            for (int k = n - 1; k > 0; --k) {
+                const double b0 {coefficients[k] + 2*t*b1 - b2};
+                b2 = b1;
+                b1 = b0;
+            }
+            return coefficients[0] + t*b1 - b2;
+        }
+
+        int m_nDims;
+        int m_nCoefficients[2];
+        double m_low[2];
+        double m_high[2];
+        double m_invWidth[2];                   // 1/(high-low), 0 for single bin axes
+        std::vector<double> m_coefficients;     // x varying fastest
+};
+
+#endif
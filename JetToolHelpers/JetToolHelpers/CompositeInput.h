@@ -0,0 +1,156 @@
+/**
+ * @file CompositeInput.h
+ * @author S. Schramm, A. Freeman
+ * @brief Combines several inputs with an arithmetic operation, e.g. the product of the
+ * calibration factors of successive steps.
+ * @copyright Copyright (C) 2002-2022 CERN for the benefit of the ATLAS collaboration
+ *
+ */
+
+#ifndef JET_COMPOSITEINPUT_H
+#define JET_COMPOSITEINPUT_H
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "JetToolHelpers/HistoInput.h"
+#include "JetToolHelpers/HistoLoader.h"
+#include "JetToolHelpers/HistoTable.h"
+#include "JetToolHelpers/IInputBase.h"
+#include "JetToolHelpers/InputVariable.h"
+#include "JetToolHelpers/JetContext.h"
+
+/**
+ * @brief How the values of the children are combined : Sum and Product over any number
+ * of children, Difference (first minus second) and Ratio (first over second) of two.
+ */
+enum class CompositeOperation { Sum, Difference, Product, Ratio };
+
+/**
+ * @brief Evaluates an arithmetic combination of child inputs, which it owns.
+ *
+ * When all the children are HistoInputs reading the same variables, their values are
+ * computed from a single read of the variables. When their histograms also have the
+ * same binning, initialize() folds them into a single table holding the combined
+ * contents, so that one lookup replaces one per child :
+ *  - sums and differences are folded exactly, the interpolation being linear in the
+ *    contents.
+ *  - products and ratios of interpolations aren't interpolations of the products or
+ *    ratios, they are only folded if setFoldingTolerance() allows for the difference.
+ *    Otherwise the contents of the children are kept side by side : the bin and the
+ *    interpolation weights are found once and applied to the contents of each child,
+ *    which gives the combination of their interpolations exactly.
+ * Otherwise the children are evaluated one after the other.
+ */
+class CompositeInput : public IInputBase {
+    public:
+        /**
+         * @brief Construct a new Composite Input object.
+         *
+         * @param name the name of the input.
+         * @param operation how the values of the children are combined.
+         * @param children the combined inputs, in order, not initialized yet. Difference
+         * and Ratio take exactly two.
+         */
+        CompositeInput(
+            const std::string& name,
+            CompositeOperation operation,
+            std::vector<std::unique_ptr<IInputBase>> children
+        );
+        virtual ~CompositeInput() {}
+
+        /**
+         * @brief Initialize the children, then fold them if possible. The children of a
+         * folded input are finalized, only the folded table is kept.
+         */
+        virtual bool initialize();
+        virtual bool finalize();
+
+        virtual bool getValue(const xAOD::Jet& jet, const JetContext& event, double& value) const;
+
+        /**
+         * @brief Evaluate a batch of nValues entries in one call, see HistoInput::getValues().
+         * @return false if not initialized, if the children aren't HistoInputs reading
+         * the same variables or if they don't have the dimension of the batch.
+         */
+        bool getValues(const double* x, double* values, std::size_t nValues, std::size_t stride = 1) const;
+        bool getValues(const float*  x, double* values, std::size_t nValues, std::size_t stride = 1) const;
+        bool getValues(const double* x, const double* y, double* values, std::size_t nValues, std::size_t stride = 1) const;
+        bool getValues(const float*  x, const float*  y, double* values, std::size_t nValues, std::size_t stride = 1) const;
+
+        /**
+         * @brief Opt in to folding products and ratios : initialize() folds them if the
+         * folded table is within maxError of evaluating the children everywhere, not only
+         * at the points sampled. The difference is bounded from above over each cell
+         * between bin centers, the cells being halved up to 4 times where the bound is
+         * above maxError : tolerances close to the largest difference may not fold. Sums
+         * and differences are always folded. Applies from the next initialize().
+         */
+        void setFoldingTolerance(const double maxError) { m_foldingTolerance = maxError; }
+
+        /**
+         * @brief Whether initialize() folded the children into a single table.
+         */
+        bool isFolded() const { return m_table != nullptr; }
+
+        /**
+         * @brief Whether initialize() kept the contents of the children side by side, for
+         * products and ratios with the same binning that aren't folded.
+         */
+        bool isFused() const { return m_fused != nullptr; }
+
+        /**
+         * @brief The folded table, nullptr if the children are evaluated.
+         */
+        std::shared_ptr<const HistoTable> getTable() const { return m_table; }
+
+        CompositeOperation getOperation() const { return m_operation; }
+        std::size_t getNumChildren() const { return m_children.size(); }
+
+    private:
+        double combine(const double result, const double value) const {
+            switch (m_operation) {
+                case CompositeOperation::Sum: return result + value;
+                case CompositeOperation::Difference: return result - value;
+                case CompositeOperation::Product: return result * value;
+                default: return result / value;
+            }
+        }
+
+        // The histograms of the children, false unless they all have the same binning
+        bool loadHistos(std::vector<LoadedHisto>& histos) const;
+        // The table of the combined contents of histos, nullptr if they cannot be folded
+        std::shared_ptr<const HistoTable> fold(const std::vector<LoadedHisto>& histos) const;
+        // Keeps the contents of histos side by side in m_fusedContents
+        void fuse(const std::vector<LoadedHisto>& histos);
+        // Bound on the difference between the interpolations of folded and of histos, everywhere.
+        // Refined until within the folding tolerance, returned once above it
+        double getFoldingBound(const std::vector<LoadedHisto>& histos, const LoadedHisto& folded) const;
+        double evaluate(const HistoTable& table, float varValue1, float varValue2, HistoCell& cell) const;
+        // The combination of the interpolations of the fused contents
+        double evaluateFused(float varValue1, float varValue2, HistoCell& cell) const;
+        double combineBin(const int binX, const int binY) const;
+        template <typename T> bool evaluateBatch(const T* x, const T* y, double* values,
+            std::size_t nValues, std::size_t stride) const;
+
+        const CompositeOperation m_operation;
+        std::vector<std::unique_ptr<IInputBase>> m_children;
+        double m_foldingTolerance {0};      // products and ratios aren't folded by default
+
+        // The children if they are all HistoInputs reading the same variables, empty otherwise
+        std::vector<const HistoInput*> m_histos;
+        int m_nDims {0};
+        std::unique_ptr<InputVariable> m_inVar1;
+        std::unique_ptr<InputVariable> m_inVar2;
+
+        std::shared_ptr<const HistoTable> m_table;
+        // The binning of the fused children, its contents those of the first one
+        std::shared_ptr<const HistoTable> m_fused;
+        // The contents of the children side by side, per bin, x varying fastest
+        std::vector<double> m_fusedContents;
+        bool m_initialized {false};
+};
+
+#endif
@@ -0,0 +1,121 @@
+/**
+ * @file EpochReclaimer.h
+ * @author S. Schramm, A. Freeman
+ * @brief Epoch based reclamation of objects replaced while other threads may still
+ * be reading them.
+ * @copyright Copyright (C) 2002-2022 CERN for the benefit of the ATLAS collaboration
+ *
+ */
+
+#ifndef JET_EPOCHRECLAIMER_H
+#define JET_EPOCHRECLAIMER_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Readers enter a Guard before loading a published pointer and only use it
+ * within the guard. A writer swaps the pointer and retires the old object, which is
+ * deleted once every reader that could have loaded it has left its guard.
+ *
+ * Readers never block : a guard is two atomic stores to a slot owned by the thread.
+ * Only writers take a lock, to manage the retired objects. Where the kernel provides
+ * membarrier(), writers order the readers' stores for them and the stores are plain
+ * stores, otherwise each guard costs a full fence.
+ */
+class EpochReclaimer {
+    public:
+        static constexpr std::size_t MAXTHREADS {512};
+
+        static EpochReclaimer& instance() {
+            static EpochReclaimer reclaimer;
+            return reclaimer;
+        }
+
+        /**
+         * @brief Marks the calling thread as reading until destruction. Guards may be nested.
+         * @exception std::runtime_error if MAXTHREADS other live threads have read : each
+         * holds a slot until it exits.
+         */
+        class Guard {
+            public:
+                Guard() {
+                    if (t_reader.depth > 0) {
+                        ++t_reader.depth;
+                        return;
+                    }
+                    EpochReclaimer& reclaimer {instance()};
+                    // Counted once registered : a thread failing to register stays outermost
+                    if (!t_reader.epoch)
+                        reclaimer.registerThread();
+                    t_reader.depth = 1;
+                    // The store must be ordered before the loads of published pointers
+                    if (reclaimer.m_asymmetric) {
+                        t_reader.epoch->store(reclaimer.m_epoch.load(std::memory_order_relaxed), std::memory_order_relaxed);
+                        std::atomic_signal_fence(std::memory_order_seq_cst);
+                    } else {
+                        t_reader.epoch->store(reclaimer.m_epoch.load());
+                    }
+                }
+                ~Guard() {
+                    if (--t_reader.depth == 0)
+                        t_reader.epoch->store(0, std::memory_order_release);
+                }
+                Guard(const Guard&) = delete;
+                Guard& operator=(const Guard&) = delete;
+        };
+
+        /**
+         * @brief Delete object once no reader can hold it anymore. Must be called after
+         * the pointer to object was replaced in the place readers load it from.
+         */
+        template <typename T> void retire(const T* object) {
+            if (object)
+                retire(std::function<void()>([object]() { delete object; }));
+        }
+
+        /**
+         * @brief Delete the retired objects no reader can hold anymore.
+         * @return the number of objects still waiting for readers.
+         */
+        std::size_t reclaim();
+
+        ~EpochReclaimer();
+
+    private:
+        EpochReclaimer();
+
+        void retire(std::function<void()> deleter);
+
+        struct alignas(64) Slot {
+            std::atomic<std::uint64_t> epoch {0};   // epoch at which the reader entered, 0 if not reading
+            std::atomic<bool> used {false};
+        };
+
+        // Slot of the calling thread and depth of its nested guards. Trivial so that
+        // guards access it directly, the slot is released by registerThread().
+        struct Reader {
+            std::atomic<std::uint64_t>* epoch {nullptr};
+            int depth {0};
+        };
+        static thread_local Reader t_reader;
+
+        friend class Guard;
+        void registerThread();
+
+        bool m_asymmetric {false};      // writers issue membarrier() for the readers
+        std::atomic<std::uint64_t> m_epoch {1};
+        std::array<Slot, MAXTHREADS> m_slots;
+
+        std::mutex m_mutex;     // writers only
+        std::vector<std::pair<std::uint64_t, std::function<void()>>> m_retired;
+};
+
+inline thread_local EpochReclaimer::Reader EpochReclaimer::t_reader;
+
+#endif
@@ -0,0 +1,101 @@
+/**
+ * @file EventDriver.h
+ * @author S. Schramm, A. Freeman
+ * @brief Evaluates a set of inputs over many events on a work-stealing thread pool.
+ * @copyright Copyright (C) 2002-2022 CERN for the benefit of the ATLAS collaboration
+ *
+ */
+
+#ifndef JET_EVENTDRIVER_H
+#define JET_EVENTDRIVER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "IInputBase.h"
+
+/**
+ * @brief The events are cut in chunks holding about the same number of jets, so that
+ * busy and empty events balance. Each thread starts on its own contiguous share of
+ * the chunks and steals from the others once it is done.
+ *
+ * The output doesn't depend on the number of threads nor on which thread evaluated
+ * what : every value has a fixed place in the output.
+ */
+class EventDriver {
+    public:
+        struct Event {
+            const xAOD::Jet* jets;
+            std::size_t nJets;
+            const JetContext* context;
+        };
+
+        /**
+         * @param nThreads threads evaluating, including the one calling evaluate().
+         * 0 uses all the hardware threads.
+         */
+        explicit EventDriver(std::size_t nThreads = 0);
+        ~EventDriver();
+        EventDriver(const EventDriver&) = delete;
+        EventDriver& operator=(const EventDriver&) = delete;
+
+        /**
+         * @brief Evaluate every input on every jet of every event.
+         * @param values resized to nJets*nInputs, the value of input i for the j-th jet
+         * over all the events (in order) is values[j*nInputs + i].
+         * @return false if an input failed to evaluate a jet, that value is then 0.
+         * @exception rethrows the first exception thrown by an input.
+         */
+        bool evaluate(const std::vector<Event>& events, const std::vector<const IInputBase*>& inputs, std::vector<double>& values);
+
+        std::size_t getNumThreads() const { return m_workers.size() + 1; }
+
+        // Chunks made per thread, more balances better but costs more synchronisation
+        static constexpr std::size_t CHUNKSPERTHREAD {16};
+
+    private:
+        struct Chunk {
+            std::size_t begin;  // events [begin, end)
+            std::size_t end;
+        };
+
+        struct alignas(64) Queue {
+            std::mutex mutex;
+            std::deque<Chunk> chunks;
+        };
+
+        struct Job {
+            const std::vector<Event>* events;
+            const std::vector<const IInputBase*>* inputs;
+            const std::size_t* jetOffsets;     // index of the first jet of each event
+            double* values;
+            std::atomic<bool> failed {false};
+            std::mutex exceptionMutex;
+            std::exception_ptr exception;
+        };
+
+        void work(std::size_t index);
+        void runChunks(std::size_t index, Job& job);
+        bool takeChunk(std::size_t index, Chunk& chunk);
+
+        std::vector<std::thread> m_workers;
+        std::unique_ptr<Queue[]> m_queues;      // one per thread, the caller's last
+
+        std::mutex m_runMutex;                  // one evaluate() at a time
+        std::mutex m_mutex;                     // protects the members below
+        std::condition_variable m_start;
+        std::condition_variable m_done;
+        Job* m_job {nullptr};
+        std::size_t m_generation {0};
+        std::size_t m_nBusy {0};
+        bool m_stop {false};
+};
+
+#endif
@@ -0,0 +1,93 @@
+/**
+ * @file GraphInput.h
+ * @author S. Schramm, A. Freeman
+ * @brief Evaluates a curve stored as a TGraph, TSpline or TProfile, the counterpart of
+ * HistoInput for calibrations which aren't histograms.
+ * @copyright Copyright (C) 2002-2022 CERN for the benefit of the ATLAS collaboration
+ *
+ */
+
+#ifndef JET_GRAPHINPUT_H
+#define JET_GRAPHINPUT_H
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+#include "JetToolHelpers/GraphTable.h"
+#include "JetToolHelpers/IInputBase.h"
+#include "JetToolHelpers/InputVariable.h"
+#include "JetToolHelpers/JetContext.h"
+
+/**
+ * @brief Evaluates a curve of a file, read with the graph loader of its extension (see
+ * HistoLoader::loadGraph()) and compiled at initialize() into a GraphTable. ROOT files
+ * provide TGraph (and TGraphErrors...), TSpline knots, and TSpline3 cubics evaluated
+ * with GraphInterpolation::Spline, TProfile means at the centers of the filled bins and
+ * 1D histogram contents at the bin centers.
+ *
+ * As HistoInput, values go through float and are clamped to the range of the curve.
+ */
+class GraphInput : public IInputBase {
+    public:
+        /**
+         * @brief Construct a new Graph Input object.
+         *
+         * @param name the name of the input.
+         * @param fileName the .root or .jth filename.
+         * @param graphName the curve name contained in the file.
+         * @param varName the input variable name, the x of the curve.
+         * @param varType
+         * @param isJetVar declare within variable is an attribute of JetContext or an
+         * attribute of xAOD::Jet.
+         * @param interpolation between the points of the curve.
+         */
+        GraphInput(
+            const std::string& name,
+            const std::string& fileName,
+            const std::string& graphName,
+            const std::string& varName, const std::string& varType,
+            bool isJetVar,
+            GraphInterpolation interpolation = GraphInterpolation::Linear
+        );
+        virtual ~GraphInput() {}
+
+        virtual bool initialize();
+        virtual bool finalize();
+
+        virtual bool getValue(const xAOD::Jet& jet, const JetContext& event, double& value) const;
+
+        /**
+         * @brief Evaluate the curve for a batch of nValues entries in one call, see
+         * HistoInput::getValues().
+         * @param x the values of the variable, the i-th entry is read at x[i*stride].
+         * @param values caller provided output buffer of at least nValues doubles.
+         * @return false if the curve isn't initialized.
+         */
+        bool getValues(const double* x, double* values, std::size_t nValues, std::size_t stride = 1) const;
+        bool getValues(const float*  x, double* values, std::size_t nValues, std::size_t stride = 1) const;
+
+        std::string getFileName() const { return m_fileName; }
+        std::string getGraphName() const { return m_graphName; }
+
+        /**
+         * @brief The compiled curve all evaluations read, nullptr before initialize().
+         */
+        std::shared_ptr<const GraphTable> getTable() const { return m_table; }
+
+    private:
+        template <typename T> bool evaluateBatch(const T* x, double* values, std::size_t nValues, std::size_t stride) const;
+
+        const std::string m_fileName;
+        const std::string m_graphName;
+        const GraphInterpolation m_interpolation;
+
+        const std::string m_varName;
+        const std::string m_varType;
+        const bool m_isJetVar;
+        std::unique_ptr<InputVariable> m_inVar;
+
+        std::shared_ptr<const GraphTable> m_table;
+};
+
+#endif
@@ -0,0 +1,126 @@
+/**
+ * @file GraphTable.h
+ * @author S. Schramm, A. Freeman
+ * @brief Flat, read-only representation of a curve (TGraph, TSpline, TProfile) used on
+ * the evaluation path of GraphInput.
+ * @copyright Copyright (C) 2002-2022 CERN for the benefit of the ATLAS collaboration
+ *
+ */
+
+#ifndef JET_GRAPHTABLE_H
+#define JET_GRAPHTABLE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "JetToolHelpers/HistoLoader.h"
+
+/**
+ * @brief How a GraphTable evaluates between two knots.
+ * - Linear : straight line, as TGraph::Eval and TH1::Interpolate.
+ * - MonotoneCubic : Fritsch-Carlson cubic Hermite spline, smooth and without overshoot :
+ * monotone between monotone knots.
+ * - Spline : the cubics the curve was stored with, as TSpline3::Eval. Only for curves
+ * carrying them, see LoadedGraph.
+ */
+enum class GraphInterpolation { Linear, MonotoneCubic, Spline };
+
+/**
+ * @brief The knots of a curve sorted by x, with the polynomial of each interval
+ * between two knots. Values outside of the knots are clamped to the first and last
+ * knots, as HistoInput clamps to the first and last bins.
+ *
+ * Knots evenly spaced in x, as the bin centers of a fixed binning, find their interval
+ * by a multiplication, the others by a binary search. Consecutive evaluations pass the
+ * interval from one to the next and skip the search when they stay in or next to it.
+ */
+class GraphTable {
+    public:
+        /**
+         * @brief Sort the points of graph and compute the polynomials, or take those of
+         * graph for GraphInterpolation::Spline. Of points with the same x, the first one
+         * is kept.
+         * @return nullptr if graph has no points, NaN coordinates, or no cubics for
+         * GraphInterpolation::Spline.
+         */
+        static std::shared_ptr<const GraphTable> create(const LoadedGraph& graph,
+            GraphInterpolation interpolation = GraphInterpolation::Linear);
+
+        std::size_t getNumKnots() const { return m_x.size(); }
+        double getXMin() const { return m_x.front(); }
+        double getXMax() const { return m_x.back(); }
+        GraphInterpolation getInterpolation() const { return m_interpolation; }
+        std::size_t getNumBytes() const;
+
+        // Interval i, from knot i to i+1, holding x, which must be within the knots
+        int findInterval(const double x) const {
+            if (m_uniform) {
+                int i {static_cast<int>((x - m_x.front()) * m_inverseStep)};
+                // Rounding can land next to the interval the search would return
+                i = std::min(std::max(i, 0), m_nIntervals - 1);
+                if (x < m_x[i])
+                    return std::max(i - 1, 0);
+                if (i < m_nIntervals - 1 && !(x < m_x[i+1]))
+                    return i + 1;
+                return i;
+            }
+            const int i {static_cast<int>(std::upper_bound(m_x.begin(), m_x.end(), x) - m_x.begin()) - 1};
+            return std::min(std::max(i, 0), m_nIntervals - 1);
+        }
+
+        // findInterval(), trying the interval hint and its neighbours first
+        int findInterval(const double x, const int hint) const {
+            if (hint >= 0 && hint < m_nIntervals && !m_uniform) {
+                if (!(x < m_x[hint])) {
+                    if (x < m_x[hint+1] || hint == m_nIntervals - 1)
+                        return hint;
+                    if (hint + 1 == m_nIntervals - 1 || x < m_x[hint+2])
+                        return hint + 1;
+                } else if (hint > 0 && !(x < m_x[hint-1])) {
+                    return hint - 1;
+                }
+            }
+            return findInterval(x);
+        }
+
+        /**
+         * @brief The value of the curve at x, clamped to the knots.
+         * @param interval the interval of the previous evaluation, -1 if none. Set to
+         * that of x.
+         */
+        double evaluate(double x, int& interval) const {
+            if (x < m_x.front())
+                x = m_x.front();
+            else if (!(x < m_x.back()))     // also catches NaN
+                x = m_x.back();
+            if (m_nIntervals == 0)
+                return m_coefficients[0];
+            interval = findInterval(x, interval);
+            const double* c {&m_coefficients[interval * m_stride]};
+            const double dx {x - m_x[interval]};
+            if (m_stride == 2)
+                return c[0] + dx*c[1];
+            return c[0] + dx*(c[1] + dx*(c[2] + dx*c[3]));
+        }
+
+        double evaluate(const double x) const {
+            int interval {-1};
+            return evaluate(x, interval);
+        }
+
+    private:
+        GraphTable() = default;
+
+        GraphInterpolation m_interpolation {GraphInterpolation::Linear};
+        std::vector<double> m_x;                // knots, increasing
+        // Per interval, the coefficients in powers of x-m_x[i] : 2 when linear, 4 when cubic
+        std::vector<double> m_coefficients;
+        int m_stride {2};
+        int m_nIntervals {0};
+        bool m_uniform {false};
+        double m_inverseStep {0};
+};
+
+#endif
@@ -0,0 +1,108 @@
+/**
+ * @file HistoBundle.h
+ * @author S. Schramm, A. Freeman
+ * @brief Packs the compiled tables of a group of HistoInputs into one contiguous block.
+ * @copyright Copyright (C) 2002-2022 CERN for the benefit of the ATLAS collaboration
+ *
+ */
+
+#ifndef JET_HISTOBUNDLE_H
+#define JET_HISTOBUNDLE_H
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "JetToolHelpers/HistoInput.h"
+
+/**
+ * @brief Pages backing the block of a bundle.
+ * - Normal : base pages.
+ * - Transparent : the block is aligned on huge pages and the kernel asked to back it with
+ * transparent huge pages (madvise), if enabled in /sys/kernel/mm/transparent_hugepage.
+ * - Explicit : huge pages reserved in /proc/sys/vm/nr_hugepages (MAP_HUGETLB), falls
+ * back to Transparent if none are free.
+ */
+enum class HistoPages { Normal, Transparent, Explicit };
+
+/**
+ * @brief How to allocate a bundle, see HistoBundle::create().
+ */
+struct HistoBundleOptions {
+    HistoPages pages {HistoPages::Normal};
+    // Copies of the block : 1, or 0 for one per NUMA node. More replicas than nodes are
+    // placed round robin on the nodes.
+    int nReplicas {1};
+};
+
+/**
+ * @brief Single page aligned block holding the tables of a group of inputs.
+ *
+ * Separately initialized inputs have their axes, edges and contents scattered over
+ * the heap. A bundle copies them into one block, laid out in the order the inputs are
+ * given : the table of the first input (axis metadata, edges, contents), then the one
+ * of the second input... each starting on a cache line. Evaluating the inputs in
+ * that order then walks the memory forward, which suits the hardware prefetcher and
+ * touches as few pages as possible.
+ *
+ * On NUMA machines the block can be replicated, each replica written from, and so
+ * allocated on, its node. Threads then evaluate the replica of the node they run on
+ * instead of reading the memory of the node which ran initialize().
+ *
+ * The inputs are switched to their copy in the block, each of them keeps the bundle
+ * alive for as long as it uses it.
+ */
+class HistoBundle {
+    public:
+        static constexpr std::size_t PAGESIZE {4096};
+        static constexpr std::size_t HUGEPAGESIZE {2 << 20};
+        static constexpr std::size_t CACHELINE {64};
+
+        /**
+         * @brief Pack the tables of the inputs, in evaluation order, and switch the
+         * inputs to the packed tables. Must be called before evaluation starts.
+         * @param inputs initialized inputs, in the order they are evaluated.
+         * @return nullptr if one of the inputs isn't initialized or its table cannot be
+         * replaced, no input is then switched. Only a reload changing the binning of an
+         * input during create() can fail it after the inputs before it were switched.
+         */
+        static std::shared_ptr<HistoBundle> create(const std::vector<HistoInput*>& inputs,
+            const HistoBundleOptions& options = HistoBundleOptions());
+
+        ~HistoBundle();
+        HistoBundle(const HistoBundle&) = delete;
+        HistoBundle& operator=(const HistoBundle&) = delete;
+
+        std::size_t getSize() const { return m_size; }     // bytes of each replica, whole pages
+        std::size_t getNumTables() const { return m_nTables; }
+        std::size_t getNumReplicas() const { return m_replicas.size(); }
+        const HistoTable* getTable(const std::size_t index, const std::size_t replica = 0) const {
+            return m_replicas[replica].tables[index];
+        }
+        int getNode(const std::size_t replica) const { return m_replicas[replica].node; }
+
+        /**
+         * @brief The pages obtained, the requested ones may not be available.
+         */
+        HistoPages getPages() const { return m_pages; }
+
+    private:
+        struct Replica {
+            void* block;
+            std::size_t mapped;                     // bytes mapped for block
+            int node;
+            std::vector<const HistoTable*> tables;  // in evaluation order, inside block
+        };
+
+        HistoBundle(std::size_t size, std::size_t nTables) : m_size{size}, m_nTables{nTables} {}
+
+        // Maps m_size bytes of the requested pages, lowers m_pages to those obtained
+        void* allocate(std::size_t& mapped);
+
+        std::size_t m_size;
+        std::size_t m_nTables;
+        HistoPages m_pages {HistoPages::Normal};
+        std::vector<Replica> m_replicas;
+};
+
+#endif
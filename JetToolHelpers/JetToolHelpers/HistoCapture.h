@@ -0,0 +1,135 @@
+/**
+ * @file HistoCapture.h
+ * @author S. Schramm, A. Freeman
+ * @brief Records the axis values HistoInputs are evaluated at during a job, to replay
+ * them in benchmarks.
+ * @copyright Copyright (C) 2002-2022 CERN for the benefit of the ATLAS collaboration
+ *
+ */
+
+#ifndef JET_HISTOCAPTURE_H
+#define JET_HISTOCAPTURE_H
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief The values recorded for one HistoInput, in the order each thread evaluated
+ * them. y is empty for 1D histograms.
+ */
+struct CapturedStream {
+    std::string name;
+    std::string fileName;
+    std::string histName;
+    int nDims {1};
+    std::vector<float> x;
+    std::vector<float> y;
+};
+
+/**
+ * @brief Binary log of the axis values of the inputs attached with HistoInput::setCapture().
+ *
+ * Each thread appends the values of each input to its own buffer, written to the file
+ * as a block once BLOCKSIZE values are buffered : recording takes no lock. Blocks of
+ * different threads are interleaved in the file, the values of a thread stay in order.
+ *
+ * Layout : "JTHCAPTR", version and byte order mark (uint32), then chunks starting with
+ * their kind (uint32) :
+ *  - STREAM : nDims (uint32), name, file name and histogram name (uint32 length and
+ *    characters), declares the next stream number, from 0.
+ *  - BLOCK : stream (uint32), count of floats (uint32) and the floats, x and y
+ *    interleaved for 2D histograms.
+ */
+class HistoCapture {
+    public:
+        static constexpr std::uint32_t STREAM {0};
+        static constexpr std::uint32_t BLOCK {1};
+        static constexpr std::size_t BLOCKSIZE {4096};
+
+        /**
+         * @brief Start a capture into fileName, replacing it.
+         * @return nullptr if the file cannot be written.
+         */
+        static std::shared_ptr<HistoCapture> create(const std::string& fileName);
+
+        /**
+         * @brief Read all the streams of a capture, in the order they were declared.
+         * @return false if the file cannot be read or is truncated, after printing why.
+         */
+        static bool read(const std::string& fileName, std::vector<CapturedStream>& streams);
+
+        ~HistoCapture() { close(); }
+        HistoCapture(const HistoCapture&) = delete;
+        HistoCapture& operator=(const HistoCapture&) = delete;
+
+        /**
+         * @brief Write the values buffered by all the threads and close the file. No
+         * thread may be recording anymore. Also done by the destructor.
+         * @return false if writing failed.
+         */
+        bool close();
+
+        /**
+         * @brief Declare a stream, before any thread records values. Done by
+         * HistoInput::setCapture().
+         */
+        std::uint32_t addStream(const std::string& name, const std::string& fileName,
+            const std::string& histName, int nDims);
+
+        // Append the values of one evaluation, one or two according to the stream
+        void record(const std::uint32_t stream, const float x) {
+            std::vector<float>& values {getBuffer(stream)};
+            values.push_back(x);
+            if (values.size() >= BLOCKSIZE)
+                flush(stream, values);
+        }
+
+        void record(const std::uint32_t stream, const float x, const float y) {
+            std::vector<float>& values {getBuffer(stream)};
+            values.push_back(x);
+            values.push_back(y);
+            if (values.size() >= 2*BLOCKSIZE)
+                flush(stream, values);
+        }
+
+    private:
+        // The buffers of one thread, one per stream
+        using ThreadBuffers = std::vector<std::vector<float>>;
+
+        HistoCapture(std::FILE* file);
+
+        std::vector<float>& getBuffer(const std::uint32_t stream) {
+            // The buffers of this thread for the captures it recorded to, found by the
+            // identifier of the capture, never reused
+            thread_local std::vector<std::pair<std::uint64_t, ThreadBuffers*>> local;
+            ThreadBuffers* buffers {nullptr};
+            for (const auto& entry : local)
+                if (entry.first == m_id)
+                    buffers = entry.second;
+            if (!buffers) {
+                buffers = addThread();
+                local.emplace_back(m_id, buffers);
+            }
+            if (stream >= buffers->size())
+                buffers->resize(stream + 1);
+            return (*buffers)[stream];
+        }
+
+        ThreadBuffers* addThread();
+        void flush(std::uint32_t stream, std::vector<float>& values);
+        void writeBlock(std::uint32_t stream, std::vector<float>& values);  // m_mutex held
+
+        const std::uint64_t m_id;
+        std::FILE* m_file;
+        bool m_failed {false};
+        std::uint32_t m_nStreams {0};
+        std::mutex m_mutex;
+        std::vector<std::unique_ptr<ThreadBuffers>> m_threads;
+};
+
+#endif
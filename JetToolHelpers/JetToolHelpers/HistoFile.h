@@ -0,0 +1,51 @@
+/**
+ * @file HistoFile.h
+ * @author S. Schramm, A. Freeman
+ * @brief Native file format of the histograms, readable without ROOT.
+ * @copyright Copyright (C) 2002-2022 CERN for the benefit of the ATLAS collaboration
+ *
+ */
+
+#ifndef JET_HISTOFILE_H
+#define JET_HISTOFILE_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "JetToolHelpers/HistoLoader.h"
+
+/**
+ * @brief Binary file of named histograms, stored as HistoInput compiles them : binning
+ * and in-range contents, no under- and overflows, errors or metadata. Numbers are
+ * written in the byte order of the machine, which is checked when reading.
+ *
+ * Layout : "JTHTABLE", version, byte order mark and number of histograms (uint32),
+ * then for each histogram its name (uint32 length and characters), nDims (int32), for
+ * each axis nBins (int32), xMin and xMax (double) and the edges (uint32 count, 0 for
+ * fixed bins, and doubles), and the contents (uint64 count and doubles).
+ *
+ * Files are written from ROOT files by convert_histos, or directly with write().
+ */
+class HistoFile {
+    public:
+        static constexpr const char* EXTENSION {".jth"};
+
+        /**
+         * @brief Write the histograms to fileName, replacing it.
+         * @return false if one of the histograms is inconsistent or writing failed.
+         */
+        static bool write(const std::string& fileName, const std::map<std::string, LoadedHisto>& histos);
+
+        /**
+         * @brief Read the histogram histName of fileName, the loader of EXTENSION.
+         */
+        static bool read(const std::string& fileName, const std::string& histName, LoadedHisto& histo);
+
+        /**
+         * @brief Names of the histograms of fileName, empty if it cannot be read.
+         */
+        static std::vector<std::string> getHistNames(const std::string& fileName);
+};
+
+#endif
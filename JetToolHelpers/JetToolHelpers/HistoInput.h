@@ -14,24 +14,44 @@
 
 #include <string>
 #include <memory>
-#include "TH1.h"
+#include <cstddef>
+#include <atomic>
+#include <future>
+#include <mutex>
+#include <vector>
 
 #include "JetContext.h"
 #include "InputVariable.h"
 #include "IInputBase.h"
+#include "HistoTable.h"
+#include "ChebyshevSurrogate.h"
+#include "HistoLoader.h"
+#include "HistoCapture.h"
+#include "GraphTable.h"
+#include "HistoTuning.h"
+#include "NumaTopology.h"
 
+/**
+ * @brief A variation of the axis variables of a HistoInput, e.g. a systematic shift of the
+ * jet pt : each axis value v becomes v*scales[axis] + offsets[axis].
+ */
+struct HistoShift {
+    double scales[2] {1, 1};
+    double offsets[2] {0, 0};
+};
+
+/**
+ * @brief Evaluates a histogram of a file, read with the HistoLoader of its extension :
+ * ".jth" files (HistoFile) without ROOT, ".root" files with the RootHistoLoader.
+ */
 class HistoInput : public IInputBase {
     public:         
-        static bool readHistoFromFile(std::unique_ptr<TH1>& m_hist, const std::string m_filename, const std::string m_histName);
-        static double enforceAxisRange(const TAxis& axis, const double inputValue);
-        static double readFromHisto(const TH1& m_hist, const double X, const double Y=0, const double Z=0);
-
         /**
          * @brief Construct a new 1D Histogram Input Object.
          * 
          * @param name the name of the histogram.
-         * @param filename the .root filename. 
-         * @param histName the histogram name contained in the .root file.
+         * @param filename the .root or .jth filename. 
+         * @param histName the histogram name contained in the file.
          * @param varName the input variable name. This is the interpretation
          * of the histogram. 
          * @param varType 
@@ -68,22 +88,297 @@ class HistoInput : public IInputBase {
             const std::string& varName2, const std::string& varType2, const bool isJetVar2,
             const std::string& varName3, const std::string& varType3, const bool isJetVar3
         );
-        virtual ~HistoInput() {}
+        virtual ~HistoInput();
         virtual bool getValue(const xAOD::Jet& jet, const JetContext& event, double& value) const;
 
+        /**
+         * @brief Evaluate a 1D histogram for a batch of nValues entries in one call.
+         * 
+         * The inputs are the values of the axis variable, i.e. what the InputVariable
+         * of the axis would return for each jet (|eta| for an "abseta" axis...). No 
+         * copies are made, which makes this the entry point for NumPy arrays in PyROOT.
+         * @param x the axis values, the i-th entry is read at x[i*stride].
+         * @param values caller provided output buffer of at least nValues doubles.
+         * @param nValues number of entries to evaluate.
+         * @param stride distance in elements between two consecutive entries of x, 
+         * allows reading one field of an array of records (e.g. a structured array).
+         * @return false if the histogram isn't initialized or isn't 1D. 
+         */
+        bool getValues(const double* x, double* values, std::size_t nValues, std::size_t stride = 1) const;
+        bool getValues(const float*  x, double* values, std::size_t nValues, std::size_t stride = 1) const;
+
+        /**
+         * @brief Evaluate a 2D histogram for a batch of nValues entries in one call.
+         * @param x the values of the first axis variable.
+         * @param y the values of the second axis variable.
+         * @return false if the histogram isn't initialized or isn't 2D. 
+         */
+        bool getValues(const double* x, const double* y, double* values, std::size_t nValues, std::size_t stride = 1) const;
+        bool getValues(const float*  x, const float*  y, double* values, std::size_t nValues, std::size_t stride = 1) const;
+
+        /**
+         * @brief getValue() together with the analytic gradient of the interpolation with
+         * respect to the axis variables, computed from the same bins and weights. The
+         * gradient is that of the surrogate if one is evaluated. Along the axes where the
+         * inputs are clamped, outside of their range, it is 0 for both.
+         * @param gradient caller provided buffer of getNDims() doubles, d/dvar1 first.
+         */
+        bool getValueAndGradient(const xAOD::Jet& jet, const JetContext& event, double& value, double* gradient) const;
+
+        /**
+         * @brief getValues() together with the gradients, see getValueAndGradient().
+         * @param gradients caller provided buffer of nValues*getNDims() doubles, the
+         * gradient of the i-th entry starts at gradients[i*getNDims()].
+         */
+        bool getValuesAndGradients(const double* x, double* values, double* gradients, std::size_t nValues, std::size_t stride = 1) const;
+        bool getValuesAndGradients(const float*  x, double* values, double* gradients, std::size_t nValues, std::size_t stride = 1) const;
+        bool getValuesAndGradients(const double* x, const double* y, double* values, double* gradients, std::size_t nValues, std::size_t stride = 1) const;
+        bool getValuesAndGradients(const float*  x, const float*  y, double* values, double* gradients, std::size_t nValues, std::size_t stride = 1) const;
+
+        /**
+         * @brief Evaluate a jet at its nominal axis values and at nShifts variations of
+         * them in one call. The input variables are read once and the variations falling
+         * in the same or a neighbouring bin reuse the bin search and the fetched contents.
+         * Each value is the one getValues() returns for the shifted axis values.
+         * @param values caller provided buffer of 1+nShifts doubles : the nominal value,
+         * then one per shift.
+         */
+        bool getVariations(const xAOD::Jet& jet, const JetContext& event, const HistoShift* shifts,
+            std::size_t nShifts, double* values) const;
+
         virtual bool initialize();
         virtual bool finalize();
 
+        /**
+         * @brief Read the histogram from the file again, e.g. after the calibration was
+         * updated, and switch to it without stopping the threads evaluating : getValue()
+         * never waits and uses either the previous or the new histogram. The binning may
+         * change. Reading ROOT files from several threads requires ROOT::EnableThreadSafety().
+         * @return false if not initialized or if reading or compiling failed, the previous
+         * histogram is then still evaluated.
+         */
+        bool reload();
+
+        /**
+         * @brief Same as reload(), from a separate thread.
+         */
+        std::future<bool> reloadAsync();
+
         std::string getFileName() const { return m_fileName; }
         std::string getHistName() const { return m_histName; }
+        int getNDims() const { return nDims; }
+
+        // The input variable of axis 0 or 1, as given to the constructor
+        std::string getVarName(const int axis) const { return axis == 0 ? m_varName1 : m_varName2; }
+        std::string getVarType(const int axis) const { return axis == 0 ? m_varType1 : m_varType2; }
+        bool isJetVar(const int axis) const { return axis == 0 ? m_isJetVar1 : m_isJetVar2; }
+
+        /**
+         * @brief The compiled table all evaluations read, nullptr before initialize(). 
+         */
+        std::shared_ptr<const HistoTable> getTable() const;
+
+        /**
+         * @brief Evaluate from another copy of the compiled table, e.g. one packed into
+         * a HistoBundle. Switches like reload() does. Reloading leaves the bundle.
+         * @return false if the table doesn't have the binning of the current one.
+         */
+        bool setTable(std::shared_ptr<const HistoTable> table);
+
+        /**
+         * @brief Same as setTable() with one copy of the table per NUMA node, see
+         * HistoBundleOptions. Each thread evaluates the copy replicas[node % size] of
+         * the node it runs on. The first one is returned by getTable().
+         */
+        bool setTables(std::vector<std::shared_ptr<const HistoTable>> replicas);
+
+        /**
+         * @brief Whether setTables() would take the replicas now, without switching to them.
+         */
+        bool acceptsTables(const std::vector<std::shared_ptr<const HistoTable>>& replicas) const;
+
+        /**
+         * @brief Store the compiled table compactly, applies from the next initialize().
+         * Exact unless a quantization tolerance is given.
+         */
+        void setCompression(const HistoCompression& compression) { m_compression = compression; }
+
+        /**
+         * @brief Opt in to evaluating large batches over large tables cell by cell : the
+         * entries are sorted by bin, evaluated in that order and their values written back
+         * in the original order. Smaller batches and tables are evaluated in order, the
+         * sorting wouldn't pay off. The values are the same either way.
+         * @param minBatchSize fewest entries of a batch to sort, 0 never sorts.
+         * @param minTableBytes smallest table to sort for, see HistoTable::getNumBytes().
+         */
+        void setCoherentBatches(const std::size_t minBatchSize = 32768, const std::size_t minTableBytes = 1 << 20) {
+            m_coherentMinBatch = minBatchSize;
+            m_coherentMinBytes = minTableBytes;
+        }
+
+        /**
+         * @brief Opt in to evaluating a Chebyshev expansion of the histogram instead of the
+         * table, if initialize() finds one within maxError of the interpolation. Otherwise
+         * the table is used. Applies from the next initialize().
+         * @param maxError largest absolute difference allowed with TH1::Interpolate, bounded
+         * everywhere from points denser than the bins and the expansion, see
+         * ChebyshevSurrogate::fit().
+         * @param maxDegree highest degree tried along each axis.
+         */
+        void setSurrogate(const double maxError, const int maxDegree = 16) {
+            m_surrogateMaxError = maxError;
+            m_surrogateMaxDegree = maxDegree;
+        }
+
+        /**
+         * @brief Opt in to choosing the representation at initialize() : every kernel
+         * meeting tuning.maxError (see HistoKernel) is timed on points drawn over the axes
+         * and the fastest one is evaluated. The error is sampled, on those points and at
+         * the bin centers and edges where the interpolation changes segment. Replaces setCompression() and setSurrogate().
+         * The choice is read from tuning.cacheFile if this histogram was tuned before,
+         * written to it otherwise. Applies from the next initialize().
+         */
+        void setTuning(const HistoTuning& tuning) {
+            m_tuning = tuning;
+            m_tune = true;
+        }
+
+        /**
+         * @brief Record the axis values of every following evaluation, scalar, batched
+         * or nominal of getVariations(), into capture. Must be called before evaluation
+         * starts, nullptr stops recording. See HistoCapture.
+         */
+        void setCapture(std::shared_ptr<HistoCapture> capture);
+
+        /**
+         * @brief Opt in to inverting a 1D histogram : initialize() and reload() also build
+         * the inverse of the interpolation, which getInverse() evaluates with a single
+         * lookup. They fail if the contents aren't strictly monotone, after printing the
+         * first bins breaking it, or if a surrogate or quantized contents are evaluated :
+         * the inverse would be that of the exact interpolation, not of getValue(). The
+         * tuning then only considers the exact kernels. Applies from the next initialize().
+         */
+        void setInverse(const bool enabled = true) { m_invert = enabled; }
+
+        /**
+         * @brief The axis value x at which getValue() returns value, see setInverse().
+         * Values beyond the contents of the first or last bin give the center of that bin,
+         * where the interpolation becomes constant.
+         * @return false if no inverse was built.
+         */
+        bool getInverse(double value, double& x) const;
+
+        /**
+         * @brief getInverse() for a batch of nValues values, the i-th read at values[i*stride].
+         */
+        bool getInverses(const double* values, double* x, std::size_t nValues, std::size_t stride = 1) const;
+
+        /**
+         * @brief The representation evaluated, chosen by the tuning or set by
+         * setCompression() and setSurrogate().
+         */
+        HistoKernel getKernel() const;
+
+        /**
+         * @brief The surrogate used by getValue(), nullptr if the table is used. 
+         */
+        std::shared_ptr<const ChebyshevSurrogate> getSurrogate() const;
+
+        /**
+         * @brief Bound on the difference with the interpolation found by the last fit, that
+         * of the surrogate if one is used. Negative if no surrogate was requested.
+         */
+        double getSurrogateError() const;
+
+        /**
+         * @brief Bytes held for this input : the compiled table and the surrogate, the
+         * histogram read from the file isn't kept. Contents shared with other compressed tables
+         * are counted for each of them. 0 while evicted, see HistoMemoryManager.
+         */
+        std::size_t getMemoryUsage() const { return m_bytes.load(std::memory_order_relaxed); }
     private:
+        friend class HistoMemoryManager;
+        // Everything getValue() reads, replaced as a whole by reload() and setTable()
+        struct Compiled {
+            std::shared_ptr<const HistoTable> table;
+            std::shared_ptr<const ChebyshevSurrogate> surrogate;    // evaluated instead of table if set.
+            double surrogateError;
+            // Copies of table, one per NUMA node, evaluated instead of it if set.
+            std::vector<std::shared_ptr<const HistoTable>> replicas;
+            HistoKernel kernel {HistoKernel::Table};
+            std::shared_ptr<const GraphTable> inverse;  // contents to axis values, see setInverse()
+
+            const HistoTable& getLocalTable() const {
+                return replicas.empty() ? *table : *replicas[NumaTopology::getCurrentNode() % replicas.size()];
+            }
+        };
+
+        std::unique_ptr<Compiled> compile(const LoadedHisto& histo) const;
+        // The representation of histo evaluated by kernel, nullptr if it cannot be built
+        std::unique_ptr<Compiled> build(const LoadedHisto& histo, HistoKernel kernel, double maxError, int maxDegree) const;
+        std::unique_ptr<Compiled> tune(const LoadedHisto& histo) const;
+        // Adds the inverse of histo to compiled, false if it isn't invertible
+        bool invert(const LoadedHisto& histo, Compiled& compiled) const;
+        // Swap compiled in, the previous one is deleted once no thread reads it anymore
+        void publish(std::unique_ptr<Compiled> compiled) const;
+        void updateMemoryUsage() const;
+        std::unique_ptr<Compiled> readAndCompile() const;
+        // Whether replicas have the binning of the table in current, prints why not
+        bool matches(const Compiled* current, const std::vector<std::shared_ptr<const HistoTable>>& replicas) const;
+
+        // Used by the memory manager : release the table if nobody is
+        // reloading them, and load them again on the next evaluation.
+        bool evict() const;
+        const Compiled* restore() const;
+        void markUsed() const {
+            if (!m_used.load(std::memory_order_relaxed))
+                m_used.store(true, std::memory_order_relaxed);
+        }
+        void record(const float varValue1, const float varValue2) const {
+            if (nDims > 1)
+                m_capture->record(m_captureStream, varValue1, varValue2);
+            else
+                m_capture->record(m_captureStream, varValue1);
+        }
+
+        // gradient is filled if not nullptr
+        // cell carries the bin search and contents from one evaluation to the next
+        // table is that of compiled read by the thread, see Compiled::getLocalTable()
+        double evaluate(const Compiled& compiled, const HistoTable& table, float varValue1, float varValue2, HistoCell& cell, double* gradient = nullptr) const;
+        bool evaluateJet(const xAOD::Jet& jet, const JetContext& event, double& value, double* gradient) const;
+        template <typename T> bool evaluateBatch(const T* x, const T* y, double* values, double* gradients,
+            std::size_t nValues, std::size_t stride) const;
+        template <typename T> void evaluateCoherent(const Compiled& compiled, const T* x, const T* y, double* values,
+            double* gradients, std::size_t nValues, std::size_t stride) const;
+
         const std::string name; 
         const int nDims;
         
         const std::string m_fileName;
         const std::string m_histName;
 
-        std::unique_ptr<TH1> m_hist;    // actual histogram from the which getValue() is done.
+        // Mutable : evicted inputs are restored when evaluated
+        mutable std::atomic<const Compiled*> m_compiled {nullptr};  // compiled histogram from which getValue() is done.
+        mutable std::mutex m_reloadMutex;       // taken by the writers of m_compiled only.
+        mutable std::atomic<std::size_t> m_bytes {0};
+        mutable std::atomic<bool> m_evicted {false};
+        mutable std::atomic<bool> m_used {false};   // evaluated since the memory manager last looked
+        bool m_managed {false};                 // registered to the memory manager
+        HistoCompression m_compression;
+
+        std::size_t m_coherentMinBatch {0};     // batches evaluated in order by default
+        std::size_t m_coherentMinBytes {0};
+
+        double m_surrogateMaxError {0};     // no surrogate by default
+        int m_surrogateMaxDegree {16};
+
+        bool m_tune {false};                // not tuned by default
+        HistoTuning m_tuning;
+
+        bool m_invert {false};              // no inverse by default
+
+        std::shared_ptr<HistoCapture> m_capture;    // no recording by default
+        std::uint32_t m_captureStream {0};
 
         // TODO : Investigate possibility of refactoring this
         // to a vector of input variables.
@@ -0,0 +1,96 @@
+/**
+ * @file HistoLoader.h
+ * @author S. Schramm, A. Freeman
+ * @brief Reads the histograms evaluated by HistoInput from files, with the loader
+ * registered for the extension of the file.
+ * @copyright Copyright (C) 2002-2022 CERN for the benefit of the ATLAS collaboration
+ *
+ */
+
+#ifndef JET_HISTOLOADER_H
+#define JET_HISTOLOADER_H
+
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "JetToolHelpers/HistoTable.h"
+
+/**
+ * @brief A histogram as read from a file : the binning of each axis and the in-range
+ * bin contents, x varying fastest. What HistoTable::create() compiles.
+ */
+struct LoadedHisto {
+    int nDims {0};
+    std::vector<HistoAxisBinning> binnings;
+    std::vector<double> contents;
+};
+
+/**
+ * @brief A curve as read from a file : its points, in any order. What GraphTable::create()
+ * compiles.
+ */
+struct LoadedGraph {
+    std::vector<double> x;
+    std::vector<double> y;
+    // Per point, the cubic from it to the next one, y + b*dx + c*dx^2 + d*dx^3 in powers of
+    // dx = x - x[i], as TSpline3 stores it. Empty for curves given by their points only.
+    std::vector<double> b;
+    std::vector<double> c;
+    std::vector<double> d;
+};
+
+/**
+ * @brief Registry of the file formats HistoInput can read, by extension. The native
+ * format (".jth", see HistoFile) is always available. ROOT files are read by the
+ * RootHistoLoader, registered when the library is built with ROOT.
+ */
+class HistoLoader {
+    public:
+        /**
+         * @brief Reads the histogram histName of fileName into histo.
+         * @return false if the file or histogram cannot be read, after printing why.
+         */
+        using Loader = std::function<bool(const std::string& fileName, const std::string& histName, LoadedHisto& histo)>;
+
+        /**
+         * @brief Register the loader of the files ending with extension (".root"...),
+         * replacing any previous one.
+         */
+        static void registerLoader(const std::string& extension, Loader loader);
+        static bool hasLoader(const std::string& extension);
+
+        /**
+         * @brief Read a histogram with the loader of the extension of fileName.
+         * @return false if no loader is registered for it or if loading failed.
+         */
+        static bool load(const std::string& fileName, const std::string& histName, LoadedHisto& histo);
+
+        /**
+         * @brief Reads the curve graphName of fileName into graph, for GraphInput.
+         */
+        using GraphLoader = std::function<bool(const std::string& fileName, const std::string& graphName, LoadedGraph& graph)>;
+
+        static void registerGraphLoader(const std::string& extension, GraphLoader loader);
+
+        /**
+         * @brief Read a curve with the graph loader of the extension of fileName. Formats
+         * without one, as the native format, have their 1D histograms read as curves :
+         * one point per bin, at its center.
+         */
+        static bool loadGraph(const std::string& fileName, const std::string& graphName, LoadedGraph& graph);
+
+        /**
+         * @brief The extension of fileName, lower case and with the dot.
+         */
+        static std::string getExtension(const std::string& fileName);
+
+    private:
+        static std::mutex& mutex();
+        static std::map<std::string, Loader>& loaders();
+        static std::map<std::string, GraphLoader>& graphLoaders();
+};
+
+#endif
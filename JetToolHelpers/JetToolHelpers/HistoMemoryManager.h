@@ -0,0 +1,70 @@
+/**
+ * @file HistoMemoryManager.h
+ * @author S. Schramm, A. Freeman
+ * @brief Accounts the memory held by the initialized HistoInput and keeps it under an
+ * optional budget by evicting the least recently used ones.
+ * @copyright Copyright (C) 2002-2022 CERN for the benefit of the ATLAS collaboration
+ *
+ */
+
+#ifndef JET_HISTOMEMORYMANAGER_H
+#define JET_HISTOMEMORYMANAGER_H
+
+#include <atomic>
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+class HistoInput;
+
+/**
+ * @brief Every HistoInput registers itself when initialized. Under a budget, loading
+ * a histogram evicts the histograms not evaluated for the longest time (CLOCK
+ * approximation of LRU) until the total fits. An evicted input reads its histogram
+ * again from the file on its next evaluation.
+ *
+ * Evaluating a resident input only sets a flag, never locks. Evicted tables are
+ * deleted once no thread is reading them anymore, see EpochReclaimer.
+ */
+class HistoMemoryManager {
+    public:
+        static HistoMemoryManager& instance();
+
+        /**
+         * @brief Bytes the inputs may hold in total, 0 for no limit. Evicts immediately
+         * if the inputs already hold more. A single input larger than the budget stays.
+         */
+        void setBudget(std::size_t bytes);
+        std::size_t getBudget() const { return m_budget.load(); }
+
+        std::size_t getTotalBytes() const { return m_totalBytes.load(); }
+        std::map<std::string, std::size_t> getBytesPerFile() const;
+        std::vector<std::pair<const HistoInput*, std::size_t>> getBytesPerInput() const;
+
+        std::size_t getNumEvictions() const { return m_nEvictions.load(); }
+
+    private:
+        friend class HistoInput;
+        HistoMemoryManager() = default;
+
+        void add(const HistoInput* input);
+        void remove(const HistoInput* input);
+        void account(const std::size_t previousBytes, const std::size_t bytes) {
+            m_totalBytes.fetch_add(bytes - previousBytes);  // wraps around correctly when shrinking
+        }
+        // Evict until the total fits in the budget, keep is never evicted
+        void enforceBudget(const HistoInput* keep);
+
+        mutable std::mutex m_mutex;             // protects m_inputs and m_hand
+        std::vector<const HistoInput*> m_inputs;
+        std::size_t m_hand {0};                 // next input the CLOCK looks at
+
+        std::atomic<std::size_t> m_totalBytes {0};
+        std::atomic<std::size_t> m_budget {0};
+        std::atomic<std::size_t> m_nEvictions {0};
+};
+
+#endif
@@ -0,0 +1,346 @@
+/**
+ * @file HistoTable.h
+ * @author S. Schramm, A. Freeman
+ * @brief Flat, read-only representation of a histogram used on the evaluation path.
+ * The lookups reproduce TAxis and TH1/TH2::Interpolate bit for bit, without going
+ * through the ROOT objects.
+ * @copyright Copyright (C) 2002-2022 CERN for the benefit of the ATLAS collaboration
+ *
+ */
+
+#ifndef JET_HISTOTABLE_H
+#define JET_HISTOTABLE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/**
+ * @brief Description of the binning of one axis, used to build a HistoTable.
+ */
+struct HistoAxisBinning {
+    int nBins;
+    double xMin;
+    double xMax;
+    std::vector<double> edges;  // nBins+1 edges for variable bins, empty for fixed bins
+};
+
+/**
+ * @brief One axis of a HistoTable. Bin numbering follows TAxis : bin 0 is the
+ * underflow, 1 to nBins the actual bins and nBins+1 the overflow.
+ */
+struct HistoAxis {
+    int nBins;
+    double xMin;
+    double xMax;
+    double binWidth;        // (xMax-xMin)/nBins, as TAxis computes it for fixed bins
+    double lowClamp;        // value enforceRange() returns for underflows
+    double highClamp;       // value enforceRange() returns for overflows
+    const double* edges;    // nBins+1 edges for variable bins, nullptr for fixed bins
+
+    // An axis from its members by name, for the headers of util/generate_tables.cpp
+    static constexpr HistoAxis make(const int nBins, const double xMin, const double xMax, const double binWidth,
+        const double lowClamp, const double highClamp, const double* edges) {
+        HistoAxis axis {};
+        axis.nBins = nBins;
+        axis.xMin = xMin;
+        axis.xMax = xMax;
+        axis.binWidth = binWidth;
+        axis.lowClamp = lowClamp;
+        axis.highClamp = highClamp;
+        axis.edges = edges;
+        return axis;
+    }
+
+    // TAxis::FindFixBin
+    int findBin(const double x) const {
+        if (x < xMin)
+            return 0;
+        if (!(x < xMax))    // also catches NaN
+            return nBins + 1;
+        if (!edges)
+            return 1 + int(nBins*(x-xMin)/(xMax-xMin));
+        return int(std::upper_bound(edges, edges + nBins + 1, x) - edges);
+    }
+
+    // findBin(), trying the bin hint and its neighbours before searching the edges
+    int findBin(const double x, const int hint) const {
+        if (edges && hint > 0 && hint <= nBins) {
+            if (x >= edges[hint-1]) {
+                if (x < edges[hint])
+                    return hint;
+                if (hint < nBins && x < edges[hint+1])
+                    return hint+1;
+            } else if (hint > 1 && x >= edges[hint-2]) {
+                return hint-1;
+            }
+        }
+        return findBin(x);
+    }
+
+    // TAxis::GetBinCenter
+    double getBinCenter(const int bin) const {
+        if (!edges || bin < 1 || bin > nBins)
+            return xMin + (bin-1)*binWidth + 0.5*binWidth;
+        return edges[bin-1] + 0.5*(edges[bin] - edges[bin-1]);
+    }
+
+    // TAxis::GetBinLowEdge
+    double getBinLowEdge(const int bin) const {
+        if (edges && bin > 0 && bin <= nBins)
+            return edges[bin-1];
+        return xMin + (bin-1)*binWidth;
+    }
+
+    // TAxis::GetBinUpEdge
+    double getBinUpEdge(const int bin) const {
+        if (!edges || bin < 1 || bin > nBins)
+            return xMin + bin*binWidth;
+        return edges[bin];
+    }
+
+    // TAxis::GetBinWidth
+    double getBinWidth(int bin) const {
+        if (!edges)
+            return binWidth;
+        bin = std::min(std::max(bin, 1), nBins);
+        return edges[bin] - edges[bin-1];
+    }
+
+    /**
+     * @brief Same as RootHistoLoader::enforceAxisRange() : values outside of the axis
+     * are moved just inside its first or last bin.
+     */
+    double enforceRange(const double x) const {
+        if (x < xMin)
+            return lowClamp;
+        // Variable bins can't round into the overflow, fixed bins can just below xMax
+        if (!(x < xMax) || (!edges && findBin(x) > nBins))
+            return highClamp;
+        return x;
+    }
+};
+
+/**
+ * @brief Options to store the contents of a HistoTable compactly, see HistoTable::create().
+ */
+struct HistoCompression {
+    bool enabled {false};
+    // Largest absolute error allowed on a content to store its tile as 16-bit integers,
+    // 0 keeps all the contents exact.
+    double quantizationTolerance {0.};
+};
+
+/**
+ * @brief A block of contents of a compressed HistoTable : 64 bins along x for 1D
+ * tables, 8x8 bins for 2D tables.
+ */
+struct HistoTile {
+    enum Kind : std::uint32_t { Constant, Dense, Quantized };
+    Kind kind;
+    std::uint32_t offset;   // first value of the tile in contents (Dense) or quantized (Quantized)
+    double value;           // the content of a Constant tile, the offset of a Quantized one
+    double scale;           // the step of a Quantized tile
+};
+
+/**
+ * @brief What an interpolation of a HistoTable found around its point : the bins and the
+ * centers and contents it interpolated between. Passed from one interpolate() to the next
+ * on the same table, points in the same or a neighbouring bin skip the bin search and
+ * points between the same bin centers also skip fetching the contents.
+ */
+struct HistoCell {
+    int bins[2] {0, 0};                         // bins of the last point, 0 if none
+    int segments[2] {-1, -1};                   // bin of the lower centers interpolated between, -1 if none
+    double x1 {0}, x2 {0}, y1 {0}, y2 {0};      // the centers
+    double q11 {0}, q12 {0}, q21 {0}, q22 {0};  // the contents at (x1, y1), (x1, y2), (x2, y1) and (x2, y2)
+};
+
+/**
+ * @brief Flat view of a compiled histogram : axes and in-range bin contents, x varying
+ * fastest. The table doesn't own the memory it points to, it is kept alive by whoever
+ * handed out the table (see create() and HistoBundle).
+ *
+ * Compressed tables store their contents by tiles instead : constant tiles hold a single
+ * value, identical tiles share their values and smooth tiles may be quantized. Decoding
+ * happens in getBinContent(), the lookups are unchanged.
+ */
+struct HistoTable {
+    int nDims;
+    HistoAxis axes[2];
+    const double* contents;             // all the contents, or the Dense tile values if tiled
+    const HistoTile* tiles;             // nullptr for uncompressed tables
+    const std::uint16_t* quantized;     // the Quantized tile values
+    int tileShiftX;                     // log2 of the tile size along x
+    int tileShiftY;                     // log2 of the tile size along y
+    int nTilesX;
+    int nTiles;
+    int nContents;                      // size of contents
+    int nQuantized;                     // size of quantized
+
+    /**
+     * @brief Build a table owning its storage.
+     * @param binnings one binning per dimension, 1D and 2D are supported.
+     * @param contents the in-range bin contents, x varying fastest.
+     * @param compression how to store the contents. Compressed contents that are 
+     * bitwise identical to those of another live table are shared with it.
+     * @return nullptr if the binnings and contents are inconsistent.
+     */
+    static std::shared_ptr<const HistoTable> create(
+        const std::vector<HistoAxisBinning>& binnings,
+        const std::vector<double>& contents,
+        const HistoCompression& compression = HistoCompression()
+    );
+
+    /**
+     * @brief An uncompressed table over constexpr arrays, for the headers of
+     * util/generate_tables.cpp. The members not given are zero.
+     * @param yAxis ignored by 1D tables.
+     */
+    static constexpr HistoTable makeUncompressed(const int nDims, const HistoAxis& xAxis, const HistoAxis& yAxis,
+        const double* contents, const int nContents) {
+        HistoTable table {};
+        table.nDims = nDims;
+        table.axes[0] = xAxis;
+        table.axes[1] = yAxis;
+        table.contents = contents;
+        table.nContents = nContents;
+        return table;
+    }
+
+    std::size_t getNumBins() const;
+
+    // Bytes of the arrays the table points to, including shared ones
+    std::size_t getNumBytes() const;
+
+    /**
+     * @brief Copy the arrays the table points to at cursor, each one starting at a 
+     * multiple of alignment, and move the cursor past them.
+     * @return the table pointing to the copies.
+     */
+    HistoTable relocate(char*& cursor, const std::size_t alignment) const;
+    std::size_t getRelocatedSize(const std::size_t alignment) const;
+
+    // Content of the (in-range) bin binX, binY
+    double getBinContent(const int binX, const int binY = 1) const {
+        const int indexX {binX-1};
+        const int indexY {binY-1};
+        if (!tiles)
+            return contents[indexX + axes[0].nBins*indexY];
+
+        const HistoTile& tile {tiles[(indexX >> tileShiftX) + nTilesX*(indexY >> tileShiftY)]};
+        const int local {(indexX & ((1 << tileShiftX) - 1)) + ((indexY & ((1 << tileShiftY) - 1)) << tileShiftX)};
+        if (tile.kind == HistoTile::Constant)
+            return tile.value;
+        if (tile.kind == HistoTile::Dense)
+            return contents[tile.offset + local];
+        return tile.value + tile.scale*quantized[tile.offset + local];
+    }
+
+    // TH1::Interpolate(x)
+    double interpolate(const double x) const {
+        return interpolate(x, nullptr);
+    }
+
+    /**
+     * @brief TH1::Interpolate(x) and, if gradient isn't nullptr, its derivative along x
+     * from the same bins and weights. The derivative is that of the linear segment x is
+     * on : 0 where the interpolation is flat, the right segment exactly on a bin center.
+     */
+    double interpolate(const double x, double* gradient) const {
+        HistoCell cell;
+        return interpolate(x, cell, gradient);
+    }
+
+    // Same, starting from and updating the cell of a previous interpolation
+    double interpolate(const double x, HistoCell& cell, double* gradient = nullptr) const {
+        const HistoAxis& axis {axes[0]};
+        const int xbin {axis.findBin(x, cell.bins[0])};
+        cell.bins[0] = xbin;
+        if (gradient)
+            *gradient = 0;
+        if (x <= axis.getBinCenter(1))
+            return getBinContent(1);
+        if (x >= axis.getBinCenter(axis.nBins))
+            return getBinContent(axis.nBins);
+
+        const int segment {x <= axis.getBinCenter(xbin) ? xbin-1 : xbin};
+        if (segment != cell.segments[0]) {
+            cell.segments[0] = segment;
+            cell.q11 = getBinContent(segment);
+            cell.x1 = axis.getBinCenter(segment);
+            cell.q21 = getBinContent(segment+1);
+            cell.x2 = axis.getBinCenter(segment+1);
+        }
+        const double x0 {cell.x1}, x1 {cell.x2}, y0 {cell.q11}, y1 {cell.q21};
+        const double slope {(y1-y0)/(x1-x0)};
+        if (gradient)
+            *gradient = slope;
+        return y0 + (x-x0)*slope;
+    }
+
+    // TH2::Interpolate(x, y)
+    double interpolate(const double x, const double y) const {
+        return interpolate(x, y, nullptr);
+    }
+
+    /**
+     * @brief TH2::Interpolate(x, y) and, if gradient isn't nullptr, its partial derivatives
+     * along x and y in gradient[0] and gradient[1], from the same four bins and weights.
+     */
+    double interpolate(const double x, const double y, double* gradient) const {
+        HistoCell cell;
+        return interpolate(x, y, cell, gradient);
+    }
+
+    // Same, starting from and updating the cell of a previous interpolation
+    double interpolate(const double x, const double y, HistoCell& cell, double* gradient = nullptr) const {
+        const HistoAxis& xAxis {axes[0]};
+        const HistoAxis& yAxis {axes[1]};
+        const int binX {xAxis.findBin(x, cell.bins[0])};
+        const int binY {yAxis.findBin(y, cell.bins[1])};
+        cell.bins[0] = binX;
+        cell.bins[1] = binY;
+        if (gradient)
+            gradient[0] = gradient[1] = 0;
+        if (binX < 1 || binX > xAxis.nBins || binY < 1 || binY > yAxis.nBins)
+            return 0;   // TH2::Interpolate refuses to extrapolate
+
+        // Which quadrant of the bin are we in?
+        const bool upperX {xAxis.getBinUpEdge(binX) - x <= xAxis.getBinWidth(binX)/2};
+        const bool upperY {yAxis.getBinUpEdge(binY) - y <= yAxis.getBinWidth(binY)/2};
+        const int segmentX {upperX ? binX : binX-1};
+        const int segmentY {upperY ? binY : binY-1};
+        if (segmentX != cell.segments[0] || segmentY != cell.segments[1]) {
+            cell.segments[0] = segmentX;
+            cell.segments[1] = segmentY;
+            cell.x1 = xAxis.getBinCenter(segmentX);
+            cell.x2 = xAxis.getBinCenter(segmentX+1);
+            cell.y1 = yAxis.getBinCenter(segmentY);
+            cell.y2 = yAxis.getBinCenter(segmentY+1);
+
+            const int binX1 {std::max(xAxis.findBin(cell.x1), 1)};
+            const int binX2 {std::min(xAxis.findBin(cell.x2), xAxis.nBins)};
+            const int binY1 {std::max(yAxis.findBin(cell.y1), 1)};
+            const int binY2 {std::min(yAxis.findBin(cell.y2), yAxis.nBins)};
+            cell.q11 = getBinContent(binX1, binY1);
+            cell.q12 = getBinContent(binX1, binY2);
+            cell.q21 = getBinContent(binX2, binY1);
+            cell.q22 = getBinContent(binX2, binY2);
+        }
+        const double x1 {cell.x1}, x2 {cell.x2}, y1 {cell.y1}, y2 {cell.y2};
+        const double q11 {cell.q11}, q12 {cell.q12}, q21 {cell.q21}, q22 {cell.q22};
+
+        // Same expression as ROOT so that the results are identical
+        const double d {1.0*(x2-x1)*(y2-y1)};
+        if (gradient) {
+            gradient[0] = ((q21-q11)*(y2-y) + (q22-q12)*(y-y1))/d;
+            gradient[1] = ((q12-q11)*(x2-x) + (q22-q21)*(x-x1))/d;
+        }
+        return 1.0*q11/d*(x2-x)*(y2-y) + 1.0*q21/d*(x-x1)*(y2-y) + 1.0*q12/d*(x2-x)*(y-y1) + 1.0*q22/d*(x-x1)*(y-y1);
+    }
+};
+
+#endif
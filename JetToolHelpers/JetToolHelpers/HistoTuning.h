@@ -0,0 +1,62 @@
+/**
+ * @file HistoTuning.h
+ * @author S. Schramm, A. Freeman
+ * @brief Choice of the representation HistoInput evaluates by timing the candidates at
+ * initialize(), and the cache of the choices made.
+ * @copyright Copyright (C) 2002-2022 CERN for the benefit of the ATLAS collaboration
+ *
+ */
+
+#ifndef JET_HISTOTUNING_H
+#define JET_HISTOTUNING_H
+
+#include <cstddef>
+#include <string>
+
+#include "JetToolHelpers/HistoLoader.h"
+
+/**
+ * @brief The representations of a histogram HistoInput can evaluate.
+ * - Table : the HistoTable, contents stored as doubles.
+ * - CompressedTable : constant and identical contents stored once, exact.
+ * - QuantizedTable : compressed, smooth tiles quantized within the tolerance.
+ * - Surrogate : Chebyshev expansion within the tolerance.
+ */
+enum class HistoKernel { Table, CompressedTable, QuantizedTable, Surrogate };
+
+const char* toString(HistoKernel kernel);
+bool fromString(const std::string& name, HistoKernel& kernel);
+
+/**
+ * @brief Options of the tuning, see HistoInput::setTuning().
+ */
+struct HistoTuning {
+    // Largest absolute difference allowed with the table, 0 only allows exact kernels.
+    // Checked on the points timed and at the bin centers and edges, not everywhere
+    double maxError {0};
+    // Points drawn uniformly over the axes to time the kernels on
+    std::size_t nSamples {4096};
+    // Timings of each kernel, the fastest one counts
+    int nRepetitions {5};
+    // File keeping the choices across jobs, none if empty
+    std::string cacheFile;
+};
+
+/**
+ * @brief Text file with one line per tuned histogram : the kernel and the key of the
+ * histogram, see getKey(). Lines are appended, the last one of a key is used. Timings
+ * depend on the machine, a cache should only be shared between identical nodes.
+ */
+class HistoTuningCache {
+    public:
+        /**
+         * @brief Name of the histogram, hash of its binning and contents and tolerance :
+         * a histogram changed in the file is tuned again.
+         */
+        static std::string getKey(const std::string& histName, const LoadedHisto& histo, double maxError);
+
+        static bool lookup(const std::string& cacheFile, const std::string& key, HistoKernel& kernel);
+        static bool record(const std::string& cacheFile, const std::string& key, HistoKernel kernel);
+};
+
+#endif
@@ -62,20 +62,22 @@ class InputVariable {
  * @brief Template covering the case where input variable is jet but the attribute
  * is not predefined variation of et, pt, eta, phi... But an arbitrary one. 
  * We suppose that the user is using jets which contain this metadata or else we return
- * an ERRORVALUE.  
+ * an ERRORVALUE. The attribute ID is resolved once at construction, an evaluation 
+ * is then an indexed load and an availability check. 
  * 
  * @tparam T 
  */
-/*
 template <typename T> class InputVariableAttribute : public InputVariable {
     public:
         InputVariableAttribute(const std::string& name) : InputVariable(name), m_acc{name} {}
         virtual float getValue(const xAOD::Jet& jet, const JetContext&) const { 
             return m_acc.isAvailable(jet) ? m_acc(jet)*m_scale : ERRORVALUE; 
         }
+        // false if the attribute name is already used with another type
+        bool isValid() const { return m_acc.auxid() != SG::null_auxid; }
     private:
         SG::AuxElement::ConstAccessor<T> m_acc;
-};*/
+};
 
 template <typename T> class InputVariableJetContext : public InputVariable {
     public:
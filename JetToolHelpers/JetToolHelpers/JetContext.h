@@ -1,7 +1,10 @@
 #ifndef JETCONTEXT_H
 #define JETCONTEXT_H
 
-#include <unordered_map>
+#include <array>
+#include <string>
+#include <string_view>
+#include <vector>
 #include <stdexcept>
 #include <variant>
 #include <type_traits>
@@ -10,68 +13,117 @@ class JetContext {
     public:
         /**
          * @brief add the association (name, value) to the context, functions very much like
-         * a simple dictionarry.  
-         * @tparam T the template type parameter must be supported, 
+         * a simple dictionarry.
+         * @tparam T the template type parameter must be supported,
          * if you're passing a floating point literal be sure to cast the value into a float.
          * @param allowOverwrite specifies wether the name value can be
-         * overwritten if already specified. Default is false. 
+         * overwritten if already specified. Default is false.
          * @returns bool indicating wether value was successfully set or not.
          * @exception std::invalid_argument if type of value being inserted is
-         * not supported. 
+         * not supported.
          */
-        template <typename T> bool setValue(const std::string& name, const T value, bool allowOverwrite = false);
-        
+        template <typename T> bool setValue(std::string_view name, const T value, bool allowOverwrite = false);
+
         /**
-         * @brief get value from context with specified name in value. 
+         * @brief get value from context with specified name in value.
          * @tparam T the type of the value to be returned.
-         * @param name key at which the dictionary is read. SEE EXCEPTIONS. 
+         * @param name key at which the dictionary is read. SEE EXCEPTIONS.
          * @exception std::invalid_argument will be thrown if name is not a key in
          * JetContext.
          * @exception std::bad_variant_access will be thrown if name is a key in
-         * JetContext but is of different type than T. 
-         * @return T the value. 
+         * JetContext but is of different type than T.
+         * @return T the value.
          */
-        template <typename T> void getValue(const std::string& name, T& value) const;
-        template <typename T> T getValue(const std::string& name) const;
-        
+        template <typename T> void getValue(std::string_view name, T& value) const;
+        template <typename T> T getValue(std::string_view name) const;
+
         /**
          * @brief Return true if dictionary has an entry with key name.
          * @param name the key of the dictionary.
-         * @return true/false denoting wether the key is there or not. 
+         * @return true/false denoting wether the key is there or not.
          */
-        bool isAvailable(const std::string& name) const {
-            return dict_.find(name) != dict_.end();
+        bool isAvailable(std::string_view name) const {
+            return find(name) != nullptr;
         };
 
+        /**
+         * @brief Remove all the entries but keep the storage, so that a context reused
+         * event after event stops allocating once it has seen its largest event.
+         */
+        void clear() { m_size = 0; }
+
+        std::size_t size() const { return m_size; }
+
         static constexpr int ERRORVALUE {-999}; // set at compile time.
+        static constexpr std::size_t INLINESIZE {8}; // entries stored in the object itself.
     private:
-        std::unordered_map<std::string, std::variant<int, float>> dict_;
+        struct Entry {
+            std::string name;
+            std::variant<int, float> value;
+        };
+
+        Entry& entry(const std::size_t index) {
+            return index < INLINESIZE ? m_inline[index] : m_overflow[index - INLINESIZE];
+        }
+
+        const Entry* find(std::string_view name) const;
+        Entry& insert(std::string_view name);
+
+        // A handful of entries is typical, a linear scan of contiguous entries beats hashing.
+        // Entries past m_size are kept with their name storage to be reused after clear().
+        std::array<Entry, INLINESIZE> m_inline;
+        std::vector<Entry> m_overflow;
+        std::size_t m_size {0};
 };
 
-template <typename T> void JetContext::getValue(const std::string& name, T& value) const {
-    if(isAvailable(name))
-        value = std::get<T>(dict_.at(name));
+inline const JetContext::Entry* JetContext::find(std::string_view name) const {
+    const std::size_t nInline {m_size < INLINESIZE ? m_size : INLINESIZE};
+    for (std::size_t i = 0; i < nInline; ++i)
+        if (m_inline[i].name == name)
+            return &m_inline[i];
+    for (std::size_t i = 0; i + INLINESIZE < m_size; ++i)
+        if (m_overflow[i].name == name)
+            return &m_overflow[i];
+    return nullptr;
+}
+
+inline JetContext::Entry& JetContext::insert(std::string_view name) {
+    if (m_size >= INLINESIZE && m_size - INLINESIZE == m_overflow.size())
+        m_overflow.emplace_back();
+    Entry& newEntry {entry(m_size++)};
+    newEntry.name.assign(name.data(), name.size()); // reuses the capacity left by previous events
+    return newEntry;
+}
+
+template <typename T> void JetContext::getValue(std::string_view name, T& value) const {
+    const Entry* found {find(name)};
+    if(found)
+        value = std::get<T>(found->value);
     else
-        throw std::invalid_argument(std::string("Key Error : ") + name + std::string(" not found in JetContext."));
+        throw std::invalid_argument(std::string("Key Error : ") + std::string(name) + std::string(" not found in JetContext."));
 }
 
-template <typename T> T JetContext::getValue(const std::string& name) const {
+template <typename T> T JetContext::getValue(std::string_view name) const {
     T value;
     getValue(name, value);
     return value;
 }
 
-template <typename T> bool JetContext::setValue(const std::string& name, const T value, bool allowOverwrite) {
-    if(name == "" || ( !allowOverwrite && isAvailable(name))) 
+template <typename T> bool JetContext::setValue(std::string_view name, const T value, bool allowOverwrite) {
+    if(name.empty())
+        return false;
+
+    Entry* found {const_cast<Entry*>(find(name))};
+    if(found && !allowOverwrite)
         return false;
-        
+
     if constexpr (!std::is_same<T, int>::value && !std::is_same<T, float>::value) {
-        if constexpr ( std::is_same<T, double>::value) // if instantiated with double cast to float. 
-            dict_.insert_or_assign(name, (float) value);
+        if constexpr ( std::is_same<T, double>::value) // if instantiated with double cast to float.
+            (found ? *found : insert(name)).value = (float) value;
         else
             throw std::invalid_argument("Unsupported type provided, please use integers or doubles.");
     } else {
-        dict_.insert_or_assign(name, value);         // insert returns pair with iterator and return code
+        (found ? *found : insert(name)).value = value;
     }
     return true;                                     // if true => insertion, if false => assignement.
 }
@@ -1,9 +1,15 @@
 /**
  * @file Mock.h
- * @brief Contains all mock implementations of  Athena 
+ * @brief Contains all mock implementations of  Athena
  * required to run JetToolHelpers.
  */
 #include <string>
+#include <vector>
+#include <mutex>
+#include <limits>
+#include <typeindex>
+#include <type_traits>
+#include <unordered_map>
 
 #ifndef XAOD_JET_H
 #define XAOD_JET_H
@@ -12,9 +18,9 @@ class LocalP4 {
     public:
         LocalP4(double pt, double eta, double phi, double m)
             : m_pt{pt}, m_eta{eta}, m_phi{phi}, m_mass{m} {}
-        
-        double E() const { return m_pt; } 
-        double Et() const { return m_pt; } 
+
+        double E() const { return m_pt; }
+        double Et() const { return m_pt; }
         double Rapidity() const { return m_eta; }
 
     private:
@@ -24,9 +30,100 @@ class LocalP4 {
         double m_mass;
 };
 
+namespace SG {
+    typedef std::size_t auxid_t;
+    static constexpr auxid_t null_auxid {std::numeric_limits<auxid_t>::max()};
+
+    /**
+     * @brief Gives every attribute name a dense integer ID, like the Athena registry.
+     * Names are resolved once, when an accessor is created, reading an attribute
+     * is then an indexed load.
+     */
+    class AuxTypeRegistry {
+        public:
+            static AuxTypeRegistry& instance() {
+                static AuxTypeRegistry registry;
+                return registry;
+            }
+
+            /**
+             * @brief ID of the attribute name of type T, registered on first use.
+             * @return null_auxid if name was already registered with another type.
+             */
+            template <typename T> auxid_t getAuxID(const std::string& name) {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                auto found = m_ids.find(name);
+                if (found == m_ids.end())
+                    found = m_ids.emplace(name, std::make_pair(m_ids.size(), std::type_index(typeid(T)))).first;
+                return found->second.second == std::type_index(typeid(T)) ? found->second.first : null_auxid;
+            }
+
+        private:
+            std::mutex m_mutex;
+            std::unordered_map<std::string, std::pair<auxid_t, std::type_index>> m_ids;
+    };
+
+    /**
+     * @brief Element holding dynamic attributes, stored densely by ID.
+     * Only float and int attributes are supported by the mock.
+     */
+    class AuxElement {
+        public:
+            template <typename T> class ConstAccessor {
+                static_assert(std::is_same<T, float>::value || std::is_same<T, int>::value,
+                    "Only float and int attributes are supported");
+                public:
+                    ConstAccessor(const std::string& name)
+                        : m_auxid{AuxTypeRegistry::instance().getAuxID<T>(name)} {}
+
+                    bool isAvailable(const AuxElement& element) const {
+                        return m_auxid < element.m_aux.size() && element.m_aux[m_auxid].isSet;
+                    }
+                    T operator()(const AuxElement& element) const {
+                        return element.m_aux[m_auxid].template get<T>();
+                    }
+                    auxid_t auxid() const { return m_auxid; }
+
+                protected:
+                    auxid_t m_auxid;
+            };
+
+            template <typename T> class Accessor : public ConstAccessor<T> {
+                public:
+                    Accessor(const std::string& name) : ConstAccessor<T>(name) {}
+                    void set(AuxElement& element, const T value) const {
+                        if (this->m_auxid == null_auxid)
+                            return;
+                        if (this->m_auxid >= element.m_aux.size())
+                            element.m_aux.resize(this->m_auxid + 1);
+                        element.m_aux[this->m_auxid].template set<T>(value);
+                    }
+            };
+
+        private:
+            struct AuxSlot {
+                union {
+                    float asFloat;
+                    int asInt;
+                };
+                bool isSet {false};
+
+                template <typename T> T get() const {
+                    if constexpr (std::is_same<T, float>::value) return asFloat;
+                    else return asInt;
+                }
+                template <typename T> void set(const T value) {
+                    if constexpr (std::is_same<T, float>::value) asFloat = value;
+                    else asInt = value;
+                    isSet = true;
+                }
+            };
+            std::vector<AuxSlot> m_aux;    // indexed by auxid
+    };
+}
 
 namespace xAOD {
-    class Jet {
+    class Jet : public SG::AuxElement {
         public:
             Jet(double pt, double eta, double phi, double m): m_pt{pt}, m_eta{eta}, m_phi{phi}, m_mass{m} {};
 
@@ -37,6 +134,11 @@ namespace xAOD {
             double e()   const { return p4().E(); }
             double rapidity() const { return p4().Rapidity(); }
             LocalP4 p4() const { return LocalP4(m_pt,m_eta,m_phi,m_mass); }
+
+            // Convenience by name, resolves the ID on every call : use accessors in loops
+            template <typename T> void setAttribute(const std::string& name, const T value) {
+                SG::AuxElement::Accessor<T>(name).set(*this, value);
+            }
         // a jet depends on 4 properties : it's a 4D vector
         private:
             double m_pt;
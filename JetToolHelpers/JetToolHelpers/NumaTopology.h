@@ -0,0 +1,54 @@
+/**
+ * @file NumaTopology.h
+ * @author S. Schramm, A. Freeman
+ * @brief The NUMA nodes of the machine and the node each thread runs on, used to place
+ * one replica of the bundled tables on every node.
+ * @copyright Copyright (C) 2002-2022 CERN for the benefit of the ATLAS collaboration
+ *
+ */
+
+#ifndef JET_NUMATOPOLOGY_H
+#define JET_NUMATOPOLOGY_H
+
+#include <functional>
+#include <vector>
+
+/**
+ * @brief Read from /sys/devices/system/node on Linux. Elsewhere, or if it isn't
+ * available, the machine is a single node holding all the CPUs.
+ */
+class NumaTopology {
+    public:
+        // Evaluations between two checks of the node of the thread, threads may migrate
+        static constexpr unsigned REFRESH {4096};
+
+        static int getNumNodes();
+        static const std::vector<int>& getCpus(int node);
+        static int getNodeOfCpu(int cpu);
+
+        /**
+         * @brief Node of the CPU the calling thread runs on, cached per thread and checked
+         * again every REFRESH calls.
+         */
+        static int getCurrentNode() {
+            thread_local int node {0};
+            thread_local unsigned countdown {0};
+            if (countdown-- == 0) {
+                node = findCurrentNode();
+                countdown = REFRESH;
+            }
+            return node;
+        }
+
+        /**
+         * @brief Run function on a thread bound to the CPUs of node and wait for it. The
+         * memory it touches first is allocated on that node. Runs unbound if the thread
+         * cannot be bound.
+         */
+        static void runOnNode(int node, const std::function<void()>& function);
+
+    private:
+        static int findCurrentNode();
+};
+
+#endif
@@ -0,0 +1,63 @@
+/**
+ * @file RDFHistoInput.h
+ * @author S. Schramm, A. Freeman
+ * @brief RDataFrame integration of HistoInput : defines columns holding the
+ * histogram value of every jet of an event from RVec<float> jet columns.
+ * @copyright Copyright (C) 2002-2022 CERN for the benefit of the ATLAS collaboration
+ *
+ */
+
+#ifndef JET_RDFHISTOINPUT_H
+#define JET_RDFHISTOINPUT_H
+
+#include <string>
+#include <vector>
+
+#include "ROOT/RDataFrame.hxx"
+#include "ROOT/RVec.hxx"
+
+#include "JetToolHelpers/HistoInput.h"
+
+namespace RDFHistoInput {
+    /**
+     * @brief Define the RVec<double> column holding the value of input for
+     * every jet of the event.
+     *
+     * The whole jet collection of an event is evaluated with one HistoInput::getValues()
+     * call. Each processing slot owns its output buffer, so the callable is safe under
+     * ROOT::EnableImplicitMT without any locking and doesn't allocate once the buffers
+     * have grown to the largest jet multiplicity. The column is a view on that buffer,
+     * it is valid for the current entry like any other column.
+     *
+     * @param df the node on which the column is defined.
+     * @param column the name of the new column.
+     * @param input an initialized HistoInput, it must outlive the event loop.
+     * @param axisColumns the RVec<float> jet columns holding the axis values, one per
+     * histogram dimension.
+     * @return ROOT::RDF::RNode the node with the column defined.
+     * @exception std::invalid_argument if the number of axis columns doesn't match
+     * the histogram dimension.
+     */
+    ROOT::RDF::RNode define(
+        ROOT::RDF::RNode df,
+        const std::string& column,
+        const HistoInput& input,
+        const std::vector<std::string>& axisColumns
+    );
+
+    /**
+     * @brief Configuration of one column for defineAll().
+     */
+    struct Column {
+        std::string name;
+        const HistoInput* input;
+        std::vector<std::string> axisColumns;
+    };
+
+    /**
+     * @brief Define one column per configured input, see define().
+     */
+    ROOT::RDF::RNode defineAll(ROOT::RDF::RNode df, const std::vector<Column>& columns);
+}
+
+#endif
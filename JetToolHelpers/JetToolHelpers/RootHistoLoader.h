@@ -0,0 +1,75 @@
+/**
+ * @file RootHistoLoader.h
+ * @author S. Schramm, A. Freeman
+ * @brief Reads the histograms of ROOT files for HistoInput, the only part of the
+ * library depending on ROOT besides the RDataFrame integration.
+ * @copyright Copyright (C) 2002-2022 CERN for the benefit of the ATLAS collaboration
+ *
+ */
+
+#ifndef JET_ROOTHISTOLOADER_H
+#define JET_ROOTHISTOLOADER_H
+
+#include <memory>
+#include <string>
+
+#include "TGraph.h"
+#include "TH1.h"
+#include "TSpline.h"
+
+#include "JetToolHelpers/HistoLoader.h"
+#include "JetToolHelpers/HistoTable.h"
+
+/**
+ * @brief Converts TH1 into the representation HistoInput evaluates, and TGraph, TSpline
+ * and TProfile into the one GraphInput evaluates. Registered as the loaders of the
+ * ".root" files by install(), which the JetToolHelpers library does for every
+ * executable linking it.
+ */
+class RootHistoLoader {
+    public:
+        /**
+         * @brief Register the loader of the ".root" files, once.
+         */
+        static bool install();
+
+        /**
+         * @brief The loader : reads histName from the ROOT file fileName and converts it.
+         */
+        static bool load(const std::string& fileName, const std::string& histName, LoadedHisto& histo);
+
+        /**
+         * @brief The binning and in-range contents of a 1D or 2D histogram.
+         * @return false if the histogram has another dimension.
+         */
+        static bool convert(const TH1& hist, LoadedHisto& histo);
+
+        /**
+         * @brief The graph loader : reads graphName from the ROOT file fileName, a TGraph,
+         * TSpline, TProfile or 1D histogram, and converts it.
+         */
+        static bool loadGraph(const std::string& fileName, const std::string& graphName, LoadedGraph& graph);
+
+        /**
+         * @brief The points of a curve : those of a graph, the knots of a spline with
+         * the cubics of a TSpline3, the bin centers and contents of a 1D histogram. Bins of a TProfile without entries
+         * are skipped, the curve goes from one filled bin to the next.
+         * @return false if the histogram isn't 1D.
+         */
+        static bool convert(const TGraph& graph, LoadedGraph& points);
+        static bool convert(const TSpline& spline, LoadedGraph& points);
+        static bool convert(const TH1& hist, LoadedGraph& points);
+
+        static bool readHistoFromFile(std::unique_ptr<TH1>& m_hist, const std::string m_filename, const std::string m_histName);
+        static double enforceAxisRange(const TAxis& axis, const double inputValue);
+        static double readFromHisto(const TH1& m_hist, const double X, const double Y=0, const double Z=0);
+
+        /**
+         * @brief Convert a 1D or 2D histogram into the table HistoInput evaluates.
+         * @param compression how to store the contents, see HistoTable::create().
+         * @return nullptr if the histogram cannot be represented.
+         */
+        static std::shared_ptr<const HistoTable> compileHisto(const TH1& hist, const HistoCompression& compression = HistoCompression());
+};
+
+#endif
@@ -0,0 +1,97 @@
+/**
+ * @file StaticHistoInput.h
+ * @author S. Schramm, A. Freeman
+ * @brief Evaluation of histograms embedded at build time as constexpr tables, see
+ * util/generate_tables.cpp and jth_generate_tables() in CMakeLists.txt.
+ * @copyright Copyright (C) 2002-2022 CERN for the benefit of the ATLAS collaboration
+ *
+ */
+
+#ifndef JET_STATICHISTOINPUT_H
+#define JET_STATICHISTOINPUT_H
+
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include "JetToolHelpers/HistoTable.h"
+#include "JetToolHelpers/IInputBase.h"
+#include "JetToolHelpers/InputVariable.h"
+
+/**
+ * @brief The variable read along one axis, the arguments of the HistoInput constructors.
+ */
+struct StaticAxisVariable {
+    const char* name;
+    const char* type;
+    bool isJetVar;
+};
+
+/**
+ * @brief HistoInput evaluating a generated table instead of a histogram read from a file.
+ * Table is a struct of the generated header :
+ * - histName : the name of the histogram in the file it was generated from.
+ * - nDims : 1 or 2.
+ * - variables : the StaticAxisVariable of each axis.
+ * - table : the constexpr HistoTable, pointing to the constexpr edges and contents.
+ *
+ * The binning being known at compile time, the compiler folds the axis properties (fixed
+ * or variable bins, ranges) into the lookup. The values are those HistoInput returns.
+ */
+template <typename Table>
+class StaticHistoInput : public IInputBase {
+    public:
+        static_assert(Table::nDims == 1 || Table::nDims == 2, "Only 1D and 2D tables are generated");
+
+        StaticHistoInput(const std::string& name) : IInputBase(name) {}
+
+        virtual bool initialize() {
+            if (m_inVar1) {
+                std::cout << "The input variable(s) were already configured" << std::endl;
+                return false;
+            }
+            m_inVar1 = InputVariable::createVariable(Table::variables[0].name, Table::variables[0].type, Table::variables[0].isJetVar);
+            // variables has a single element for 1D tables
+            if constexpr (Table::nDims > 1)
+                m_inVar2 = InputVariable::createVariable(Table::variables[1].name, Table::variables[1].type, Table::variables[1].isJetVar);
+            if (!m_inVar1 || (Table::nDims > 1 && !m_inVar2)) {
+                std::cout << "Failed to create an input variable" << std::endl;
+                m_inVar1.reset();
+                return false;
+            }
+            return true;
+        }
+
+        virtual bool finalize() { return true; }
+
+        virtual bool getValue(const xAOD::Jet& jet, const JetContext& event, double& value) const {
+            if (!m_inVar1) {
+                std::cout << "The table " << Table::histName << " must be initialized before being evaluated" << std::endl;
+                return false;
+            }
+            const float varValue1 {m_inVar1->getValue(jet, event)};
+            if constexpr (Table::nDims == 1)
+                value = evaluate(varValue1);
+            else
+                value = evaluate(varValue1, m_inVar2->getValue(jet, event));
+            return true;
+        }
+
+        // Same as HistoInput::evaluate() on the table, without any input variable
+        static double evaluate(float varValue1, float varValue2 = 0) {
+            constexpr const HistoTable& table {Table::table};
+            // The clamped values go through float too
+            varValue1 = table.axes[0].enforceRange(varValue1);
+            if constexpr (Table::nDims == 1)
+                return table.interpolate(varValue1);
+
+            varValue2 = table.axes[1].enforceRange(varValue2);
+            return table.interpolate(varValue1, varValue2);
+        }
+
+    private:
+        std::unique_ptr<InputVariable> m_inVar1;
+        std::unique_ptr<InputVariable> m_inVar2;
+};
+
+#endif
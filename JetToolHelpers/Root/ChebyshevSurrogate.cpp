@@ -0,0 +1,167 @@
+/**
+ * @file ChebyshevSurrogate.cpp
+ * @author S. Schramm, A. Freeman
+ * @brief Contains the fit of ChebyshevSurrogate.h
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "JetToolHelpers/ChebyshevSurrogate.h"
+
+namespace {
+    // Points at which the surrogate is compared to the table : edges, quarters and centers of the bins
+    std::vector<double> checkPoints(const HistoAxis& axis) {
+        std::vector<double> points;
+        points.reserve(4*axis.nBins + 1);
+        for (int bin = 1; bin <= axis.nBins; ++bin)
+            for (int quarter = 0; quarter < 4; ++quarter)
+                points.push_back(axis.enforceRange(axis.getBinLowEdge(bin) + 0.25*quarter*axis.getBinWidth(bin)));
+        points.push_back(axis.enforceRange(axis.xMax));
+        return points;
+    }
+
+    // checkPoints() and, between the outer bin centers, 4*(degree+1) Chebyshev extrema,
+    // clamped to the outer bin centers where both sides are flat beyond. Gaps wider than
+    // spacing are split, in up to MAXSPLITS pieces. maxGap is set to the widest gap left
+    const int MAXSPLITS {16};
+    std::vector<double> checkPoints(const std::vector<double>& binPoints, const double low, const double high, const int degree,
+        const double spacing, double& maxGap) {
+        std::vector<double> points {low, high};
+        for (const double point : binPoints)
+            points.push_back(std::min(std::max(point, low), high));
+        const int n {high > low ? 4*(degree + 1) : 0};
+        for (int k = 0; k < n; ++k)
+            points.push_back(0.5*(low + high) + 0.5*(high - low)*std::cos(M_PI * k / (n - 1)));
+        std::sort(points.begin(), points.end());
+        points.erase(std::unique(points.begin(), points.end()), points.end());
+
+        std::vector<double> refined {points.front()};
+        maxGap = 0;
+        for (std::size_t i = 1; i < points.size(); ++i) {
+            const double gap {points[i] - points[i-1]};
+            const int pieces {spacing > 0 ? static_cast<int>(std::min<double>(std::ceil(gap / spacing), MAXSPLITS)) : 1};
+            for (int piece = 1; piece < pieces; ++piece)
+                refined.push_back(points[i-1] + gap*piece/pieces);
+            refined.push_back(points[i]);
+            maxGap = std::max(maxGap, gap / pieces);
+        }
+        return refined;
+    }
+
+    // Coefficients of the degree n-1 expansion interpolating values at the n Chebyshev nodes
+    void chebyshevTransform(const double* values, double* coefficients, const int n, const std::size_t stride) {
+        std::vector<double> result(n, 0.);
+        for (int j = 0; j < n; ++j) {
+            for (int k = 0; k < n; ++k)
+                result[j] += values[k*stride] * std::cos(M_PI * j * (k + 0.5) / n);
+            result[j] *= (j == 0 ? 1. : 2.) / n;
+        }
+        for (int j = 0; j < n; ++j)
+            coefficients[j*stride] = result[j];
+    }
+}
+
+std::shared_ptr<const ChebyshevSurrogate> ChebyshevSurrogate::fit(const HistoTable& table, const double maxError,
+    const int maxDegree, double& achievedError) {
+    achievedError = std::numeric_limits<double>::infinity();
+
+    ChebyshevSurrogate base;
+    base.m_nDims = table.nDims;
+    for (int i = 0; i < 2; ++i) {
+        const HistoAxis& axis {table.axes[i]};
+        base.m_low[i] = i < table.nDims ? axis.getBinCenter(1) : 0.;
+        base.m_high[i] = i < table.nDims ? axis.getBinCenter(axis.nBins) : 0.;
+        base.m_invWidth[i] = base.m_high[i] > base.m_low[i] ? 1./(base.m_high[i] - base.m_low[i]) : 0.;
+    }
+
+    const std::vector<double> binPointsX {checkPoints(table.axes[0])};
+    const std::vector<double> binPointsY {table.nDims > 1 ? checkPoints(table.axes[1]) : std::vector<double>{0.}};
+    double largestContent {0};
+    for (int binY = 1; binY <= (table.nDims > 1 ? table.axes[1].nBins : 1); ++binY)
+        for (int binX = 1; binX <= table.axes[0].nBins; ++binX)
+            largestContent = std::max(largestContent, std::abs(table.getBinContent(binX, binY)));
+
+    // Degrees 1, 2, 4... up to maxDegree
+    const int highestDegree {std::min(maxDegree, MAXDEGREE)};
+    for (int degree = 1; degree / 2 < highestDegree; degree *= 2) {
+        auto surrogate {std::shared_ptr<ChebyshevSurrogate>(new ChebyshevSurrogate(base))};
+        for (int i = 0; i < 2; ++i)
+            surrogate->m_nCoefficients[i] = surrogate->m_invWidth[i] > 0 ? std::min(degree, highestDegree) + 1 : 1;
+        const int nX {surrogate->m_nCoefficients[0]};
+        const int nY {surrogate->m_nCoefficients[1]};
+
+        // Table values at the nodes, then transform along x and along y
+        std::vector<double>& coefficients {surrogate->m_coefficients};
+        coefficients.resize(nX * nY);
+        for (int kY = 0; kY < nY; ++kY) {
+            const double tY {std::cos(M_PI * (kY + 0.5) / nY)};
+            const double y {0.5*(base.m_low[1] + base.m_high[1]) + 0.5*(base.m_high[1] - base.m_low[1])*tY};
+            for (int kX = 0; kX < nX; ++kX) {
+                const double tX {std::cos(M_PI * (kX + 0.5) / nX)};
+                const double x {0.5*(base.m_low[0] + base.m_high[0]) + 0.5*(base.m_high[0] - base.m_low[0])*tX};
+                coefficients[kX + nX*kY] = table.nDims == 1 ? table.interpolate(x) : table.interpolate(x, y);
+            }
+        }
+        for (int kY = 0; kY < nY; ++kY)
+            chebyshevTransform(coefficients.data() + nX*kY, coefficients.data() + nX*kY, nX, 1);
+        for (int kX = 0; kX < nX; ++kX)
+            chebyshevTransform(coefficients.data() + kX, coefficients.data() + kX, nY, nX);
+
+        // Bounds on the second derivatives of the difference, those of the expansion as
+        // the interpolation is linear along each axis between bin centers : by Markov's
+        // inequality |T_k''| <= k^2 (k^2 - 1) / 3 on [-1, 1]
+        // The rounding of both evaluations is within a few ulps of the sum of the magnitudes
+        double curvatures[2] {0, 0};
+        double magnitude {largestContent};
+        for (int kY = 0; kY < nY; ++kY) {
+            for (int kX = 0; kX < nX; ++kX) {
+                curvatures[0] += kX*kX*(kX*kX - 1)/3.*std::abs(coefficients[kX + nX*kY]);
+                curvatures[1] += kY*kY*(kY*kY - 1)/3.*std::abs(coefficients[kX + nX*kY]);
+                magnitude += std::abs(coefficients[kX + nX*kY]);
+            }
+        }
+        const double rounding {4*(nX + nY)*std::numeric_limits<double>::epsilon()*magnitude};
+        for (int i = 0; i < 2; ++i)
+            curvatures[i] *= 4*base.m_invWidth[i]*base.m_invWidth[i];
+
+        // The difference at the points, then anywhere : between points, which include
+        // the bin centers, it is within the interpolation of its values at the nearest
+        // ones plus gap^2/8 times its second derivative along each axis. Points are added
+        // until that takes at most half of maxError
+        double sampled {0};
+        auto getError = [&](const double spacingX, const double spacingY) {
+            double gaps[2];
+            const std::vector<double> pointsX {checkPoints(binPointsX, base.m_low[0], base.m_high[0], nX - 1, spacingX, gaps[0])};
+            const std::vector<double> pointsY {checkPoints(binPointsY, base.m_low[1], base.m_high[1], nY - 1, spacingY, gaps[1])};
+            double error {0};
+            for (const double y : pointsY) {
+                for (const double x : pointsX) {
+                    const double difference {table.nDims == 1 ? surrogate->evaluate(x) - table.interpolate(x)
+                        : surrogate->evaluate(x, y) - table.interpolate(x, y)};
+                    // NaN contents can't be approximated
+                    error = std::isnan(difference) ? std::numeric_limits<double>::infinity() : std::max(error, std::abs(difference));
+                }
+            }
+            sampled = error;
+            return error + (curvatures[0]*gaps[0]*gaps[0] + curvatures[1]*gaps[1]*gaps[1]) / 8 + rounding;
+        };
+        double error {getError(0, 0)};
+        // Not worth refining unless the points leave room for the gaps
+        if (error > maxError && sampled <= 0.5*maxError) {
+            const double share {0.5*maxError / table.nDims};
+            const double spacingX {curvatures[0] > 0 ? std::sqrt(8*share / curvatures[0]) : 0};
+            const double spacingY {curvatures[1] > 0 ? std::sqrt(8*share / curvatures[1]) : 0};
+            error = std::min(error, getError(spacingX, spacingY));
+        }
+        achievedError = std::min(achievedError, error);
+        if (error <= maxError) {
+            achievedError = error;
+            return surrogate;
+        }
+        if (degree >= highestDegree)
+            break;
+    }
+    return nullptr;
+}
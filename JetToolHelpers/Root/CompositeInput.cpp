@@ -0,0 +1,492 @@
+/**
+ * @file CompositeInput.cpp
+ * @author S. Schramm, A. Freeman
+ * @brief Contains the folding and evaluation of CompositeInput.h
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <stdexcept>
+
+#include "JetToolHelpers/CompositeInput.h"
+#include "JetToolHelpers/HistoLoader.h"
+
+namespace {
+    thread_local std::vector<double> t_childValues;
+
+    bool sameBinning(const HistoAxisBinning& a, const HistoAxisBinning& b) {
+        return a.nBins == b.nBins && a.xMin == b.xMin && a.xMax == b.xMax && a.edges == b.edges;
+    }
+
+    // A polynomial over an interpolation cell, in the tensor Bernstein basis of degree nx
+    // along x and ny along y. Over the cell its values lie within its coefficients, those
+    // of the interpolation of a cell being the contents at its corners.
+    struct Bernstein {
+        int nx {0};
+        int ny {0};
+        std::vector<double> coefficients;   // [i + (nx+1)*j]
+    };
+
+    double binomial(const int n, const int k) {
+        double result {1};
+        for (int i = 1; i <= k; ++i)
+            result = result * (n - k + i) / i;
+        return result;
+    }
+
+    // The product of p and q, of the sum of their degrees
+    void multiply(const Bernstein& p, const Bernstein& q, Bernstein& product) {
+        product.nx = p.nx + q.nx;
+        product.ny = p.ny + q.ny;
+        product.coefficients.assign((product.nx + 1)*(product.ny + 1), 0.);
+        for (int pj = 0; pj <= p.ny; ++pj) {
+            for (int qj = 0; qj <= q.ny; ++qj) {
+                const double wy {binomial(p.ny, pj)*binomial(q.ny, qj)/binomial(product.ny, pj + qj)};
+                for (int pi = 0; pi <= p.nx; ++pi) {
+                    for (int qi = 0; qi <= q.nx; ++qi) {
+                        const double wx {binomial(p.nx, pi)*binomial(q.nx, qi)/binomial(product.nx, pi + qi)};
+                        product.coefficients[pi + qi + (product.nx + 1)*(pj + qj)] += wx*wy
+                            * p.coefficients[pi + (p.nx + 1)*pj] * q.coefficients[qi + (q.nx + 1)*qj];
+                    }
+                }
+            }
+        }
+    }
+
+    // p in the basis of the degrees of q, at least its own
+    void elevate(const Bernstein& p, const Bernstein& q, Bernstein& elevated) {
+        Bernstein one {q.nx - p.nx, q.ny - p.ny, {}};
+        one.coefficients.assign((one.nx + 1)*(one.ny + 1), 1.);
+        multiply(p, one, elevated);
+    }
+
+    // Bound on |p - q| over the cell, of the same degrees
+    double getMaxDifference(const Bernstein& p, const Bernstein& q) {
+        double result {0};
+        for (std::size_t i = 0; i < p.coefficients.size(); ++i) {
+            const double difference {std::abs(p.coefficients[i] - q.coefficients[i])};
+            if (!(difference <= result))
+                result = std::isnan(difference) ? INFINITY : difference;
+        }
+        return result;
+    }
+
+    // The part [s0, s1] x [t0, t1] of an interpolation, of degree 1 or 0 along each axis,
+    // over the whole cell [0, 1] x [0, 1]
+    Bernstein restrict(const Bernstein& cell, const double s0, const double s1, const double t0, const double t1) {
+        auto at = [&](const double s, const double t) {
+            const double* c {cell.coefficients.data()};
+            const double low {cell.nx ? c[0] + s*(c[1] - c[0]) : c[0]};
+            if (!cell.ny)
+                return low;
+            const double high {c[2] + s*(c[3] - c[2])};
+            return low + t*(high - low);
+        };
+        Bernstein part {cell.nx, cell.ny, {}};
+        for (const double t : {t0, t1}) {
+            for (const double s : {s0, s1}) {
+                part.coefficients.push_back(at(s, t));
+                if (!cell.nx)
+                    break;
+            }
+            if (!cell.ny)
+                break;
+        }
+        return part;
+    }
+
+    // Maximum halvings of a cell along each axis while its bound is above the tolerance
+    const int MAXSPLITS {4};
+
+    /**
+     * Bound on the difference between the combination of the interpolations of children
+     * over a cell and the interpolation folded of their combined corners. Products are
+     * polynomials, ratios a/b once multiplied by b : |a/b - folded| <= |a - b*folded| / min|b|,
+     * where min|b| is that of the corners of b, which doesn't change sign. The bound of a
+     * cell tightens as it is halved, it is while above tolerance.
+     */
+    double getCellBound(const CompositeOperation operation, const std::vector<Bernstein>& children,
+        const Bernstein& folded, const double tolerance, const int splits) {
+        Bernstein product {children[0]}, next, elevated;
+        double bound {INFINITY};
+        if (operation == CompositeOperation::Product) {
+            for (std::size_t i = 1; i < children.size(); ++i) {
+                multiply(product, children[i], next);
+                std::swap(product, next);
+            }
+            elevate(folded, product, elevated);
+            bound = getMaxDifference(product, elevated);
+        } else {
+            const Bernstein& denominator {children[1]};
+            const auto range = std::minmax_element(denominator.coefficients.begin(), denominator.coefficients.end());
+            const double smallest {*range.first > 0 ? *range.first : *range.second < 0 ? -*range.second : 0.};
+            multiply(denominator, folded, product);
+            elevate(children[0], product, elevated);
+            if (smallest > 0)
+                bound = getMaxDifference(elevated, product) / smallest;
+        }
+        if (bound <= tolerance || splits == MAXSPLITS || std::isinf(bound) || std::isnan(bound))
+            return std::isnan(bound) ? INFINITY : bound;
+
+        // The largest bound of the halves, quarters in 2D
+        double halves {0};
+        std::vector<Bernstein> parts(children.size());
+        for (const double t0 : {0., 0.5}) {
+            const double t1 {folded.ny ? t0 + 0.5 : 1.};
+            for (const double s0 : {0., 0.5}) {
+                for (std::size_t i = 0; i < children.size(); ++i)
+                    parts[i] = restrict(children[i], s0, s0 + 0.5, folded.ny ? t0 : 0., t1);
+                const Bernstein part {restrict(folded, s0, s0 + 0.5, folded.ny ? t0 : 0., t1)};
+                halves = std::max(halves, getCellBound(operation, parts, part, tolerance, splits + 1));
+                if (halves > tolerance)
+                    return halves;
+            }
+            if (!folded.ny)
+                break;
+        }
+        return halves;
+    }
+}
+
+CompositeInput::CompositeInput(
+            const std::string& name,
+            const CompositeOperation operation,
+            std::vector<std::unique_ptr<IInputBase>> children
+): IInputBase(name),
+      m_operation{operation}, m_children{std::move(children)}
+{
+    if (m_children.empty())
+        throw std::runtime_error("A composite input needs at least one child");
+    for (const std::unique_ptr<IInputBase>& child : m_children)
+        if (!child)
+            throw std::runtime_error("The children of a composite input cannot be null");
+    if ((operation == CompositeOperation::Difference || operation == CompositeOperation::Ratio) && m_children.size() != 2)
+        throw std::runtime_error("Differences and ratios take exactly two children");
+}
+
+bool CompositeInput::initialize() {
+    if (m_initialized) {
+        std::cout << "The composite input was already initialized" << std::endl;
+        return false;
+    }
+    for (const std::unique_ptr<IInputBase>& child : m_children) {
+        if (!child->initialize()) {
+            std::cout << "Failed to initialize a child of the composite input" << std::endl;
+            return false;
+        }
+    }
+
+    // The variables are read once for all the children if they all read the same ones
+    m_histos.clear();
+    for (const std::unique_ptr<IInputBase>& child : m_children) {
+        const HistoInput* histo {dynamic_cast<const HistoInput*>(child.get())};
+        if (!histo || histo->getNDims() > 2)
+            break;
+        const HistoInput* first {m_histos.empty() ? histo : m_histos.front()};
+        bool same {histo->getNDims() == first->getNDims()};
+        for (int axis = 0; same && axis < histo->getNDims(); ++axis)
+            same = histo->getVarName(axis) == first->getVarName(axis) && histo->getVarType(axis) == first->getVarType(axis)
+                && histo->isJetVar(axis) == first->isJetVar(axis);
+        if (!same)
+            break;
+        m_histos.push_back(histo);
+    }
+    if (m_histos.size() == m_children.size()) {
+        const HistoInput& first {*m_histos.front()};
+        m_nDims = first.getNDims();
+        m_inVar1 = InputVariable::createVariable(first.getVarName(0), first.getVarType(0), first.isJetVar(0));
+        if (m_nDims > 1)
+            m_inVar2 = InputVariable::createVariable(first.getVarName(1), first.getVarType(1), first.isJetVar(1));
+        if (!m_inVar1 || (m_nDims > 1 && !m_inVar2)) {
+            std::cout << "Failed to create an input variable" << std::endl;
+            return false;
+        }
+        std::vector<LoadedHisto> histos;
+        if (loadHistos(histos)) {
+            m_table = fold(histos);
+            const bool linear {m_operation == CompositeOperation::Sum || m_operation == CompositeOperation::Difference};
+            if (!m_table && !linear)
+                fuse(histos);
+        }
+    } else {
+        m_histos.clear();
+    }
+
+    // The children of a folded or fused input are never evaluated
+    if (m_table || m_fused) {
+        for (const std::unique_ptr<IInputBase>& child : m_children)
+            child->finalize();
+    }
+    m_initialized = true;
+    return true;
+}
+
+bool CompositeInput::finalize() {
+    bool success {true};
+    if (m_initialized && !m_table && !m_fused) {
+        for (const std::unique_ptr<IInputBase>& child : m_children)
+            success = child->finalize() && success;
+    }
+    m_table.reset();
+    m_fused.reset();
+    m_fusedContents.clear();
+    m_histos.clear();
+    m_inVar1.reset();
+    m_inVar2.reset();
+    m_initialized = false;
+    return success;
+}
+
+bool CompositeInput::loadHistos(std::vector<LoadedHisto>& histos) const {
+    // The histograms are read again : the compiled tables of the children may be
+    // compressed or replaced by surrogates
+    histos.assign(m_histos.size(), LoadedHisto());
+    for (std::size_t i = 0; i < m_histos.size(); ++i) {
+        LoadedHisto& histo {histos[i]};
+        if (!HistoLoader::load(m_histos[i]->getFileName(), m_histos[i]->getHistName(), histo))
+            return false;
+        const LoadedHisto& first {histos.front()};
+        bool same {histo.binnings.size() == first.binnings.size() && histo.contents.size() == first.contents.size()};
+        for (std::size_t axis = 0; same && axis < histo.binnings.size(); ++axis)
+            same = sameBinning(histo.binnings[axis], first.binnings[axis]);
+        if (!same)
+            return false;
+    }
+    return true;
+}
+
+std::shared_ptr<const HistoTable> CompositeInput::fold(const std::vector<LoadedHisto>& histos) const {
+    LoadedHisto folded {histos.front()};
+    for (std::size_t i = 1; i < histos.size(); ++i)
+        for (std::size_t bin = 0; bin < folded.contents.size(); ++bin)
+            folded.contents[bin] = combine(folded.contents[bin], histos[i].contents[bin]);
+
+    const bool linear {m_operation == CompositeOperation::Sum || m_operation == CompositeOperation::Difference};
+    if (!linear && !(m_foldingTolerance > 0 && getFoldingBound(histos, folded) <= m_foldingTolerance))
+        return nullptr;
+    return HistoTable::create(folded.binnings, folded.contents);
+}
+
+void CompositeInput::fuse(const std::vector<LoadedHisto>& histos) {
+    m_fused = HistoTable::create(histos.front().binnings, histos.front().contents);
+    if (!m_fused)
+        return;
+    const std::size_t nChildren {histos.size()};
+    const std::size_t nBins {histos.front().contents.size()};
+    m_fusedContents.resize(nBins * nChildren);
+    for (std::size_t i = 0; i < nChildren; ++i)
+        for (std::size_t bin = 0; bin < nBins; ++bin)
+            m_fusedContents[bin*nChildren + i] = histos[i].contents[bin];
+}
+
+double CompositeInput::getFoldingBound(const std::vector<LoadedHisto>& histos, const LoadedHisto& folded) const {
+    // Cell by cell, the interpolations of the children and of the folded contents are of
+    // degree 1 along each axis, their corners the contents : those of the first and last
+    // bins beyond them in 2D as TH2::Interpolate. 1D tables agree out of the bin centers.
+    const int nBinsX {folded.binnings[0].nBins};
+    const int nBinsY {m_nDims > 1 ? folded.binnings[1].nBins : 1};
+    const int ny {m_nDims > 1 ? 1 : 0};
+    const int firstSegment {m_nDims > 1 ? 0 : 1};
+    const int lastSegmentX {m_nDims > 1 ? nBinsX : nBinsX - 1};
+    const int lastSegmentY {m_nDims > 1 ? nBinsY : 1};
+    auto getCell = [&](const std::vector<double>& contents, const int segmentX, const int segmentY, Bernstein& cell) {
+        cell.nx = 1;
+        cell.ny = ny;
+        cell.coefficients.clear();
+        for (int j = 0; j <= ny; ++j) {
+            const int binY {std::min(std::max(segmentY + j, 1), nBinsY)};
+            for (int i = 0; i <= 1; ++i)
+                cell.coefficients.push_back(contents[std::min(std::max(segmentX + i, 1), nBinsX) - 1 + nBinsX*(binY - 1)]);
+        }
+    };
+
+    double bound {0};
+    std::vector<Bernstein> children(histos.size());
+    Bernstein interpolated;
+    for (int segmentY = firstSegment; segmentY <= lastSegmentY; ++segmentY) {
+        for (int segmentX = firstSegment; segmentX <= lastSegmentX; ++segmentX) {
+            for (std::size_t i = 0; i < histos.size(); ++i)
+                getCell(histos[i].contents, segmentX, segmentY, children[i]);
+            getCell(folded.contents, segmentX, segmentY, interpolated);
+            bound = std::max(bound, getCellBound(m_operation, children, interpolated, m_foldingTolerance, 0));
+            // Not folded whatever the other cells
+            if (bound > m_foldingTolerance)
+                return bound;
+        }
+    }
+    return bound;
+}
+
+double CompositeInput::evaluate(const HistoTable& table, float varValue1, float varValue2, HistoCell& cell) const {
+    // Same as HistoInput::evaluate() over the table
+    varValue1 = table.axes[0].enforceRange(varValue1);
+    if (m_nDims == 1)
+        return table.interpolate(varValue1, cell);
+    varValue2 = table.axes[1].enforceRange(varValue2);
+    return table.interpolate(varValue1, varValue2, cell);
+}
+
+double CompositeInput::combineBin(const int binX, const int binY) const {
+    const std::size_t nChildren {m_histos.size()};
+    const double* contents {&m_fusedContents[(binX - 1 + m_fused->axes[0].nBins*(binY - 1)) * nChildren]};
+    double value {contents[0]};
+    for (std::size_t i = 1; i < nChildren; ++i)
+        value = combine(value, contents[i]);
+    return value;
+}
+
+double CompositeInput::evaluateFused(float varValue1, float varValue2, HistoCell& cell) const {
+    // The steps of HistoTable::interpolate(), each child's contents with the same weights
+    // in the same expression, so that the values are those of the children
+    const std::size_t nChildren {m_histos.size()};
+    const int nBinsX {m_fused->axes[0].nBins};
+    const HistoAxis& xAxis {m_fused->axes[0]};
+    varValue1 = xAxis.enforceRange(varValue1);
+    const double x {varValue1};
+    const int binX {xAxis.findBin(x, cell.bins[0])};
+    cell.bins[0] = binX;
+    if (m_nDims == 1) {
+        if (x <= xAxis.getBinCenter(1))
+            return combineBin(1, 1);
+        if (x >= xAxis.getBinCenter(nBinsX))
+            return combineBin(nBinsX, 1);
+        const int segment {x <= xAxis.getBinCenter(binX) ? binX-1 : binX};
+        const double x0 {xAxis.getBinCenter(segment)}, x1 {xAxis.getBinCenter(segment+1)};
+        const double* low {&m_fusedContents[(segment - 1) * nChildren]};
+        const double* high {low + nChildren};
+        double value {0};
+        for (std::size_t i = 0; i < nChildren; ++i) {
+            const double childValue {low[i] + (x-x0)*((high[i]-low[i])/(x1-x0))};
+            value = i == 0 ? childValue : combine(value, childValue);
+        }
+        return value;
+    }
+
+    const HistoAxis& yAxis {m_fused->axes[1]};
+    varValue2 = yAxis.enforceRange(varValue2);
+    const double y {varValue2};
+    const int binY {yAxis.findBin(y, cell.bins[1])};
+    cell.bins[1] = binY;
+    const int segmentX {xAxis.getBinUpEdge(binX) - x <= xAxis.getBinWidth(binX)/2 ? binX : binX-1};
+    const int segmentY {yAxis.getBinUpEdge(binY) - y <= yAxis.getBinWidth(binY)/2 ? binY : binY-1};
+    const double x1 {xAxis.getBinCenter(segmentX)}, x2 {xAxis.getBinCenter(segmentX+1)};
+    const double y1 {yAxis.getBinCenter(segmentY)}, y2 {yAxis.getBinCenter(segmentY+1)};
+    const int binX1 {std::max(xAxis.findBin(x1), 1)};
+    const int binX2 {std::min(xAxis.findBin(x2), nBinsX)};
+    const int binY1 {std::max(yAxis.findBin(y1), 1)};
+    const int binY2 {std::min(yAxis.findBin(y2), yAxis.nBins)};
+    const double* q11 {&m_fusedContents[(binX1 - 1 + nBinsX*(binY1 - 1)) * nChildren]};
+    const double* q12 {&m_fusedContents[(binX1 - 1 + nBinsX*(binY2 - 1)) * nChildren]};
+    const double* q21 {&m_fusedContents[(binX2 - 1 + nBinsX*(binY1 - 1)) * nChildren]};
+    const double* q22 {&m_fusedContents[(binX2 - 1 + nBinsX*(binY2 - 1)) * nChildren]};
+    const double d {1.0*(x2-x1)*(y2-y1)};
+    double value {0};
+    for (std::size_t i = 0; i < nChildren; ++i) {
+        const double childValue {1.0*q11[i]/d*(x2-x)*(y2-y) + 1.0*q21[i]/d*(x-x1)*(y2-y)
+            + 1.0*q12[i]/d*(x2-x)*(y-y1) + 1.0*q22[i]/d*(x-x1)*(y-y1)};
+        value = i == 0 ? childValue : combine(value, childValue);
+    }
+    return value;
+}
+
+bool CompositeInput::getValue(const xAOD::Jet& jet, const JetContext& event, double& value) const {
+    if (!m_initialized) {
+        std::cout << "The composite input must be initialized before being evaluated" << std::endl;
+        return false;
+    }
+    if (m_histos.empty()) {
+        for (std::size_t i = 0; i < m_children.size(); ++i) {
+            double childValue;
+            if (!m_children[i]->getValue(jet, event, childValue))
+                return false;
+            value = i == 0 ? childValue : combine(value, childValue);
+        }
+        return true;
+    }
+
+    const float varValue1 {m_inVar1->getValue(jet, event)};
+    const float varValue2 {m_nDims > 1 ? m_inVar2->getValue(jet, event) : 0.f};
+    if (m_table) {
+        HistoCell cell;
+        value = evaluate(*m_table, varValue1, varValue2, cell);
+        return true;
+    }
+    if (m_fused) {
+        HistoCell cell;
+        value = evaluateFused(varValue1, varValue2, cell);
+        return true;
+    }
+    for (std::size_t i = 0; i < m_histos.size(); ++i) {
+        double childValue;
+        const bool success {m_nDims > 1 ? m_histos[i]->getValues(&varValue1, &varValue2, &childValue, 1)
+            : m_histos[i]->getValues(&varValue1, &childValue, 1)};
+        if (!success)
+            return false;
+        value = i == 0 ? childValue : combine(value, childValue);
+    }
+    return true;
+}
+
+template <typename T>
+bool CompositeInput::evaluateBatch(const T* x, const T* y, double* values, std::size_t nValues, std::size_t stride) const {
+    if (!m_initialized) {
+        std::cout << "The composite input must be initialized before evaluating a batch" << std::endl;
+        return false;
+    }
+    if (m_histos.empty()) {
+        std::cout << "Batches are only evaluated for histograms reading the same variables" << std::endl;
+        return false;
+    }
+    if ((y == nullptr) != (m_nDims == 1)) {
+        std::cout << "Batch of " << (y ? 2 : 1) << "D inputs provided for a " << m_nDims << "D composite input" << std::endl;
+        return false;
+    }
+
+    // Inputs go through float like in getValue()
+    if (m_table) {
+        const HistoTable& table {*m_table};
+        HistoCell cell;
+        for (std::size_t i = 0; i < nValues; ++i)
+            values[i] = evaluate(table, x[i*stride], y ? y[i*stride] : 0, cell);
+        return true;
+    }
+    if (m_fused) {
+        HistoCell cell;
+        for (std::size_t i = 0; i < nValues; ++i)
+            values[i] = evaluateFused(x[i*stride], y ? y[i*stride] : 0, cell);
+        return true;
+    }
+
+    // Each child over the whole batch, accumulated into values. The scratch of the thread
+    // keeps its capacity from one batch to the next
+    std::vector<double>& childValues {t_childValues};
+    if (childValues.size() < nValues)
+        childValues.resize(nValues);
+    for (std::size_t i = 0; i < m_histos.size(); ++i) {
+        double* output {i == 0 ? values : childValues.data()};
+        if (!(y ? m_histos[i]->getValues(x, y, output, nValues, stride) : m_histos[i]->getValues(x, output, nValues, stride)))
+            return false;
+        if (i > 0) {
+            for (std::size_t j = 0; j < nValues; ++j)
+                values[j] = combine(values[j], childValues[j]);
+        }
+    }
+    return true;
+}
+
+bool CompositeInput::getValues(const double* x, double* values, std::size_t nValues, std::size_t stride) const {
+    return evaluateBatch<double>(x, nullptr, values, nValues, stride);
+}
+
+bool CompositeInput::getValues(const float* x, double* values, std::size_t nValues, std::size_t stride) const {
+    return evaluateBatch<float>(x, nullptr, values, nValues, stride);
+}
+
+bool CompositeInput::getValues(const double* x, const double* y, double* values, std::size_t nValues, std::size_t stride) const {
+    return evaluateBatch<double>(x, y, values, nValues, stride);
+}
+
+bool CompositeInput::getValues(const float* x, const float* y, double* values, std::size_t nValues, std::size_t stride) const {
+    return evaluateBatch<float>(x, y, values, nValues, stride);
+}
@@ -0,0 +1,92 @@
+/**
+ * @file EpochReclaimer.cpp
+ * @author S. Schramm, A. Freeman
+ * @brief Contains the reader slots and reclamation of EpochReclaimer.h
+ */
+
+#include <stdexcept>
+
+#if defined(__linux__)
+#include <linux/membarrier.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "JetToolHelpers/EpochReclaimer.h"
+
+EpochReclaimer::EpochReclaimer() {
+#if defined(__linux__) && defined(__NR_membarrier)
+    m_asymmetric = syscall(__NR_membarrier, MEMBARRIER_CMD_REGISTER_PRIVATE_EXPEDITED, 0, 0) == 0;
+#endif
+}
+
+void EpochReclaimer::registerThread() {
+    // Frees the slot when the thread exits
+    struct Release {
+        std::atomic<bool>* used {nullptr};
+        ~Release() {
+            if (used)
+                used->store(false);
+        }
+    };
+    thread_local Release release;
+
+    for (Slot& slot : m_slots) {
+        bool expected {false};
+        if (!slot.used.load(std::memory_order_relaxed) && slot.used.compare_exchange_strong(expected, true)) {
+            release.used = &slot.used;
+            t_reader.epoch = &slot.epoch;
+            return;
+        }
+    }
+    throw std::runtime_error("More than " + std::to_string(MAXTHREADS) + " threads have read, a slot is held until its thread exits");
+}
+
+void EpochReclaimer::retire(std::function<void()> deleter) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        // Readers that entered before this epoch may hold the object
+        m_retired.emplace_back(m_epoch.fetch_add(1) + 1, std::move(deleter));
+    }
+    reclaim();
+}
+
+std::size_t EpochReclaimer::reclaim() {
+    std::vector<std::function<void()>> deleters;
+    std::size_t nWaiting {0};
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        // Makes the stores of the readers that entered visible before reading the slots
+#if defined(__linux__) && defined(__NR_membarrier)
+        if (m_asymmetric)
+            syscall(__NR_membarrier, MEMBARRIER_CMD_PRIVATE_EXPEDITED, 0, 0);
+#endif
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::uint64_t oldest {m_epoch.load()};
+        for (const Slot& slot : m_slots) {
+            const std::uint64_t epoch {slot.epoch.load()};
+            if (epoch != 0 && epoch < oldest)
+                oldest = epoch;
+        }
+
+        std::size_t nKept {0};
+        for (std::size_t i = 0; i < m_retired.size(); ++i) {
+            if (m_retired[i].first <= oldest)
+                deleters.push_back(std::move(m_retired[i].second));
+            else if (nKept++ != i)
+                m_retired[nKept - 1] = std::move(m_retired[i]);
+        }
+        m_retired.resize(nKept);
+        nWaiting = m_retired.size();
+    }
+    // Outside of the lock, the deleters may retire objects themselves
+    for (const std::function<void()>& deleter : deleters)
+        deleter();
+    return nWaiting;
+}
+
+EpochReclaimer::~EpochReclaimer() {
+    // No reader is left when the program exits
+    for (auto& retired : m_retired)
+        retired.second();
+}
@@ -0,0 +1,160 @@
+/**
+ * @file EventDriver.cpp
+ * @author S. Schramm, A. Freeman
+ * @brief Contains the thread pool and the scheduling of EventDriver.h
+ */
+
+#include <algorithm>
+
+#include "JetToolHelpers/EventDriver.h"
+
+EventDriver::EventDriver(std::size_t nThreads) {
+    if (nThreads == 0)
+        nThreads = std::max(1u, std::thread::hardware_concurrency());
+    m_queues.reset(new Queue[nThreads]);
+    for (std::size_t i = 0; i + 1 < nThreads; ++i)
+        m_workers.emplace_back(&EventDriver::work, this, i);
+}
+
+EventDriver::~EventDriver() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_start.notify_all();
+    for (std::thread& worker : m_workers)
+        worker.join();
+}
+
+void EventDriver::work(const std::size_t index) {
+    std::size_t generation {0};
+    while (true) {
+        Job* job {nullptr};
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_start.wait(lock, [&] { return m_stop || m_generation != generation; });
+            if (m_stop)
+                return;
+            generation = m_generation;
+            job = m_job;
+        }
+        runChunks(index, *job);
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            --m_nBusy;
+        }
+        m_done.notify_one();
+    }
+}
+
+bool EventDriver::takeChunk(const std::size_t index, Chunk& chunk) {
+    // Own chunks from the front, in event order
+    {
+        Queue& own {m_queues[index]};
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.chunks.empty()) {
+            chunk = own.chunks.front();
+            own.chunks.pop_front();
+            return true;
+        }
+    }
+    // Steal from the back of the others, far from where their owners work
+    const std::size_t nQueues {getNumThreads()};
+    for (std::size_t i = 1; i < nQueues; ++i) {
+        Queue& victim {m_queues[(index + i) % nQueues]};
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.chunks.empty()) {
+            chunk = victim.chunks.back();
+            victim.chunks.pop_back();
+            return true;
+        }
+    }
+    // No chunk is ever added during a job, all of them were taken
+    return false;
+}
+
+void EventDriver::runChunks(const std::size_t index, Job& job) {
+    const std::vector<Event>& events {*job.events};
+    const std::vector<const IInputBase*>& inputs {*job.inputs};
+    const std::size_t nInputs {inputs.size()};
+
+    Chunk chunk;
+    while (takeChunk(index, chunk)) {
+        try {
+            for (std::size_t e = chunk.begin; e < chunk.end; ++e) {
+                const Event& event {events[e]};
+                double* values {job.values + job.jetOffsets[e]*nInputs};
+                for (std::size_t j = 0; j < event.nJets; ++j) {
+                    for (std::size_t i = 0; i < nInputs; ++i) {
+                        if (!inputs[i]->getValue(event.jets[j], *event.context, values[j*nInputs + i])) {
+                            values[j*nInputs + i] = 0;
+                            job.failed.store(true, std::memory_order_relaxed);
+                        }
+                    }
+                }
+            }
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(job.exceptionMutex);
+            if (!job.exception)
+                job.exception = std::current_exception();
+            job.failed.store(true, std::memory_order_relaxed);
+        }
+    }
+}
+
+bool EventDriver::evaluate(const std::vector<Event>& events, const std::vector<const IInputBase*>& inputs, std::vector<double>& values) {
+    std::lock_guard<std::mutex> runLock(m_runMutex);
+
+    std::vector<std::size_t> jetOffsets(events.size() + 1, 0);
+    for (std::size_t e = 0; e < events.size(); ++e)
+        jetOffsets[e+1] = jetOffsets[e] + events[e].nJets;
+    const std::size_t nJets {jetOffsets.back()};
+    values.assign(nJets * inputs.size(), 0.);
+    if (events.empty() || inputs.empty())
+        return true;
+
+    // Chunks of about the same number of jets, an event with no jet still costs a little
+    const std::size_t nThreads {getNumThreads()};
+    const std::size_t nChunks {nThreads * CHUNKSPERTHREAD};
+    const std::size_t chunkCost {std::max<std::size_t>(1, (nJets + events.size()) / nChunks)};
+    std::vector<Chunk> chunks;
+    for (std::size_t begin = 0, cost = 0, e = 0; e < events.size(); ++e) {
+        cost += events[e].nJets + 1;
+        if (cost >= chunkCost || e + 1 == events.size()) {
+            chunks.push_back(Chunk{begin, e + 1});
+            begin = e + 1;
+            cost = 0;
+        }
+    }
+    // Contiguous shares, so that each thread walks through its events in order
+    for (std::size_t c = 0; c < chunks.size(); ++c) {
+        Queue& queue {m_queues[c * nThreads / chunks.size()]};
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.chunks.push_back(chunks[c]);
+    }
+
+    Job job;
+    job.events = &events;
+    job.inputs = &inputs;
+    job.jetOffsets = jetOffsets.data();
+    job.values = values.data();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_job = &job;
+        m_nBusy = m_workers.size();
+        ++m_generation;
+    }
+    m_start.notify_all();
+
+    // The calling thread works too
+    runChunks(nThreads - 1, job);
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_done.wait(lock, [&] { return m_nBusy == 0; });
+        m_job = nullptr;
+    }
+
+    if (job.exception)
+        std::rethrow_exception(job.exception);
+    return !job.failed.load();
+}
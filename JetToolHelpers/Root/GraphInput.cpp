@@ -0,0 +1,89 @@
+/**
+ * @file GraphInput.cpp
+ * @author S. Schramm, A. Freeman
+ * @brief Contains the implementation of GraphInput.h
+ */
+
+#include <iostream>
+
+#include "JetToolHelpers/GraphInput.h"
+
+GraphInput::GraphInput(
+            const std::string& name,
+            const std::string& fileName,
+            const std::string& graphName,
+            const std::string& varName,
+            const std::string& varType,
+            const bool isJetVar,
+            const GraphInterpolation interpolation
+): IInputBase(name),
+      m_fileName{fileName}, m_graphName{graphName},
+      m_interpolation{interpolation},
+      m_varName{varName}, m_varType{varType},
+      m_isJetVar{isJetVar}, m_inVar{nullptr}
+{}
+
+bool GraphInput::initialize() {
+    if (m_inVar != nullptr) {
+        std::cout << "The input variable was already configured" << std::endl;
+        return false;
+    }
+    m_inVar = InputVariable::createVariable(m_varName, m_varType, m_isJetVar);
+    if (!m_inVar) {
+        std::cout << "Failed to create an input variable" << std::endl;
+        return false;
+    }
+
+    if (m_table) {
+        std::cout << "The curve already exists" << std::endl;
+        return false;
+    }
+    LoadedGraph graph;
+    if (!HistoLoader::loadGraph(m_fileName, m_graphName, graph)) {
+        std::cout << "Failed while reading curve from file" << std::endl;
+        return false;
+    }
+    m_table = GraphTable::create(graph, m_interpolation);
+    if (!m_table) {
+        std::cout << "Failed to compile the curve " << m_graphName << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool GraphInput::finalize() {
+    m_table.reset();
+    return true;
+}
+
+bool GraphInput::getValue(const xAOD::Jet& jet, const JetContext& event, double& value) const {
+    if (!m_table) {
+        std::cout << "The curve " << m_graphName << " must be initialized before being evaluated" << std::endl;
+        return false;
+    }
+    const float varValue {m_inVar->getValue(jet, event)};
+    value = m_table->evaluate(varValue);
+    return true;
+}
+
+template <typename T>
+bool GraphInput::evaluateBatch(const T* x, double* values, std::size_t nValues, std::size_t stride) const {
+    if (!m_table) {
+        std::cout << "The curve " << m_graphName << " must be initialized before evaluating a batch" << std::endl;
+        return false;
+    }
+    // Inputs go through float like in getValue(), consecutive entries close to each other share the search
+    const GraphTable& table {*m_table};
+    int interval {-1};
+    for (std::size_t i = 0; i < nValues; ++i)
+        values[i] = table.evaluate(static_cast<float>(x[i*stride]), interval);
+    return true;
+}
+
+bool GraphInput::getValues(const double* x, double* values, std::size_t nValues, std::size_t stride) const {
+    return evaluateBatch<double>(x, values, nValues, stride);
+}
+
+bool GraphInput::getValues(const float* x, double* values, std::size_t nValues, std::size_t stride) const {
+    return evaluateBatch<float>(x, values, nValues, stride);
+}
@@ -0,0 +1,117 @@
+/**
+ * @file GraphTable.cpp
+ * @author S. Schramm, A. Freeman
+ * @brief Contains the compilation of the curves of GraphTable.h
+ */
+
+#include <cmath>
+#include <iostream>
+#include <numeric>
+
+#include "JetToolHelpers/GraphTable.h"
+
+std::shared_ptr<const GraphTable> GraphTable::create(const LoadedGraph& graph, const GraphInterpolation interpolation) {
+    if (graph.x.empty() || graph.x.size() != graph.y.size()) {
+        std::cout << "Cannot compile a curve of " << graph.x.size() << " x and " << graph.y.size() << " y values" << std::endl;
+        return nullptr;
+    }
+    const bool stored {interpolation == GraphInterpolation::Spline};
+    if (stored && (graph.b.size() != graph.x.size() || graph.c.size() != graph.x.size() || graph.d.size() != graph.x.size())) {
+        std::cout << "Cannot compile a curve without its cubics as a spline" << std::endl;
+        return nullptr;
+    }
+    for (std::size_t i = 0; i < graph.x.size(); ++i) {
+        if (std::isnan(graph.x[i]) || std::isnan(graph.y[i])) {
+            std::cout << "Cannot compile a curve with NaN points" << std::endl;
+            return nullptr;
+        }
+    }
+
+    // Stable : the first of the points sharing an x stays first
+    std::vector<std::size_t> order(graph.x.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](const std::size_t a, const std::size_t b) { return graph.x[a] < graph.x[b]; });
+    std::vector<double> y;
+    std::vector<std::size_t> kept;
+    std::shared_ptr<GraphTable> table {new GraphTable()};
+    for (const std::size_t i : order) {
+        if (table->m_x.empty() || graph.x[i] > table->m_x.back()) {
+            table->m_x.push_back(graph.x[i]);
+            y.push_back(graph.y[i]);
+            kept.push_back(i);
+        }
+    }
+
+    const int nIntervals {static_cast<int>(table->m_x.size()) - 1};
+    table->m_interpolation = interpolation;
+    table->m_nIntervals = nIntervals;
+    table->m_stride = interpolation == GraphInterpolation::Linear ? 2 : 4;
+    if (nIntervals == 0) {
+        table->m_coefficients.assign(table->m_stride, 0.);
+        table->m_coefficients[0] = y[0];
+        return table;
+    }
+
+    // Slopes of the intervals, as TH1::Interpolate computes them
+    const std::vector<double>& x {table->m_x};
+    std::vector<double> slopes(nIntervals);
+    for (int i = 0; i < nIntervals; ++i)
+        slopes[i] = (y[i+1] - y[i]) / (x[i+1] - x[i]);
+
+    if (interpolation == GraphInterpolation::Linear) {
+        for (int i = 0; i < nIntervals; ++i) {
+            table->m_coefficients.push_back(y[i]);
+            table->m_coefficients.push_back(slopes[i]);
+        }
+    } else if (stored) {
+        // Already in powers of x-x[i]
+        for (int i = 0; i < nIntervals; ++i) {
+            table->m_coefficients.push_back(y[i]);
+            table->m_coefficients.push_back(graph.b[kept[i]]);
+            table->m_coefficients.push_back(graph.c[kept[i]]);
+            table->m_coefficients.push_back(graph.d[kept[i]]);
+        }
+    } else {
+        // Fritsch-Carlson : derivatives at the knots, then limited to keep each interval monotone
+        std::vector<double> derivatives(nIntervals + 1);
+        derivatives[0] = slopes[0];
+        derivatives[nIntervals] = slopes[nIntervals-1];
+        for (int i = 1; i < nIntervals; ++i)
+            derivatives[i] = slopes[i-1]*slopes[i] <= 0 ? 0. : 0.5*(slopes[i-1] + slopes[i]);
+        for (int i = 0; i < nIntervals; ++i) {
+            if (slopes[i] == 0) {
+                derivatives[i] = derivatives[i+1] = 0.;
+                continue;
+            }
+            const double alpha {derivatives[i] / slopes[i]};
+            const double beta {derivatives[i+1] / slopes[i]};
+            const double norm {alpha*alpha + beta*beta};
+            if (norm > 9) {
+                const double tau {3 / std::sqrt(norm)};
+                derivatives[i] = tau*alpha*slopes[i];
+                derivatives[i+1] = tau*beta*slopes[i];
+            }
+        }
+        // The Hermite polynomial of each interval in powers of x-x[i]
+        for (int i = 0; i < nIntervals; ++i) {
+            const double h {x[i+1] - x[i]};
+            table->m_coefficients.push_back(y[i]);
+            table->m_coefficients.push_back(derivatives[i]);
+            table->m_coefficients.push_back((3*slopes[i] - 2*derivatives[i] - derivatives[i+1]) / h);
+            table->m_coefficients.push_back((derivatives[i] + derivatives[i+1] - 2*slopes[i]) / (h*h));
+        }
+    }
+
+    // Evenly spaced knots, within rounding, are found without searching
+    const double step {(x.back() - x.front()) / nIntervals};
+    bool uniform {true};
+    for (int i = 0; i <= nIntervals && uniform; ++i)
+        uniform = std::abs(x[i] - (x.front() + i*step)) <= 1e-9*step;
+    table->m_uniform = uniform;
+    table->m_inverseStep = 1 / step;
+    return table;
+}
+
+std::size_t GraphTable::getNumBytes() const {
+    return sizeof(GraphTable) + m_x.capacity()*sizeof(double) + m_coefficients.capacity()*sizeof(double);
+}
@@ -0,0 +1,134 @@
+/**
+ * @file HistoBundle.cpp
+ * @author S. Schramm, A. Freeman
+ * @brief Contains the packing of HistoBundle.h
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <new>
+
+#include <sys/mman.h>
+
+#include "JetToolHelpers/HistoBundle.h"
+#include "JetToolHelpers/NumaTopology.h"
+
+namespace {
+    std::size_t alignUp(const std::size_t size, const std::size_t alignment) {
+        return (size + alignment - 1) / alignment * alignment;
+    }
+
+    std::size_t tableSize(const HistoTable& table) {
+        return alignUp(sizeof(HistoTable), HistoBundle::CACHELINE) + table.getRelocatedSize(HistoBundle::CACHELINE);
+    }
+
+    void* mapAnonymous(const std::size_t size, const int flags) {
+        void* block {mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | flags, -1, 0)};
+        return block == MAP_FAILED ? nullptr : block;
+    }
+}
+
+HistoBundle::~HistoBundle() {
+    for (const Replica& replica : m_replicas)
+        munmap(replica.block, replica.mapped);
+}
+
+void* HistoBundle::allocate(std::size_t& mapped) {
+    if (m_pages == HistoPages::Explicit) {
+#ifdef MAP_HUGETLB
+        mapped = alignUp(m_size, HUGEPAGESIZE);
+        if (void* block = mapAnonymous(mapped, MAP_HUGETLB))
+            return block;
+#endif
+        std::cout << "No huge pages reserved for the bundle, asking for transparent huge pages" << std::endl;
+        m_pages = HistoPages::Transparent;
+    }
+
+    if (m_pages == HistoPages::Transparent) {
+        // Over-allocated to cut a block aligned on a huge page, which the kernel can back with them
+        mapped = alignUp(m_size, HUGEPAGESIZE);
+        char* over {static_cast<char*>(mapAnonymous(mapped + HUGEPAGESIZE, 0))};
+        if (!over)
+            return nullptr;
+        char* block {reinterpret_cast<char*>(alignUp(reinterpret_cast<std::uintptr_t>(over), HUGEPAGESIZE))};
+        if (block > over)
+            munmap(over, block - over);
+        munmap(block + mapped, over + HUGEPAGESIZE - block);
+#ifdef MADV_HUGEPAGE
+        if (madvise(block, mapped, MADV_HUGEPAGE) == 0)
+            return block;
+#endif
+        std::cout << "Transparent huge pages aren't available for the bundle, using normal pages" << std::endl;
+        m_pages = HistoPages::Normal;
+        return block;
+    }
+
+    mapped = m_size;
+    return mapAnonymous(mapped, 0);
+}
+
+std::shared_ptr<HistoBundle> HistoBundle::create(const std::vector<HistoInput*>& inputs, const HistoBundleOptions& options) {
+    std::vector<std::shared_ptr<const HistoTable>> tables;
+    std::size_t size {0};
+    for (const HistoInput* input : inputs) {
+        std::shared_ptr<const HistoTable> table {input ? input->getTable() : nullptr};
+        if (!table) {
+            std::cout << "All inputs must be initialized before being bundled" << std::endl;
+            return nullptr;
+        }
+        size += tableSize(*table);
+        tables.push_back(std::move(table));
+    }
+    size = alignUp(std::max(size, PAGESIZE), PAGESIZE);
+
+    std::shared_ptr<HistoBundle> bundle {new HistoBundle(size, tables.size())};
+    bundle->m_pages = options.pages;
+    const int nNodes {NumaTopology::getNumNodes()};
+    const int nReplicas {options.nReplicas > 0 ? options.nReplicas : nNodes};
+    for (int i = 0; i < nReplicas; ++i) {
+        Replica replica {nullptr, 0, i % nNodes, {}};
+        // Allocated and first written from the node : its pages are placed there
+        auto fill = [&]() {
+            replica.block = bundle->allocate(replica.mapped);
+            if (!replica.block)
+                return;
+            char* cursor {static_cast<char*>(replica.block)};
+            for (const std::shared_ptr<const HistoTable>& table : tables) {
+                // Metadata first, then the values in the order a lookup reads them
+                HistoTable* copy {reinterpret_cast<HistoTable*>(cursor)};
+                cursor += alignUp(sizeof(HistoTable), CACHELINE);
+                new (copy) HistoTable(table->relocate(cursor, CACHELINE));
+                replica.tables.push_back(copy);
+            }
+            // The unused end of the last page is zero, as mapped
+        };
+        if (nNodes > 1)
+            NumaTopology::runOnNode(replica.node, fill);
+        else
+            fill();
+        if (!replica.block) {
+            std::cout << "Failed to allocate " << size << " bytes for the bundle" << std::endl;
+            return nullptr;
+        }
+        bundle->m_replicas.push_back(std::move(replica));
+    }
+
+    // The inputs share the ownership of the blocks with the returned bundle
+    std::vector<std::vector<std::shared_ptr<const HistoTable>>> replicas(inputs.size());
+    for (std::size_t i = 0; i < inputs.size(); ++i) {
+        for (const Replica& replica : bundle->m_replicas)
+            replicas[i].emplace_back(bundle, replica.tables[i]);
+        // All checked before any input switches : none is left in a partial bundle
+        if (!inputs[i]->acceptsTables(replicas[i]))
+            return nullptr;
+    }
+    for (std::size_t i = 0; i < inputs.size(); ++i) {
+        if (!inputs[i]->setTables(std::move(replicas[i]))) {
+            std::cout << "An input was reloaded with another binning while being bundled, "
+                << i << " inputs switched to the bundle" << std::endl;
+            return nullptr;
+        }
+    }
+    return bundle;
+}
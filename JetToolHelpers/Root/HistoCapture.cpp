@@ -0,0 +1,155 @@
+/**
+ * @file HistoCapture.cpp
+ * @author S. Schramm, A. Freeman
+ * @brief Contains the writing and reading of the captures of HistoCapture.h
+ */
+
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#include "JetToolHelpers/HistoCapture.h"
+
+namespace {
+    constexpr char MAGIC[8] {'J', 'T', 'H', 'C', 'A', 'P', 'T', 'R'};
+    constexpr std::uint32_t VERSION {1};
+    constexpr std::uint32_t BYTEORDER {0x01020304};
+    // Far above any block or name, guards against allocating for a corrupted count
+    constexpr std::uint32_t MAXCOUNT {std::uint32_t(1) << 28};
+
+    std::atomic<std::uint64_t> nextId {1};
+
+    template <typename T> bool put(std::FILE* file, const T& value) {
+        return std::fwrite(&value, sizeof(T), 1, file) == 1;
+    }
+
+    bool putName(std::FILE* file, const std::string& name) {
+        return put(file, static_cast<std::uint32_t>(name.size()))
+            && std::fwrite(name.data(), 1, name.size(), file) == name.size();
+    }
+
+    template <typename T> bool get(std::istream& in, T& value) {
+        return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(T)));
+    }
+
+    bool getName(std::istream& in, std::string& name) {
+        std::uint32_t length;
+        if (!get(in, length) || length > MAXCOUNT)
+            return false;
+        name.resize(length);
+        return static_cast<bool>(in.read(&name[0], length));
+    }
+}
+
+HistoCapture::HistoCapture(std::FILE* file) : m_id{nextId++}, m_file{file} {}
+
+std::shared_ptr<HistoCapture> HistoCapture::create(const std::string& fileName) {
+    std::FILE* file {std::fopen(fileName.c_str(), "wb")};
+    if (!file || std::fwrite(MAGIC, 1, sizeof(MAGIC), file) != sizeof(MAGIC)
+        || !put(file, VERSION) || !put(file, BYTEORDER)) {
+        std::cout << "Failed to open the capture file to write: " << fileName << std::endl;
+        if (file)
+            std::fclose(file);
+        return nullptr;
+    }
+    return std::shared_ptr<HistoCapture>(new HistoCapture(file));
+}
+
+std::uint32_t HistoCapture::addStream(const std::string& name, const std::string& fileName,
+    const std::string& histName, const int nDims) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_file && !(put(m_file, STREAM) && put(m_file, static_cast<std::uint32_t>(nDims))
+        && putName(m_file, name) && putName(m_file, fileName) && putName(m_file, histName)))
+        m_failed = true;
+    return m_nStreams++;
+}
+
+HistoCapture::ThreadBuffers* HistoCapture::addThread() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_threads.push_back(std::make_unique<ThreadBuffers>());
+    return m_threads.back().get();
+}
+
+void HistoCapture::flush(const std::uint32_t stream, std::vector<float>& values) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    writeBlock(stream, values);
+}
+
+void HistoCapture::writeBlock(const std::uint32_t stream, std::vector<float>& values) {
+    if (m_file && !(put(m_file, BLOCK) && put(m_file, stream) && put(m_file, static_cast<std::uint32_t>(values.size()))
+        && std::fwrite(values.data(), sizeof(float), values.size(), m_file) == values.size()))
+        m_failed = true;
+    values.clear();
+}
+
+bool HistoCapture::close() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_file)
+        return !m_failed;
+    for (const std::unique_ptr<ThreadBuffers>& buffers : m_threads)
+        for (std::uint32_t stream = 0; stream < buffers->size(); ++stream)
+            if (!(*buffers)[stream].empty())
+                writeBlock(stream, (*buffers)[stream]);
+    if (std::fclose(m_file) != 0)
+        m_failed = true;
+    m_file = nullptr;
+    if (m_failed)
+        std::cout << "Failed to write the capture, it is incomplete" << std::endl;
+    return !m_failed;
+}
+
+bool HistoCapture::read(const std::string& fileName, std::vector<CapturedStream>& streams) {
+    streams.clear();
+    std::ifstream in(fileName, std::ios::binary);
+    if (!in) {
+        std::cout << "Failed to open the file to read: " << fileName << std::endl;
+        return false;
+    }
+    char magic[sizeof(MAGIC)];
+    std::uint32_t version, byteOrder;
+    if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0
+        || !get(in, version) || !get(in, byteOrder)) {
+        std::cout << "The file " << fileName << " isn't a capture file" << std::endl;
+        return false;
+    }
+    if (version != VERSION || byteOrder != BYTEORDER) {
+        std::cout << "The capture " << fileName << " has version " << version << " or another byte order" << std::endl;
+        return false;
+    }
+
+    std::uint32_t kind;
+    std::vector<float> values;
+    while (get(in, kind)) {
+        bool valid {false};
+        if (kind == STREAM) {
+            CapturedStream stream;
+            std::uint32_t nDims;
+            valid = get(in, nDims) && (nDims == 1 || nDims == 2) && getName(in, stream.name)
+                && getName(in, stream.fileName) && getName(in, stream.histName);
+            stream.nDims = nDims;
+            streams.push_back(std::move(stream));
+        } else if (kind == BLOCK) {
+            std::uint32_t index, count;
+            valid = get(in, index) && index < streams.size() && get(in, count) && count <= MAXCOUNT
+                && count % streams[index].nDims == 0;
+            if (valid) {
+                values.resize(count);
+                valid = static_cast<bool>(in.read(reinterpret_cast<char*>(values.data()), count * sizeof(float)));
+            }
+            if (valid) {
+                CapturedStream& stream {streams[index]};
+                for (std::uint32_t i = 0; i < count; i += stream.nDims) {
+                    stream.x.push_back(values[i]);
+                    if (stream.nDims > 1)
+                        stream.y.push_back(values[i+1]);
+                }
+            }
+        }
+        if (!valid) {
+            std::cout << "The capture " << fileName << " is truncated or corrupted" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
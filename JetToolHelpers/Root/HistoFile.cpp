@@ -0,0 +1,167 @@
+/**
+ * @file HistoFile.cpp
+ * @author S. Schramm, A. Freeman
+ * @brief Contains the reading and writing of the native histogram files of HistoFile.h
+ */
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#include "JetToolHelpers/HistoFile.h"
+
+namespace {
+    constexpr char MAGIC[8] {'J', 'T', 'H', 'T', 'A', 'B', 'L', 'E'};
+    constexpr std::uint32_t VERSION {1};
+    constexpr std::uint32_t BYTEORDER {0x01020304};
+    // Far above any calibration, guards against allocating for a corrupted count
+    constexpr std::uint64_t MAXCOUNT {std::uint64_t(1) << 28};
+
+    template <typename T> void put(std::ostream& out, const T& value) {
+        out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    void putDoubles(std::ostream& out, const std::vector<double>& values) {
+        out.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(double));
+    }
+
+    template <typename T> bool get(std::istream& in, T& value) {
+        return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(T)));
+    }
+
+    template <typename Count> bool getDoubles(std::istream& in, std::vector<double>& values) {
+        Count count;
+        if (!get(in, count) || count > MAXCOUNT)
+            return false;
+        values.resize(count);
+        return static_cast<bool>(in.read(reinterpret_cast<char*>(values.data()), count * sizeof(double)));
+    }
+
+    // Opens fileName and checks its header, leaves in on the first histogram
+    bool openFile(std::ifstream& in, const std::string& fileName, std::uint32_t& nHistos) {
+        in.open(fileName, std::ios::binary);
+        if (!in) {
+            std::cout << "Failed to open the file to read: " << fileName << std::endl;
+            return false;
+        }
+        char magic[sizeof(MAGIC)];
+        std::uint32_t version, byteOrder;
+        if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0
+            || !get(in, version) || !get(in, byteOrder) || !get(in, nHistos)) {
+            std::cout << "The file " << fileName << " isn't a histogram file" << std::endl;
+            return false;
+        }
+        if (version != VERSION) {
+            std::cout << "The file " << fileName << " has version " << version << ", expected " << VERSION << std::endl;
+            return false;
+        }
+        if (byteOrder != BYTEORDER) {
+            std::cout << "The file " << fileName << " was written on a machine of different byte order" << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    bool readName(std::istream& in, std::string& name) {
+        std::uint32_t length;
+        if (!get(in, length) || length > MAXCOUNT)
+            return false;
+        name.resize(length);
+        return static_cast<bool>(in.read(&name[0], length));
+    }
+
+    bool readHisto(std::istream& in, LoadedHisto& histo) {
+        if (!get(in, histo.nDims) || histo.nDims < 1 || histo.nDims > 2)
+            return false;
+        histo.binnings.resize(histo.nDims);
+        for (HistoAxisBinning& binning : histo.binnings)
+            if (!get(in, binning.nBins) || !get(in, binning.xMin) || !get(in, binning.xMax)
+                || !getDoubles<std::uint32_t>(in, binning.edges))
+                return false;
+        return getDoubles<std::uint64_t>(in, histo.contents);
+    }
+}
+
+bool HistoFile::write(const std::string& fileName, const std::map<std::string, LoadedHisto>& histos) {
+    for (const auto& entry : histos) {
+        const LoadedHisto& histo {entry.second};
+        std::size_t nValues {1};
+        bool consistent {(histo.nDims == 1 || histo.nDims == 2) && static_cast<int>(histo.binnings.size()) == histo.nDims};
+        for (const HistoAxisBinning& binning : histo.binnings) {
+            consistent = consistent && binning.nBins > 0
+                && (binning.edges.empty() || binning.edges.size() == static_cast<std::size_t>(binning.nBins) + 1);
+            nValues *= binning.nBins > 0 ? binning.nBins : 0;
+        }
+        if (!consistent || histo.contents.size() != nValues) {
+            std::cout << "Inconsistent histogram " << entry.first << " provided to write " << fileName << std::endl;
+            return false;
+        }
+    }
+
+    std::ofstream out(fileName, std::ios::binary | std::ios::trunc);
+    out.write(MAGIC, sizeof(MAGIC));
+    put(out, VERSION);
+    put(out, BYTEORDER);
+    put(out, static_cast<std::uint32_t>(histos.size()));
+    for (const auto& entry : histos) {
+        const LoadedHisto& histo {entry.second};
+        put(out, static_cast<std::uint32_t>(entry.first.size()));
+        out.write(entry.first.data(), entry.first.size());
+        put(out, static_cast<std::int32_t>(histo.nDims));
+        for (const HistoAxisBinning& binning : histo.binnings) {
+            put(out, static_cast<std::int32_t>(binning.nBins));
+            put(out, binning.xMin);
+            put(out, binning.xMax);
+            put(out, static_cast<std::uint32_t>(binning.edges.size()));
+            putDoubles(out, binning.edges);
+        }
+        put(out, static_cast<std::uint64_t>(histo.contents.size()));
+        putDoubles(out, histo.contents);
+    }
+    out.close();
+    if (!out) {
+        std::cout << "Failed to write the file: " << fileName << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool HistoFile::read(const std::string& fileName, const std::string& histName, LoadedHisto& histo) {
+    std::ifstream in;
+    std::uint32_t nHistos;
+    if (!openFile(in, fileName, nHistos))
+        return false;
+
+    // The histograms are read one after the other, they are few and small
+    std::string name;
+    for (std::uint32_t i = 0; i < nHistos; ++i) {
+        if (!readName(in, name) || !readHisto(in, histo)) {
+            std::cout << "The file " << fileName << " is truncated or corrupted" << std::endl;
+            return false;
+        }
+        if (name == histName)
+            return true;
+    }
+    std::cout << "Failed to retreive the requested histogram \"" << histName << "\" from the file: " << fileName << std::endl;
+    return false;
+}
+
+std::vector<std::string> HistoFile::getHistNames(const std::string& fileName) {
+    std::ifstream in;
+    std::uint32_t nHistos;
+    std::vector<std::string> names;
+    if (!openFile(in, fileName, nHistos))
+        return names;
+
+    LoadedHisto histo;
+    std::string name;
+    for (std::uint32_t i = 0; i < nHistos; ++i) {
+        if (!readName(in, name) || !readHisto(in, histo)) {
+            std::cout << "The file " << fileName << " is truncated or corrupted" << std::endl;
+            return {};
+        }
+        names.push_back(name);
+    }
+    return names;
+}
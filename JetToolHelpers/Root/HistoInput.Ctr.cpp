@@ -10,6 +10,7 @@
  */
 
 #include "JetToolHelpers/HistoInput.h"
+#include "JetToolHelpers/HistoMemoryManager.h"
 
 HistoInput::HistoInput(
             const std::string& name, 
@@ -18,7 +19,7 @@ HistoInput::HistoInput(
             const std::string& varName, 
             const std::string& varType, 
             const bool isJetVar
-): IInputBase(name), 
+): IInputBase(name), name{name},
       nDims{1},
       m_fileName{fileName}, m_histName{histName}, 
       m_varName1{varName}, m_varType1{varType}, 
@@ -36,7 +37,7 @@ HistoInput::HistoInput(
             const std::string& histName,
             const std::string& varName1, const std::string& varType1, const bool isJetVar1,
             const std::string& varName2, const std::string& varType2, const bool isJetVar2
-): IInputBase(name), 
+): IInputBase(name), name{name},
       nDims{2},
       m_fileName{fileName}, m_histName{histName}, 
       m_varName1{varName1}, m_varType1{varType1}, 
@@ -47,3 +48,12 @@ HistoInput::HistoInput(
     if(varName2 == "")
         throw std::runtime_error("varName2 cannot be emptystring");
 }
+
+HistoInput::~HistoInput() {
+    if (m_managed) {
+        HistoMemoryManager::instance().remove(this);
+        HistoMemoryManager::instance().account(m_bytes.load(), 0);
+    }
+    // Nobody can be evaluating anymore
+    delete m_compiled.load();
+}
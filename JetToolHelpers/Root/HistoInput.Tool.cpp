@@ -1,6 +1,46 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
 #include <iostream>
+#include <limits>
+#include <random>
+#include <vector>
 
 #include "JetToolHelpers/HistoInput.h"
+#include "JetToolHelpers/EpochReclaimer.h"
+#include "JetToolHelpers/HistoMemoryManager.h"
+
+namespace {
+    // Buffers of the coherent batches, reused by the following batches of the thread
+    struct CoherentEntry {
+        float x;
+        float y;
+        std::uint32_t index;
+    };
+    struct CoherentScratch {
+        std::vector<std::uint32_t> buckets;
+        std::vector<CoherentEntry> entries;
+    };
+    thread_local CoherentScratch t_scratch;
+
+    // Kernels evaluating the interpolation of the contents as they are
+    bool isExact(const HistoKernel kernel) {
+        return kernel == HistoKernel::Table || kernel == HistoKernel::CompressedTable;
+    }
+
+    // The bin edges and centers of an axis, where the interpolation changes segment
+    std::vector<float> getKnots(const HistoAxisBinning& binning) {
+        std::vector<float> knots;
+        for (int i = 0; i <= 2*binning.nBins; ++i) {
+            if (binning.edges.empty())
+                knots.push_back(binning.xMin + (binning.xMax - binning.xMin) * i / (2*binning.nBins));
+            else
+                knots.push_back(i % 2 == 0 ? binning.edges[i/2] : 0.5*(binning.edges[i/2] + binning.edges[i/2 + 1]));
+        }
+        return knots;
+    }
+}
 
 bool HistoInput::initialize()
 {
@@ -21,53 +61,621 @@ bool HistoInput::initialize()
     }
     // Now deal with the histogram
     // Make sure we haven't already retrieved the histogram
-    if (m_hist != nullptr) {
+    if (m_compiled.load() != nullptr) {
         std::cout << "The histogram already exists" << std::endl;
         return false;
     }
 
-    if (!HistoInput::readHistoFromFile(m_hist, m_fileName, m_histName)) {
+    LoadedHisto histo;
+    if (!HistoLoader::load(m_fileName, m_histName, histo)) {
         std::cout << "Failed while reading histogram from file" << std::endl;
         return false;
     }
 
-    if (!m_hist) {
-        std::cout << "Histogram pointer is empty after reading from file" << std::endl;
+    if (histo.nDims != nDims) {
+        std::cout << "Read the specified histogram, but it has a dimension of " 
+        << histo.nDims << " instead of the expected " << nDims << std::endl;
         return false;
     }
 
-    if (m_hist->GetDimension() != nDims) {
-        std::cout << "Read the specified histogram, but it has a dimension of " 
-        << m_hist->GetDimension() << " instead of the expected 1" << std::endl;
+    std::unique_ptr<Compiled> compiled {compile(histo)};
+    if (!compiled)
         return false;
+    if (!m_managed) {
+        HistoMemoryManager::instance().add(this);
+        m_managed = true;
     }
+    {
+        std::lock_guard<std::mutex> lock(m_reloadMutex);
+        publish(std::move(compiled));
+        updateMemoryUsage();
+    }
+    HistoMemoryManager::instance().enforceBudget(this);
 
     // TODO
     // We have both, set the dynamic range of the input variable according to histogram range
     // Low edge of first bin (index 1, as index 0 is underflow)
     // High edge of last bin (index N, as index N+1 is overflow)
-    //m_inVar.SetDynamicRange(m_hist->GetXaxis()->GetBinLowEdge(1),m_hist->GetXaxis()->GetBinUpEdge(m_hist->GetNbinsX()));   
+    //m_inVar.SetDynamicRange(histo.binnings[0].xMin, histo.binnings[0].xMax);   
     return true;
 }
 
 bool HistoInput::finalize() {
-    if (m_hist)
-        m_hist.reset();
+    std::lock_guard<std::mutex> lock(m_reloadMutex);
+    publish(nullptr);
+    m_evicted = false;
+    updateMemoryUsage();
+    return true;
+}
+
+std::unique_ptr<HistoInput::Compiled> HistoInput::compile(const LoadedHisto& histo) const {
+    if (m_tune) {
+        std::unique_ptr<Compiled> compiled {tune(histo)};
+        if (compiled && m_invert && !invert(histo, *compiled))
+            return nullptr;
+        return compiled;
+    }
+
+    auto compiled {std::make_unique<Compiled>()};
+    compiled->table = HistoTable::create(histo.binnings, histo.contents, m_compression);
+    if (!compiled->table) {
+        std::cout << "Failed to compile the histogram " << m_histName << std::endl;
+        return nullptr;
+    }
+
+    compiled->surrogateError = -1;
+    if (m_surrogateMaxError > 0) {
+        compiled->surrogate = ChebyshevSurrogate::fit(*compiled->table, m_surrogateMaxError, m_surrogateMaxDegree, compiled->surrogateError);
+        if (compiled->surrogate)
+            std::cout << "Evaluating " << m_histName << " from a surrogate of degree " << compiled->surrogate->getDegree(0)
+            << ", largest error " << compiled->surrogateError << std::endl;
+        else
+            std::cout << "No surrogate of " << m_histName << " within " << m_surrogateMaxError
+            << " (best " << compiled->surrogateError << "), evaluating the table" << std::endl;
+    }
+    if (compiled->surrogate)
+        compiled->kernel = HistoKernel::Surrogate;
+    else if (m_compression.enabled)
+        compiled->kernel = m_compression.quantizationTolerance > 0 ? HistoKernel::QuantizedTable : HistoKernel::CompressedTable;
+    if (m_invert && !invert(histo, *compiled))
+        return nullptr;
+    return compiled;
+}
+
+bool HistoInput::invert(const LoadedHisto& histo, Compiled& compiled) const {
+    if (histo.nDims != 1) {
+        std::cout << "Cannot invert the " << histo.nDims << "D histogram " << m_histName << ", only 1D histograms are" << std::endl;
+        return false;
+    }
+    // The inverse is that of the interpolated contents, getValue() must evaluate them
+    if (!isExact(compiled.kernel)) {
+        std::cout << "Cannot invert the histogram " << m_histName << " evaluated by the lossy "
+        << toString(compiled.kernel) << " kernel" << std::endl;
+        return false;
+    }
+    // The interpolation is linear between the bin centers and constant beyond the first and
+    // last ones : one to one over them if the contents are strictly monotone
+    const std::vector<double>& contents {histo.contents};
+    if (contents.size() < 2) {
+        std::cout << "Cannot invert the histogram " << m_histName << " of a single bin" << std::endl;
+        return false;
+    }
+    const bool increasing {contents.back() > contents.front()};
+    for (std::size_t bin = 1; bin < contents.size(); ++bin) {
+        if (increasing ? !(contents[bin] > contents[bin-1]) : !(contents[bin] < contents[bin-1])) {
+            std::cout << "Cannot invert the histogram " << m_histName << ", it isn't strictly monotone between bins "
+            << bin << " and " << bin + 1 << " (" << contents[bin-1] << ", " << contents[bin] << ")" << std::endl;
+            return false;
+        }
+    }
+
+    LoadedGraph graph;
+    graph.x = contents;
+    for (int bin = 1; bin <= compiled.table->axes[0].nBins; ++bin)
+        graph.y.push_back(compiled.table->axes[0].getBinCenter(bin));
+    compiled.inverse = GraphTable::create(graph);
+    return compiled.inverse != nullptr;
+}
+
+std::unique_ptr<HistoInput::Compiled> HistoInput::build(const LoadedHisto& histo, const HistoKernel kernel,
+    const double maxError, const int maxDegree) const {
+    auto compiled {std::make_unique<Compiled>()};
+    compiled->kernel = kernel;
+    compiled->surrogateError = -1;
+    HistoCompression compression;
+    compression.enabled = kernel == HistoKernel::CompressedTable || kernel == HistoKernel::QuantizedTable;
+    compression.quantizationTolerance = kernel == HistoKernel::QuantizedTable ? maxError : 0.;
+    compiled->table = HistoTable::create(histo.binnings, histo.contents, compression);
+    if (!compiled->table)
+        return nullptr;
+    if (kernel == HistoKernel::Surrogate) {
+        compiled->surrogate = ChebyshevSurrogate::fit(*compiled->table, maxError, maxDegree, compiled->surrogateError);
+        if (!compiled->surrogate)
+            return nullptr;
+    }
+    return compiled;
+}
+
+std::unique_ptr<HistoInput::Compiled> HistoInput::tune(const LoadedHisto& histo) const {
+    const std::string key {m_tuning.cacheFile.empty() ? "" : HistoTuningCache::getKey(m_histName, histo, m_tuning.maxError)};
+    HistoKernel cached;
+    // A lossy kernel cached by a job not inverting the histogram is tuned again
+    if (!key.empty() && HistoTuningCache::lookup(m_tuning.cacheFile, key, cached) && (!m_invert || isExact(cached))) {
+        if (std::unique_ptr<Compiled> compiled = build(histo, cached, m_tuning.maxError, m_surrogateMaxDegree)) {
+            std::cout << "Evaluating " << m_histName << " with the " << toString(cached) << " kernel of the tuning cache" << std::endl;
+            return compiled;
+        }
+    }
+
+    // Points over the whole axes, going through float like in getValue()
+    const std::size_t nSamples {std::max<std::size_t>(m_tuning.nSamples, 1)};
+    std::mt19937 gen(43294);
+    std::vector<float> samples[2] {std::vector<float>(nSamples, 0.f), std::vector<float>(nSamples, 0.f)};
+    for (int axis = 0; axis < histo.nDims; ++axis) {
+        std::uniform_real_distribution<double> dist(histo.binnings[axis].xMin, histo.binnings[axis].xMax);
+        for (float& sample : samples[axis])
+            sample = dist(gen);
+    }
+    // The errors are also checked on the grid of knots, untimed
+    std::vector<float> knots[2];
+    {
+        const std::vector<float> xKnots {getKnots(histo.binnings[0])};
+        const std::vector<float> yKnots {histo.nDims > 1 ? getKnots(histo.binnings[1]) : std::vector<float>{0.f}};
+        for (const float y : yKnots) {
+            for (const float x : xKnots) {
+                knots[0].push_back(x);
+                knots[1].push_back(y);
+            }
+        }
+    }
+
+    // The first candidate, the table, is exact and the reference of the others
+    std::unique_ptr<Compiled> best;
+    double bestTime {std::numeric_limits<double>::infinity()};
+    std::vector<double> reference, values(nSamples);
+    std::vector<double> knotReference, knotValues(knots[0].size());
+    for (const HistoKernel kernel : {HistoKernel::Table, HistoKernel::CompressedTable, HistoKernel::QuantizedTable, HistoKernel::Surrogate}) {
+        const bool exact {isExact(kernel)};
+        if (!exact && (m_tuning.maxError <= 0 || m_invert))
+            continue;
+        std::unique_ptr<Compiled> candidate {build(histo, kernel, m_tuning.maxError, m_surrogateMaxDegree)};
+        if (!candidate)
+            continue;
+
+        double time {std::numeric_limits<double>::infinity()};
+        for (int repetition = 0; repetition < std::max(m_tuning.nRepetitions, 1); ++repetition) {
+            const auto start {std::chrono::steady_clock::now()};
+            HistoCell cell;
+            for (std::size_t i = 0; i < nSamples; ++i)
+                values[i] = evaluate(*candidate, *candidate->table, samples[0][i], samples[1][i], cell);
+            time = std::min(time, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+        }
+
+        HistoCell cell;
+        for (std::size_t i = 0; i < knotValues.size(); ++i)
+            knotValues[i] = evaluate(*candidate, *candidate->table, knots[0][i], knots[1][i], cell);
+
+        if (reference.empty()) {
+            reference = values;
+            knotReference = knotValues;
+        }
+        double error {0};
+        for (std::size_t i = 0; i < nSamples; ++i)
+            error = std::max(error, std::abs(values[i] - reference[i]));
+        for (std::size_t i = 0; i < knotValues.size(); ++i)
+            error = std::max(error, std::abs(knotValues[i] - knotReference[i]));
+        if (exact ? error != 0 : error > m_tuning.maxError)
+            continue;
+        if (time < bestTime) {
+            best = std::move(candidate);
+            bestTime = time;
+        }
+    }
+    if (!best) {
+        std::cout << "Failed to compile the histogram " << m_histName << std::endl;
+        return nullptr;
+    }
+
+    std::cout << "Tuned " << m_histName << " : evaluating the " << toString(best->kernel) << " kernel, "
+    << 1e9 * bestTime / nSamples << " ns per lookup" << std::endl;
+    if (!key.empty())
+        HistoTuningCache::record(m_tuning.cacheFile, key, best->kernel);
+    return best;
+}
+
+HistoKernel HistoInput::getKernel() const {
+    EpochReclaimer::Guard guard;
+    const Compiled* compiled {m_compiled.load()};
+    return compiled ? compiled->kernel : HistoKernel::Table;
+}
+
+void HistoInput::publish(std::unique_ptr<Compiled> compiled) const {
+    const Compiled* previous {m_compiled.exchange(compiled.release())};
+    EpochReclaimer::instance().retire(previous);
+}
+
+void HistoInput::updateMemoryUsage() const {
+    std::size_t bytes {0};
+    if (const Compiled* compiled = m_compiled.load()) {
+        bytes += sizeof(Compiled) + sizeof(HistoTable) + compiled->table->getNumBytes();
+        // The first replica is table
+        for (std::size_t i = 1; i < compiled->replicas.size(); ++i)
+            bytes += sizeof(HistoTable) + compiled->replicas[i]->getNumBytes();
+        if (compiled->surrogate)
+            bytes += compiled->surrogate->getNumBytes();
+        if (compiled->inverse)
+            bytes += compiled->inverse->getNumBytes();
+    }
+    const std::size_t previous {m_bytes.exchange(bytes)};
+    if (m_managed)
+        HistoMemoryManager::instance().account(previous, bytes);
+}
+
+std::unique_ptr<HistoInput::Compiled> HistoInput::readAndCompile() const {
+    LoadedHisto histo;
+    if (!HistoLoader::load(m_fileName, m_histName, histo)) {
+        std::cout << "Failed while reloading histogram from file" << std::endl;
+        return nullptr;
+    }
+    if (histo.nDims != nDims) {
+        std::cout << "Reloaded the specified histogram, but it has a dimension of "
+        << histo.nDims << " instead of the expected " << nDims << std::endl;
+        return nullptr;
+    }
+    return compile(histo);
+}
+
+bool HistoInput::reload() {
+    if (!getTable() && !m_evicted.load()) {
+        std::cout << "The histogram " << m_histName << " must be initialized before being reloaded" << std::endl;
+        return false;
+    }
+
+    // Readers keep evaluating the current table meanwhile
+    std::unique_ptr<Compiled> compiled {readAndCompile()};
+    if (!compiled)
+        return false;
+    {
+        std::lock_guard<std::mutex> lock(m_reloadMutex);
+        publish(std::move(compiled));
+        m_evicted = false;
+        updateMemoryUsage();
+    }
+    HistoMemoryManager::instance().enforceBudget(this);
+    return true;
+}
+
+bool HistoInput::evict() const {
+    // Skip inputs being loaded, this also avoids waiting on them with the manager locked
+    std::unique_lock<std::mutex> lock(m_reloadMutex, std::try_to_lock);
+    if (!lock.owns_lock() || !m_compiled.load())
+        return false;
+    publish(nullptr);
+    m_evicted = true;
+    updateMemoryUsage();
+    return true;
+}
+
+const HistoInput::Compiled* HistoInput::restore() const {
+    const Compiled* compiled {nullptr};
+    {
+        // The threads evaluating meanwhile wait for the first one to load
+        std::lock_guard<std::mutex> lock(m_reloadMutex);
+        compiled = m_compiled.load();
+        if (compiled || !m_evicted.load())
+            return compiled;
+
+        std::unique_ptr<Compiled> loaded {readAndCompile()};
+        if (!loaded)
+            return nullptr;
+        compiled = loaded.get();
+        publish(std::move(loaded));
+        m_evicted = false;
+        updateMemoryUsage();
+    }
+    m_used.store(true, std::memory_order_relaxed);
+    // Still valid if evicted again : the caller's guard was entered before it was published
+    HistoMemoryManager::instance().enforceBudget(this);
+    return compiled;
+}
+
+std::future<bool> HistoInput::reloadAsync() {
+    return std::async(std::launch::async, [this]() { return reload(); });
+}
+
+std::shared_ptr<const HistoTable> HistoInput::getTable() const {
+    EpochReclaimer::Guard guard;
+    const Compiled* compiled {m_compiled.load()};
+    return compiled ? compiled->table : nullptr;
+}
+
+std::shared_ptr<const ChebyshevSurrogate> HistoInput::getSurrogate() const {
+    EpochReclaimer::Guard guard;
+    const Compiled* compiled {m_compiled.load()};
+    return compiled ? compiled->surrogate : nullptr;
+}
+
+double HistoInput::getSurrogateError() const {
+    EpochReclaimer::Guard guard;
+    const Compiled* compiled {m_compiled.load()};
+    return compiled ? compiled->surrogateError : -1;
+}
+
+bool HistoInput::setTable(std::shared_ptr<const HistoTable> table) {
+    return setTables({std::move(table)});
+}
+
+bool HistoInput::matches(const Compiled* current, const std::vector<std::shared_ptr<const HistoTable>>& replicas) const {
+    const HistoTable* currentTable {current ? current->table.get() : nullptr};
+    for (const std::shared_ptr<const HistoTable>& table : replicas) {
+        if (!table || !currentTable || table->nDims != currentTable->nDims) {
+            std::cout << "The table provided for " << m_histName << " doesn't match the histogram" << std::endl;
+            return false;
+        }
+        for (int i = 0; i < table->nDims; ++i) {
+            const HistoAxis& axis {table->axes[i]};
+            const HistoAxis& currentAxis {currentTable->axes[i]};
+            if (axis.nBins != currentAxis.nBins || axis.xMin != currentAxis.xMin || axis.xMax != currentAxis.xMax
+                || (axis.edges == nullptr) != (currentAxis.edges == nullptr)) {
+                std::cout << "The table provided for " << m_histName << " doesn't match the histogram" << std::endl;
+                return false;
+            }
+        }
+    }
+    if (replicas.empty()) {
+        std::cout << "No table provided for " << m_histName << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool HistoInput::acceptsTables(const std::vector<std::shared_ptr<const HistoTable>>& replicas) const {
+    EpochReclaimer::Guard guard;
+    return matches(m_compiled.load(), replicas);
+}
+
+bool HistoInput::setTables(std::vector<std::shared_ptr<const HistoTable>> replicas) {
+    std::lock_guard<std::mutex> lock(m_reloadMutex);
+    const Compiled* current {m_compiled.load()};
+    if (!matches(current, replicas))
+        return false;
+    std::shared_ptr<const HistoTable> table {replicas[0]};
+    if (replicas.size() == 1)
+        replicas.clear();
+    publish(std::make_unique<Compiled>(Compiled{std::move(table), current->surrogate, current->surrogateError, std::move(replicas),
+        current->kernel, current->inverse}));
+    updateMemoryUsage();
+    return true;
+}
+
+bool HistoInput::getInverse(const double value, double& x) const {
+    return getInverses(&value, &x, 1);
+}
+
+bool HistoInput::getInverses(const double* values, double* x, std::size_t nValues, std::size_t stride) const {
+    EpochReclaimer::Guard guard;
+    const Compiled* compiled {m_compiled.load()};
+    if (!compiled && !(compiled = restore())) {
+        std::cout << "The histogram " << m_histName << " must be initialized before being inverted" << std::endl;
+        return false;
+    }
+    markUsed();
+    if (!compiled->inverse) {
+        std::cout << "No inverse was built for the histogram " << m_histName << ", see setInverse()" << std::endl;
+        return false;
+    }
+    const GraphTable& inverse {*compiled->inverse};
+    int interval {-1};
+    for (std::size_t i = 0; i < nValues; ++i)
+        x[i] = inverse.evaluate(values[i*stride], interval);
     return true;
 }
 
+void HistoInput::setCapture(std::shared_ptr<HistoCapture> capture) {
+    if (capture)
+        m_captureStream = capture->addStream(name, m_fileName, m_histName, nDims);
+    m_capture = std::move(capture);
+}
+
 bool HistoInput::getValue(const xAOD::Jet& jet, const JetContext& event, double& value) const {
+    return evaluateJet(jet, event, value, nullptr);
+}
+
+bool HistoInput::getValueAndGradient(const xAOD::Jet& jet, const JetContext& event, double& value, double* gradient) const {
+    return evaluateJet(jet, event, value, gradient);
+}
+
+bool HistoInput::evaluateJet(const xAOD::Jet& jet, const JetContext& event, double& value, double* gradient) const {
+    // The compiled histogram stays alive until the guard is released, even if reloaded meanwhile
+    EpochReclaimer::Guard guard;
+    const Compiled* compiled {m_compiled.load()};
+    if (!compiled && !(compiled = restore())) {
+        std::cout << "The histogram " << m_histName << " must be initialized before being evaluated" << std::endl;
+        return false;
+    }
+    markUsed();
 
     float varValue1 {m_inVar1->getValue(jet, event)};
-    
-    varValue1 = HistoInput::enforceAxisRange(*m_hist->GetXaxis(), varValue1);
-    
+
     float varValue2{0};
-    if (nDims > 1) {
+    if (nDims > 1)
         varValue2 = m_inVar2->getValue(jet,event);
-        varValue2 = HistoInput::enforceAxisRange(*m_hist->GetYaxis(), varValue2);
+    if (m_capture)
+        record(varValue1, varValue2);
+
+    HistoCell cell;
+    value = evaluate(*compiled, compiled->getLocalTable(), varValue1, varValue2, cell, gradient);
+    return true;
+}
+
+bool HistoInput::getVariations(const xAOD::Jet& jet, const JetContext& event, const HistoShift* shifts,
+    std::size_t nShifts, double* values) const {
+    EpochReclaimer::Guard guard;
+    const Compiled* compiled {m_compiled.load()};
+    if (!compiled && !(compiled = restore())) {
+        std::cout << "The histogram " << m_histName << " must be initialized before being evaluated" << std::endl;
+        return false;
+    }
+    markUsed();
+
+    const float varValue1 {m_inVar1->getValue(jet, event)};
+    const float varValue2 {nDims > 1 ? m_inVar2->getValue(jet, event) : 0.f};
+    if (m_capture)
+        record(varValue1, varValue2);
+
+    const HistoTable& table {compiled->getLocalTable()};
+    HistoCell cell;
+    values[0] = evaluate(*compiled, table, varValue1, varValue2, cell);
+    for (std::size_t i = 0; i < nShifts; ++i) {
+        const HistoShift& shift {shifts[i]};
+        values[i+1] = evaluate(*compiled, table, varValue1*shift.scales[0] + shift.offsets[0],
+            varValue2*shift.scales[1] + shift.offsets[1], cell);
     }
-    // *a if a is unique_ptr returns a reference to the managed object
-    value = HistoInput::readFromHisto(*m_hist, varValue1, varValue2);
     return true;
-}
\ No newline at end of file
+}
+
+double HistoInput::evaluate(const Compiled& compiled, const HistoTable& table, float varValue1, float varValue2, HistoCell& cell, double* gradient) const {
+    // Same as RootHistoLoader::enforceAxisRange() and readFromHisto() on the histogram, reading the compiled table
+    const ChebyshevSurrogate* surrogate {compiled.surrogate.get()};
+    const float clamped1 {static_cast<float>(table.axes[0].enforceRange(varValue1))};
+    if (nDims == 1) {
+        if (!surrogate)
+            return table.interpolate(clamped1, cell, gradient);
+        if (!gradient)
+            return surrogate->evaluate(clamped1);
+        // Clamped axes have no gradient, as in HistoTable::interpolate()
+        const double value {surrogate->evaluate(clamped1, gradient)};
+        if (clamped1 != varValue1)
+            gradient[0] = 0;
+        return value;
+    }
+
+    const float clamped2 {static_cast<float>(table.axes[1].enforceRange(varValue2))};
+    if (!surrogate)
+        return table.interpolate(clamped1, clamped2, cell, gradient);
+    if (!gradient)
+        return surrogate->evaluate(clamped1, clamped2);
+    const double value {surrogate->evaluate(clamped1, clamped2, gradient)};
+    if (clamped1 != varValue1)
+        gradient[0] = 0;
+    if (clamped2 != varValue2)
+        gradient[1] = 0;
+    return value;
+}
+
+template <typename T>
+bool HistoInput::evaluateBatch(const T* x, const T* y, double* values, double* gradients,
+    std::size_t nValues, std::size_t stride) const {
+    EpochReclaimer::Guard guard;
+    const Compiled* compiled {m_compiled.load()};
+    if (!compiled && !(compiled = restore())) {
+        std::cout << "The histogram " << m_histName << " must be initialized before evaluating a batch" << std::endl;
+        return false;
+    }
+    markUsed();
+    if ((y == nullptr) != (nDims == 1)) {
+        std::cout << "Batch of " << (y ? 2 : 1) << "D inputs provided for the "
+        << nDims << "D histogram " << m_histName << std::endl;
+        return false;
+    }
+
+    if (m_capture) {
+        for (std::size_t i = 0; i < nValues; ++i)
+            record(x[i*stride], y ? y[i*stride] : 0);
+    }
+
+    if (m_coherentMinBatch > 0 && nValues >= m_coherentMinBatch && nValues <= UINT32_MAX && !compiled->surrogate
+        && compiled->table->getNumBytes() >= m_coherentMinBytes) {
+        evaluateCoherent(*compiled, x, y, values, gradients, nValues, stride);
+        return true;
+    }
+
+    // Inputs go through float like in getValue() so that both paths return identical values
+    // Consecutive entries close to each other share the bin search
+    const HistoTable& table {compiled->getLocalTable()};
+    HistoCell cell;
+    if (gradients) {
+        for (std::size_t i = 0; i < nValues; ++i)
+            values[i] = evaluate(*compiled, table, x[i*stride], y ? y[i*stride] : 0, cell, gradients + i*nDims);
+    } else if (nDims == 1) {
+        for (std::size_t i = 0; i < nValues; ++i)
+            values[i] = evaluate(*compiled, table, x[i*stride], 0, cell);
+    } else {
+        for (std::size_t i = 0; i < nValues; ++i)
+            values[i] = evaluate(*compiled, table, x[i*stride], y[i*stride], cell);
+    }
+    return true;
+}
+
+template <typename T>
+void HistoInput::evaluateCoherent(const Compiled& compiled, const T* x, const T* y, double* values,
+    double* gradients, std::size_t nValues, std::size_t stride) const {
+    // Buckets of consecutive contents, few enough for their counters to stay in cache
+    constexpr std::uint32_t MAXBUCKETS {2048};
+    const HistoTable& table {compiled.getLocalTable()};
+    const HistoAxis& xAxis {table.axes[0]};
+    const HistoAxis* yAxis {y ? &table.axes[1] : nullptr};
+    const std::uint32_t nBins = xAxis.nBins * (yAxis ? yAxis->nBins : 1);
+    int shift {0};
+    while (((nBins - 1) >> shift) >= MAXBUCKETS)
+        ++shift;
+
+    // Bucket of each entry : that of the bin it is evaluated in, found like evaluate() finds it
+    CoherentScratch& scratch {t_scratch};
+    scratch.buckets.resize(nValues);
+    scratch.entries.resize(nValues);
+    std::uint32_t offsets[MAXBUCKETS + 1] {};
+    for (std::size_t i = 0; i < nValues; ++i) {
+        const float varValue1 {static_cast<float>(x[i*stride])};
+        std::uint32_t bin = xAxis.findBin(xAxis.enforceRange(varValue1)) - 1;
+        if (yAxis) {
+            const float varValue2 {static_cast<float>(y[i*stride])};
+            bin += xAxis.nBins * (yAxis->findBin(yAxis->enforceRange(varValue2)) - 1);
+        }
+        scratch.buckets[i] = bin >> shift;
+        ++offsets[scratch.buckets[i] + 1];
+    }
+    for (std::uint32_t bucket = 1; bucket <= MAXBUCKETS; ++bucket)
+        offsets[bucket] += offsets[bucket - 1];
+    for (std::size_t i = 0; i < nValues; ++i) {
+        const std::uint32_t position {offsets[scratch.buckets[i]]++};
+        scratch.entries[position] = CoherentEntry{static_cast<float>(x[i*stride]), y ? static_cast<float>(y[i*stride]) : 0.f,
+            static_cast<std::uint32_t>(i)};
+    }
+
+    // Entries of a bucket read neighbouring contents, those of a bin share the bin search too
+    HistoCell cell;
+    for (const CoherentEntry& entry : scratch.entries)
+        values[entry.index] = evaluate(compiled, table, entry.x, entry.y, cell, gradients ? gradients + static_cast<std::size_t>(entry.index)*nDims : nullptr);
+}
+
+bool HistoInput::getValues(const double* x, double* values, std::size_t nValues, std::size_t stride) const {
+    return evaluateBatch<double>(x, nullptr, values, nullptr, nValues, stride);
+}
+
+bool HistoInput::getValues(const float* x, double* values, std::size_t nValues, std::size_t stride) const {
+    return evaluateBatch<float>(x, nullptr, values, nullptr, nValues, stride);
+}
+
+bool HistoInput::getValues(const double* x, const double* y, double* values, std::size_t nValues, std::size_t stride) const {
+    return evaluateBatch<double>(x, y, values, nullptr, nValues, stride);
+}
+
+bool HistoInput::getValues(const float* x, const float* y, double* values, std::size_t nValues, std::size_t stride) const {
+    return evaluateBatch<float>(x, y, values, nullptr, nValues, stride);
+}
+bool HistoInput::getValuesAndGradients(const double* x, double* values, double* gradients, std::size_t nValues, std::size_t stride) const {
+    return evaluateBatch<double>(x, nullptr, values, gradients, nValues, stride);
+}
+
+bool HistoInput::getValuesAndGradients(const float* x, double* values, double* gradients, std::size_t nValues, std::size_t stride) const {
+    return evaluateBatch<float>(x, nullptr, values, gradients, nValues, stride);
+}
+
+bool HistoInput::getValuesAndGradients(const double* x, const double* y, double* values, double* gradients, std::size_t nValues, std::size_t stride) const {
+    return evaluateBatch<double>(x, y, values, gradients, nValues, stride);
+}
+
+bool HistoInput::getValuesAndGradients(const float* x, const float* y, double* values, double* gradients, std::size_t nValues, std::size_t stride) const {
+    return evaluateBatch<float>(x, y, values, gradients, nValues, stride);
+}
@@ -0,0 +1,113 @@
+/**
+ * @file HistoLoader.cpp
+ * @author S. Schramm, A. Freeman
+ * @brief Contains the loader registry of HistoLoader.h
+ */
+
+#include <cctype>
+#include <iostream>
+
+#include "JetToolHelpers/HistoLoader.h"
+#include "JetToolHelpers/HistoFile.h"
+
+std::mutex& HistoLoader::mutex() {
+    static std::mutex loadersMutex;
+    return loadersMutex;
+}
+
+std::map<std::string, HistoLoader::Loader>& HistoLoader::loaders() {
+    // Function local : loaders may be registered from static initializers of other files
+    static std::map<std::string, Loader> registered {{HistoFile::EXTENSION, &HistoFile::read}};
+    return registered;
+}
+
+std::map<std::string, HistoLoader::GraphLoader>& HistoLoader::graphLoaders() {
+    static std::map<std::string, GraphLoader> registered;
+    return registered;
+}
+
+void HistoLoader::registerLoader(const std::string& extension, Loader loader) {
+    std::lock_guard<std::mutex> lock(mutex());
+    loaders()[getExtension(extension)] = std::move(loader);
+}
+
+bool HistoLoader::hasLoader(const std::string& extension) {
+    std::lock_guard<std::mutex> lock(mutex());
+    return loaders().count(getExtension(extension)) > 0;
+}
+
+bool HistoLoader::load(const std::string& fileName, const std::string& histName, LoadedHisto& histo) {
+    const std::string extension {getExtension(fileName)};
+    Loader loader;
+    {
+        // Copied : loading must not hold the lock, files are read from several threads
+        std::lock_guard<std::mutex> lock(mutex());
+        const auto found {loaders().find(extension)};
+        if (found != loaders().end())
+            loader = found->second;
+    }
+    if (!loader) {
+        std::cout << "No loader registered for the \"" << extension << "\" files, cannot read " << fileName;
+        if (extension == ".root")
+            std::cout << " : link the ROOT loader or convert the file with convert_histos";
+        std::cout << std::endl;
+        return false;
+    }
+
+    histo = LoadedHisto();
+    if (!loader(fileName, histName, histo))
+        return false;
+    if (histo.nDims != static_cast<int>(histo.binnings.size())) {
+        std::cout << "The loader of " << fileName << " returned " << histo.binnings.size()
+        << " axes for the " << histo.nDims << "D histogram " << histName << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void HistoLoader::registerGraphLoader(const std::string& extension, GraphLoader loader) {
+    std::lock_guard<std::mutex> lock(mutex());
+    graphLoaders()[getExtension(extension)] = std::move(loader);
+}
+
+bool HistoLoader::loadGraph(const std::string& fileName, const std::string& graphName, LoadedGraph& graph) {
+    GraphLoader loader;
+    {
+        std::lock_guard<std::mutex> lock(mutex());
+        const auto found {graphLoaders().find(getExtension(fileName))};
+        if (found != graphLoaders().end())
+            loader = found->second;
+    }
+    graph = LoadedGraph();
+    if (loader)
+        return loader(fileName, graphName, graph);
+
+    LoadedHisto histo;
+    if (!load(fileName, graphName, histo))
+        return false;
+    if (histo.nDims != 1) {
+        std::cout << "Cannot read the " << histo.nDims << "D histogram " << graphName << " of " << fileName
+        << " as a curve" << std::endl;
+        return false;
+    }
+    const HistoAxisBinning& binning {histo.binnings[0]};
+    const double binWidth {(binning.xMax - binning.xMin) / double(binning.nBins)};
+    for (int bin = 0; bin < binning.nBins; ++bin) {
+        // TAxis::GetBinCenter, TH1::Interpolate interpolates between these points
+        graph.x.push_back(binning.edges.empty() ? binning.xMin + bin*binWidth + 0.5*binWidth
+            : binning.edges[bin] + 0.5*(binning.edges[bin+1] - binning.edges[bin]));
+        graph.y.push_back(histo.contents[bin]);
+    }
+    return true;
+}
+
+std::string HistoLoader::getExtension(const std::string& fileName) {
+    const std::size_t dot {fileName.rfind('.')};
+    const std::size_t slash {fileName.find_last_of("/\\")};
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+        return "";
+    std::string extension {fileName.substr(dot)};
+    for (char& c : extension)
+        c = std::tolower(static_cast<unsigned char>(c));
+    return extension;
+}
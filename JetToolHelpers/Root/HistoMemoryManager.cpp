@@ -0,0 +1,74 @@
+/**
+ * @file HistoMemoryManager.cpp
+ * @author S. Schramm, A. Freeman
+ * @brief Contains the accounting and eviction of HistoMemoryManager.h
+ */
+
+#include <algorithm>
+
+#include "JetToolHelpers/HistoMemoryManager.h"
+#include "JetToolHelpers/HistoInput.h"
+
+HistoMemoryManager& HistoMemoryManager::instance() {
+    // Never destroyed : inputs may unregister during static destruction
+    static HistoMemoryManager* manager {new HistoMemoryManager()};
+    return *manager;
+}
+
+void HistoMemoryManager::setBudget(const std::size_t bytes) {
+    m_budget.store(bytes);
+    enforceBudget(nullptr);
+}
+
+std::map<std::string, std::size_t> HistoMemoryManager::getBytesPerFile() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::map<std::string, std::size_t> bytes;
+    for (const HistoInput* input : m_inputs)
+        bytes[input->getFileName()] += input->getMemoryUsage();
+    return bytes;
+}
+
+std::vector<std::pair<const HistoInput*, std::size_t>> HistoMemoryManager::getBytesPerInput() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<std::pair<const HistoInput*, std::size_t>> bytes;
+    for (const HistoInput* input : m_inputs)
+        bytes.emplace_back(input, input->getMemoryUsage());
+    return bytes;
+}
+
+void HistoMemoryManager::add(const HistoInput* input) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_inputs.push_back(input);
+}
+
+void HistoMemoryManager::remove(const HistoInput* input) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto found {std::find(m_inputs.begin(), m_inputs.end(), input)};
+    if (found == m_inputs.end())
+        return;
+    const std::size_t index = found - m_inputs.begin();
+    m_inputs.erase(found);
+    if (m_hand > index)
+        --m_hand;
+    if (m_hand >= m_inputs.size())
+        m_hand = 0;
+}
+
+void HistoMemoryManager::enforceBudget(const HistoInput* keep) {
+    const std::size_t budget {m_budget.load()};
+    if (budget == 0 || m_totalBytes.load() <= budget)
+        return;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    // Two turns : the first may only clear the used flags
+    for (std::size_t step = 0; step < 2 * m_inputs.size() && m_totalBytes.load() > budget; ++step) {
+        const HistoInput* input {m_inputs[m_hand]};
+        m_hand = (m_hand + 1) % m_inputs.size();
+        if (input == keep || input->getMemoryUsage() == 0)
+            continue;
+        if (input->m_used.exchange(false, std::memory_order_relaxed))
+            continue;
+        if (input->evict())
+            m_nEvictions.fetch_add(1);
+    }
+}
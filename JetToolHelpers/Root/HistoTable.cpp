@@ -0,0 +1,298 @@
+/**
+ * @file HistoTable.cpp
+ * @author S. Schramm, A. Freeman
+ * @brief Contains the construction, compression and relocation of HistoTable.h
+ */
+
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "JetToolHelpers/HistoTable.h"
+
+namespace {
+    // Contents of a table, possibly shared between tables
+    struct ContentBlock {
+        std::vector<HistoTile> tiles;
+        std::vector<double> values;
+        std::vector<std::uint16_t> quantized;
+    };
+
+    // A table together with the values it points to
+    struct OwningHistoTable : public HistoTable {
+        std::vector<double> storage;                    // edges, and contents if not shared
+        std::shared_ptr<const ContentBlock> block;      // shared contents
+    };
+
+    template <typename T> bool sameBytes(const std::vector<T>& a, const std::vector<T>& b) {
+        return a.size() == b.size() && (a.empty() || std::memcmp(a.data(), b.data(), a.size() * sizeof(T)) == 0);
+    }
+
+    template <typename T> std::size_t hashBytes(std::size_t hash, const std::vector<T>& values) {
+        // FNV-1a
+        const unsigned char* bytes {reinterpret_cast<const unsigned char*>(values.data())};
+        for (std::size_t i = 0; i < values.size() * sizeof(T); ++i)
+            hash = (hash ^ bytes[i]) * 1099511628211ull;
+        return hash;
+    }
+
+    /**
+     * Blocks of the live compressed tables, to share contents between histograms that are
+     * bitwise identical (the same component for several jet collections...).
+     */
+    class ContentPool {
+        public:
+            static ContentPool& instance() {
+                static ContentPool pool;
+                return pool;
+            }
+
+            std::shared_ptr<const ContentBlock> share(std::shared_ptr<const ContentBlock> block) {
+                const std::size_t hash {hashBytes(hashBytes(hashBytes(14695981039346656037ull,
+                    block->tiles), block->values), block->quantized)};
+
+                std::lock_guard<std::mutex> lock(m_mutex);
+                auto range {m_blocks.equal_range(hash)};
+                for (auto it = range.first; it != range.second;) {
+                    std::shared_ptr<const ContentBlock> existing {it->second.lock()};
+                    if (!existing) {
+                        it = m_blocks.erase(it);
+                        continue;
+                    }
+                    if (sameBytes(existing->tiles, block->tiles) && sameBytes(existing->values, block->values)
+                        && sameBytes(existing->quantized, block->quantized))
+                        return existing;
+                    ++it;
+                }
+                m_blocks.emplace(hash, block);
+                return block;
+            }
+
+        private:
+            std::mutex m_mutex;
+            std::unordered_multimap<std::size_t, std::weak_ptr<const ContentBlock>> m_blocks;
+    };
+
+    // Appends values to pool unless the same values are already in it, returns their offset
+    template <typename T> std::uint32_t addUnique(std::vector<T>& pool, std::unordered_map<std::string, std::uint32_t>& known, const std::vector<T>& values) {
+        const std::string key(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+        auto found {known.find(key)};
+        if (found != known.end())
+            return found->second;
+        const std::uint32_t offset = pool.size();
+        pool.insert(pool.end(), values.begin(), values.end());
+        known.emplace(key, offset);
+        return offset;
+    }
+
+    /**
+     * Split the contents in tiles, stored as a single value if constant, as 16-bit integers
+     * if that is within the tolerance and as doubles otherwise. Identical tiles are stored once.
+     */
+    std::shared_ptr<ContentBlock> compress(HistoTable& table, const std::vector<double>& contents, const double tolerance) {
+        const int nBinsX {table.axes[0].nBins};
+        const int nBinsY {table.nDims > 1 ? table.axes[1].nBins : 1};
+        const int sizeX {1 << table.tileShiftX};
+        const int sizeY {1 << table.tileShiftY};
+        const int nTilesY {(nBinsY + sizeY - 1) / sizeY};
+
+        auto block {std::make_shared<ContentBlock>()};
+        std::unordered_map<std::string, std::uint32_t> knownValues, knownQuantized;
+        std::vector<double> tileValues(sizeX * sizeY);
+        std::vector<std::uint16_t> tileQuantized(sizeX * sizeY);
+
+        for (int tileY = 0; tileY < nTilesY; ++tileY) {
+            for (int tileX = 0; tileX < table.nTilesX; ++tileX) {
+                // Values of the tile, the padding of the last tiles is never read
+                std::fill(tileValues.begin(), tileValues.end(), 0.);
+                const double first {contents[tileX*sizeX + nBinsX*tileY*sizeY]};
+                double low {first}, high {first};
+                bool constant {true};
+                for (int localY = 0; localY < sizeY && tileY*sizeY + localY < nBinsY; ++localY) {
+                    for (int localX = 0; localX < sizeX && tileX*sizeX + localX < nBinsX; ++localX) {
+                        const double value {contents[(tileX*sizeX + localX) + nBinsX*(tileY*sizeY + localY)]};
+                        tileValues[localX + sizeX*localY] = value;
+                        constant = constant && std::memcmp(&value, &first, sizeof(double)) == 0;
+                        low = std::min(low, value);
+                        high = std::max(high, value);
+                    }
+                }
+
+                if (constant) {
+                    block->tiles.push_back(HistoTile{HistoTile::Constant, 0, first, 0.});
+                    continue;
+                }
+
+                if (tolerance > 0 && std::isfinite(high - low)) {
+                    const double scale {(high - low) / 65535.};
+                    bool withinTolerance {true};
+                    for (std::size_t i = 0; i < tileValues.size(); ++i) {
+                        const double value {std::min(std::max(tileValues[i], low), high)};
+                        tileQuantized[i] = static_cast<std::uint16_t>(std::lround((value - low) / scale));
+                        // only the values actually read must be checked, padding is 0 and always fits
+                        withinTolerance = withinTolerance && std::abs(low + scale*tileQuantized[i] - value) <= tolerance;
+                    }
+                    if (withinTolerance) {
+                        const std::uint32_t offset {addUnique(block->quantized, knownQuantized, tileQuantized)};
+                        block->tiles.push_back(HistoTile{HistoTile::Quantized, offset, low, scale});
+                        continue;
+                    }
+                }
+
+                const std::uint32_t offset {addUnique(block->values, knownValues, tileValues)};
+                block->tiles.push_back(HistoTile{HistoTile::Dense, offset, 0., 0.});
+            }
+        }
+        return block;
+    }
+
+    template <typename T> std::size_t alignedSize(const std::size_t nValues, const std::size_t alignment) {
+        return (nValues * sizeof(T) + alignment - 1) / alignment * alignment;
+    }
+
+    template <typename T> const T* copyTo(char*& cursor, const T* values, const std::size_t nValues, const std::size_t alignment) {
+        if (!values)
+            return nullptr;
+        T* copy {reinterpret_cast<T*>(cursor)};
+        std::memcpy(copy, values, nValues * sizeof(T));
+        cursor += alignedSize<T>(nValues, alignment);
+        return copy;
+    }
+}
+
+std::shared_ptr<const HistoTable> HistoTable::create(
+    const std::vector<HistoAxisBinning>& binnings,
+    const std::vector<double>& contents,
+    const HistoCompression& compression
+) {
+    if (binnings.empty() || binnings.size() > 2) {
+        std::cout << "Cannot build a table of dimension " << binnings.size() << std::endl;
+        return nullptr;
+    }
+
+    std::size_t nValues {1};
+    std::size_t nEdges {0};
+    for (const HistoAxisBinning& binning : binnings) {
+        const bool variable {!binning.edges.empty()};
+        if (binning.nBins < 1 || !(binning.xMin < binning.xMax)
+            || (variable && binning.edges.size() != static_cast<std::size_t>(binning.nBins) + 1)
+            || (variable && std::adjacent_find(binning.edges.begin(), binning.edges.end(),
+                [](const double low, const double up) { return !(low < up); }) != binning.edges.end())) {
+            std::cout << "Inconsistent binning provided to build a table" << std::endl;
+            return nullptr;
+        }
+        nValues *= binning.nBins;
+        nEdges += binning.edges.size();
+    }
+    if (contents.size() != nValues) {
+        std::cout << "Expected " << nValues << " bin contents to build a table, got " << contents.size() << std::endl;
+        return nullptr;
+    }
+
+    auto table {std::make_shared<OwningHistoTable>()};
+    table->storage.reserve(nEdges + (compression.enabled ? 0 : nValues));
+    table->nDims = binnings.size();
+
+    for (std::size_t i = 0; i < 2; ++i) {
+        HistoAxis& axis {table->axes[i]};
+        if (i >= binnings.size()) {
+            axis = HistoAxis{1, 0., 1., 1., 0., 1., nullptr};
+            continue;
+        }
+        const HistoAxisBinning& binning {binnings[i]};
+        axis.nBins = binning.nBins;
+        axis.xMin = binning.edges.empty() ? binning.xMin : binning.edges.front();
+        axis.xMax = binning.edges.empty() ? binning.xMax : binning.edges.back();
+        axis.binWidth = (axis.xMax - axis.xMin) / double(axis.nBins);
+        axis.edges = nullptr;
+        if (!binning.edges.empty()) {
+            axis.edges = table->storage.data() + table->storage.size();
+            table->storage.insert(table->storage.end(), binning.edges.begin(), binning.edges.end());
+        }
+
+        // Same offsets as RootHistoLoader::enforceAxisRange
+        static constexpr double edgeOffset {1.e-4};
+        axis.lowClamp = axis.getBinLowEdge(1) + edgeOffset*axis.getBinWidth(1);
+        axis.highClamp = axis.getBinLowEdge(axis.nBins) + (1-edgeOffset)*axis.getBinWidth(axis.nBins);
+    }
+
+    table->tiles = nullptr;
+    table->quantized = nullptr;
+    table->tileShiftX = 0;
+    table->tileShiftY = 0;
+    table->nTilesX = 0;
+    table->nTiles = 0;
+    table->nContents = nValues;
+    table->nQuantized = 0;
+
+    if (!compression.enabled) {
+        table->contents = table->storage.data() + table->storage.size();
+        table->storage.insert(table->storage.end(), contents.begin(), contents.end());
+        return table;
+    }
+
+    table->tileShiftX = table->nDims == 1 ? 6 : 3;
+    table->tileShiftY = table->nDims == 1 ? 0 : 3;
+    table->nTilesX = (table->axes[0].nBins + (1 << table->tileShiftX) - 1) >> table->tileShiftX;
+    std::shared_ptr<ContentBlock> block {compress(*table, contents, compression.quantizationTolerance)};
+
+    // Tiles only pay off if they are smaller than the plain contents
+    const std::size_t tiledSize {block->tiles.size() * sizeof(HistoTile) + block->values.size() * sizeof(double)
+        + block->quantized.size() * sizeof(std::uint16_t)};
+    if (tiledSize >= nValues * sizeof(double)) {
+        block->tiles.clear();
+        block->values = contents;
+        block->quantized.clear();
+    }
+
+    table->block = ContentPool::instance().share(std::move(block));
+    table->contents = table->block->values.data();
+    table->nContents = table->block->values.size();
+    table->quantized = table->block->quantized.empty() ? nullptr : table->block->quantized.data();
+    table->nQuantized = table->block->quantized.size();
+    if (!table->block->tiles.empty()) {
+        table->tiles = table->block->tiles.data();
+        table->nTiles = table->block->tiles.size();
+    } else {
+        table->tileShiftX = table->tileShiftY = table->nTilesX = 0;
+    }
+    return table;
+}
+
+std::size_t HistoTable::getNumBins() const {
+    std::size_t nBins {1};
+    for (int i = 0; i < nDims; ++i)
+        nBins *= axes[i].nBins;
+    return nBins;
+}
+
+std::size_t HistoTable::getNumBytes() const {
+    std::size_t nBytes {nTiles * sizeof(HistoTile) + nContents * sizeof(double) + nQuantized * sizeof(std::uint16_t)};
+    for (int i = 0; i < nDims; ++i)
+        if (axes[i].edges)
+            nBytes += (axes[i].nBins + 1) * sizeof(double);
+    return nBytes;
+}
+
+std::size_t HistoTable::getRelocatedSize(const std::size_t alignment) const {
+    std::size_t size {0};
+    for (int i = 0; i < nDims; ++i)
+        if (axes[i].edges)
+            size += alignedSize<double>(axes[i].nBins + 1, alignment);
+    return size + alignedSize<HistoTile>(nTiles, alignment) + alignedSize<double>(nContents, alignment)
+        + alignedSize<std::uint16_t>(nQuantized, alignment);
+}
+
+HistoTable HistoTable::relocate(char*& cursor, const std::size_t alignment) const {
+    // In the order a lookup reads them
+    HistoTable copy {*this};
+    for (int i = 0; i < nDims; ++i)
+        copy.axes[i].edges = copyTo(cursor, axes[i].edges, axes[i].nBins + 1, alignment);
+    copy.tiles = copyTo(cursor, tiles, nTiles, alignment);
+    copy.contents = copyTo(cursor, contents, nContents, alignment);
+    copy.quantized = copyTo(cursor, quantized, nQuantized, alignment);
+    return copy;
+}
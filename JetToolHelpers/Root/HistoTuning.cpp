@@ -0,0 +1,87 @@
+/**
+ * @file HistoTuning.cpp
+ * @author S. Schramm, A. Freeman
+ * @brief Contains the tuning cache of HistoTuning.h
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+
+#include "JetToolHelpers/HistoTuning.h"
+
+namespace {
+    const char* KERNELNAMES[] {"Table", "CompressedTable", "QuantizedTable", "Surrogate"};
+
+    // FNV-1a
+    void hash(std::uint64_t& value, const void* data, const std::size_t size) {
+        const unsigned char* bytes {static_cast<const unsigned char*>(data)};
+        for (std::size_t i = 0; i < size; ++i) {
+            value ^= bytes[i];
+            value *= 0x100000001b3ULL;
+        }
+    }
+
+    // The inputs of a job are initialized from several threads
+    std::mutex cacheMutex;
+}
+
+const char* toString(const HistoKernel kernel) {
+    return KERNELNAMES[static_cast<int>(kernel)];
+}
+
+bool fromString(const std::string& name, HistoKernel& kernel) {
+    for (int i = 0; i < 4; ++i) {
+        if (name == KERNELNAMES[i]) {
+            kernel = static_cast<HistoKernel>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+std::string HistoTuningCache::getKey(const std::string& histName, const LoadedHisto& histo, const double maxError) {
+    std::uint64_t value {0xcbf29ce484222325ULL};
+    for (const HistoAxisBinning& binning : histo.binnings) {
+        hash(value, &binning.nBins, sizeof(binning.nBins));
+        hash(value, &binning.xMin, sizeof(binning.xMin));
+        hash(value, &binning.xMax, sizeof(binning.xMax));
+        hash(value, binning.edges.data(), binning.edges.size() * sizeof(double));
+    }
+    hash(value, histo.contents.data(), histo.contents.size() * sizeof(double));
+
+    char buffer[64];
+    snprintf(buffer, sizeof(buffer), "\t%016llx\t%a", static_cast<unsigned long long>(value), maxError);
+    return histName + buffer;
+}
+
+bool HistoTuningCache::lookup(const std::string& cacheFile, const std::string& key, HistoKernel& kernel) {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    std::ifstream in(cacheFile);
+    bool found {false};
+    std::string line;
+    while (std::getline(in, line)) {
+        const std::size_t tab {line.find('\t')};
+        HistoKernel cached;
+        if (tab != std::string::npos && line.compare(tab + 1, std::string::npos, key) == 0
+            && fromString(line.substr(0, tab), cached)) {
+            kernel = cached;
+            found = true;
+        }
+    }
+    return found;
+}
+
+bool HistoTuningCache::record(const std::string& cacheFile, const std::string& key, const HistoKernel kernel) {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    std::ofstream out(cacheFile, std::ios::app);
+    out << toString(kernel) << '\t' << key << '\n';
+    out.close();
+    if (!out) {
+        std::cout << "Failed to write the tuning cache " << cacheFile << std::endl;
+        return false;
+    }
+    return true;
+}
@@ -9,6 +9,16 @@ InputVariable::InputVariable(
     customFunction = func;
 }
 
+namespace {
+    // nullptr if the attribute is known with another type
+    template <typename T> std::unique_ptr<InputVariable> createAttribute(const std::string& name) {
+        auto attribute = std::make_unique<InputVariableAttribute<T>>(name);
+        if (!attribute->isValid())
+            return nullptr;
+        return attribute;
+    }
+}
+
 // TODO : Confer with steven about throwing exceptions instead of returning nullptrs. 
 std::unique_ptr<InputVariable> InputVariable::createVariable(const std::string& name, const std::string& type, const bool isJetVar)
 {
@@ -61,13 +71,12 @@ std::unique_ptr<InputVariable> InputVariable::createVariable(const std::string&
                 }); 
 
         // Not a pre-defined attribute, assume it is a generic attribute
-        /*
         if (type == "float")
-            return std::make_unique<InputVariableAttribute<float>>(name);
+            return createAttribute<float>(name);
         
         if (type == "int")
-            return std::make_unique<InputVariableAttribute<int>>(name);
-        */        
+            return createAttribute<int>(name);
+
         // Unsupported type for a generic attribute
         return nullptr;
     } else {
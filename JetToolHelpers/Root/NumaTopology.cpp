@@ -0,0 +1,118 @@
+/**
+ * @file NumaTopology.cpp
+ * @author S. Schramm, A. Freeman
+ * @brief Contains the discovery of the NUMA nodes of NumaTopology.h
+ */
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "JetToolHelpers/NumaTopology.h"
+
+namespace {
+    // Parses a CPU list such as "0-3,8-11"
+    std::vector<int> parseCpuList(const std::string& list) {
+        std::vector<int> cpus;
+        std::stringstream stream(list);
+        std::string range;
+        while (std::getline(stream, range, ',')) {
+            const std::size_t dash {range.find('-')};
+            try {
+                const int first {std::stoi(range.substr(0, dash))};
+                const int last {dash == std::string::npos ? first : std::stoi(range.substr(dash + 1))};
+                for (int cpu = first; cpu <= last; ++cpu)
+                    cpus.push_back(cpu);
+            } catch (const std::exception&) {
+                return {};
+            }
+        }
+        return cpus;
+    }
+
+    struct Topology {
+        std::vector<std::vector<int>> nodeCpus;     // CPUs of each node
+        std::vector<int> cpuNodes;                  // node of each CPU
+
+        Topology() {
+#ifdef __linux__
+            // Nodes may be numbered with gaps, e.g. after offlining one
+            for (int node = 0; node < 1024; ++node) {
+                std::ifstream file("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+                if (!file) {
+                    if (!nodeCpus.empty())
+                        break;
+                    continue;
+                }
+                std::string list;
+                std::getline(file, list);
+                std::vector<int> cpus {parseCpuList(list)};
+                if (!cpus.empty())
+                    nodeCpus.push_back(std::move(cpus));
+            }
+#endif
+            if (nodeCpus.empty()) {
+                nodeCpus.emplace_back();
+                for (unsigned cpu = 0; cpu < std::max(1u, std::thread::hardware_concurrency()); ++cpu)
+                    nodeCpus[0].push_back(cpu);
+            }
+            for (std::size_t node = 0; node < nodeCpus.size(); ++node) {
+                for (const int cpu : nodeCpus[node]) {
+                    if (cpu >= static_cast<int>(cpuNodes.size()))
+                        cpuNodes.resize(cpu + 1, 0);
+                    cpuNodes[cpu] = node;
+                }
+            }
+        }
+    };
+
+    const Topology& topology() {
+        static const Topology instance;
+        return instance;
+    }
+}
+
+int NumaTopology::getNumNodes() {
+    return topology().nodeCpus.size();
+}
+
+const std::vector<int>& NumaTopology::getCpus(const int node) {
+    return topology().nodeCpus.at(node);
+}
+
+int NumaTopology::getNodeOfCpu(const int cpu) {
+    const std::vector<int>& cpuNodes {topology().cpuNodes};
+    return cpu >= 0 && cpu < static_cast<int>(cpuNodes.size()) ? cpuNodes[cpu] : 0;
+}
+
+int NumaTopology::findCurrentNode() {
+    if (getNumNodes() == 1)
+        return 0;
+#ifdef __linux__
+    return getNodeOfCpu(sched_getcpu());
+#else
+    return 0;
+#endif
+}
+
+void NumaTopology::runOnNode(const int node, const std::function<void()>& function) {
+    std::thread thread([node, &function]() {
+#ifdef __linux__
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        for (const int cpu : getCpus(node))
+            if (cpu < CPU_SETSIZE)
+                CPU_SET(cpu, &cpus);
+        pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+#endif
+        function();
+    });
+    thread.join();
+}
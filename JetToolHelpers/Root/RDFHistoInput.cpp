@@ -0,0 +1,69 @@
+/**
+ * @file RDFHistoInput.cpp
+ * @author S. Schramm, A. Freeman
+ * @brief Contains the RDataFrame Define callables of RDFHistoInput.h
+ */
+
+#include <memory>
+#include <stdexcept>
+
+#include "JetToolHelpers/RDFHistoInput.h"
+
+namespace {
+    // One output buffer per processing slot, aligned so that two slots never share a cache line
+    struct alignas(64) SlotBuffer {
+        std::vector<double> values;
+    };
+    using SlotBuffers = std::vector<SlotBuffer>;
+
+    double* prepare(SlotBuffer& buffer, const std::size_t nJets) {
+        // never shrinks, so the steady state doesn't allocate
+        if (buffer.values.size() < nJets)
+            buffer.values.resize(nJets);
+        return buffer.values.data();
+    }
+
+    void check(const bool status, const HistoInput& input) {
+        if (!status)
+            throw std::runtime_error("RDFHistoInput : failed to evaluate " + input.getHistName());
+    }
+}
+
+ROOT::RDF::RNode RDFHistoInput::define(
+    ROOT::RDF::RNode df,
+    const std::string& column,
+    const HistoInput& input,
+    const std::vector<std::string>& axisColumns
+) {
+    if (static_cast<int>(axisColumns.size()) != input.getNDims())
+        throw std::invalid_argument("RDFHistoInput : " + std::to_string(axisColumns.size()) 
+            + " axis columns given for the " + std::to_string(input.getNDims()) 
+            + "D histogram " + input.getHistName());
+
+    // RDataFrame copies the callable, the buffers are shared between the copies
+    auto buffers = std::make_shared<SlotBuffers>(df.GetNSlots());
+    const HistoInput* histo = &input;
+
+    if (input.getNDims() == 1)
+        return df.DefineSlot(column, 
+            [buffers, histo](unsigned int slot, const ROOT::RVec<float>& x) {
+                double* values = prepare((*buffers)[slot], x.size());
+                check(histo->getValues(x.data(), values, x.size()), *histo);
+                return ROOT::RVec<double>(values, x.size());
+            }, axisColumns);
+
+    return df.DefineSlot(column, 
+        [buffers, histo](unsigned int slot, const ROOT::RVec<float>& x, const ROOT::RVec<float>& y) {
+            if (x.size() != y.size())
+                throw std::runtime_error("RDFHistoInput : jet columns of different sizes for " + histo->getHistName());
+            double* values = prepare((*buffers)[slot], x.size());
+            check(histo->getValues(x.data(), y.data(), values, x.size()), *histo);
+            return ROOT::RVec<double>(values, x.size());
+        }, axisColumns);
+}
+
+ROOT::RDF::RNode RDFHistoInput::defineAll(ROOT::RDF::RNode df, const std::vector<Column>& columns) {
+    for (const Column& column : columns)
+        df = define(df, column.name, *column.input, column.axisColumns);
+    return df;
+}
@@ -0,0 +1,13 @@
+/**
+ * @file RootHistoLoader.Install.cpp
+ * @author S. Schramm, A. Freeman
+ * @brief Registers the ROOT file loader. Compiled into every executable linking the
+ * JetToolHelpers library (an INTERFACE source), an initializer in the static library
+ * itself would be dropped by the linker as nothing refers to it.
+ */
+
+#include "JetToolHelpers/RootHistoLoader.h"
+
+namespace {
+    const bool rootLoaderInstalled {RootHistoLoader::install()};
+}
@@ -0,0 +1,206 @@
+/**
+ * @file RootHistoLoader.cpp
+ * @author S.Schramm, A. Freeman 
+ * @brief Contains the ROOT file loader of RootHistoLoader.h, formerly the static
+ * implementations of HistoInput.
+ * @version 0.1
+ * @date 2022-04-21
+ * 
+ * @copyright Copyright (c) 2022
+ * 
+ */
+#include <iostream>
+#include <filesystem>
+#include "JetToolHelpers/RootHistoLoader.h"
+#include "TFile.h"
+#include "TProfile.h"
+
+bool RootHistoLoader::install() {
+    static const bool installed {(HistoLoader::registerLoader(".root", &RootHistoLoader::load),
+        HistoLoader::registerGraphLoader(".root", &RootHistoLoader::loadGraph), true)};
+    return installed;
+}
+
+bool RootHistoLoader::load(const std::string& fileName, const std::string& histName, LoadedHisto& histo) {
+    std::unique_ptr<TH1> hist;
+    if (!readHistoFromFile(hist, fileName, histName) || !hist)
+        return false;
+    return convert(*hist, histo);
+}
+
+bool RootHistoLoader::readHistoFromFile(std::unique_ptr<TH1>& m_hist, const std::string m_fileName, const std::string m_histName) {
+    // Open the input file
+    TFile inputFile(m_fileName.c_str(), "READ");
+    if (inputFile.IsZombie()) {
+        std::cout << "Failed to open the file to read: " << m_fileName << "\n";
+        inputFile.Close();
+        return false;
+    }
+
+    // Get the input object
+    TObject* inputObject = inputFile.Get(m_histName.c_str());
+    if (!inputObject) {
+        std::cout << "Failed to retreive the requested histogram \"" << m_histName << "\" from the file: " << m_fileName << "\n";
+        inputFile.Close();
+        return false;
+    }
+
+    // Confirm that the input object is a histogram
+    m_hist = std::unique_ptr<TH1>(dynamic_cast<TH1*>(inputObject));
+    if (!m_hist) {
+        std::cout << "Failed to convert the retrieved input to a histogram \"" << m_histName << "\" from the file: " << m_fileName << "\n";
+        inputFile.Close();
+        return false;
+    }
+
+    // Successfully retrieved the histogram
+    m_hist->SetDirectory(0);
+    inputFile.Close();
+    return true;
+}
+
+double RootHistoLoader::enforceAxisRange(const TAxis& axis, const double inputValue) {
+    // edgeOffset should be chosen to be above floating point precision, but negligible compared to the bin size
+    // An offset of edgeOffset*binWidth is therefore irrelevant for physics as the values don't change fast (but avoids edge errors)
+    static constexpr double edgeOffset {1.e-4};
+
+    // Root histogram binning: bin 0 = underflow bin, bin 1 = first actual bin, bin N = last actual bin, bin N+1 = overflow bin
+    const int numBins {axis.GetNbins()};
+    const int binIndex {axis.FindFixBin(inputValue)};
+
+    if (binIndex < 1)
+        return axis.GetBinLowEdge(1) + edgeOffset*axis.GetBinWidth(1);
+        // Return just inside the range of the first real bin
+    if (binIndex > numBins)
+        return axis.GetBinLowEdge(numBins) + (1-edgeOffset)*axis.GetBinWidth(numBins);
+        // Return just inside the range of the last real bin
+        // Don't use the upper edge as floating point can make it roll into the next bin (which is overflow)
+        // Instead, use the last bin width to go slightly within the boundary
+    return inputValue;
+}
+
+double RootHistoLoader::readFromHisto(const TH1& m_hist, const double X, const double Y, const double Z) {
+    // TODO: extend this to have different reading strategies
+    const int nDim {m_hist.GetDimension()};
+    
+    if (nDim == 1)
+        return m_hist.Interpolate(X);
+    else if (nDim == 2)
+        return m_hist.Interpolate(X, Y);
+    else if (nDim == 3)
+        return m_hist.Interpolate(X, Y, Z);
+    // Shouldn't reach here due to previous checks
+    throw std::runtime_error("Unexpected number of dimensions of histogram: " + nDim);
+    return 0;
+}
+
+bool RootHistoLoader::convert(const TH1& hist, LoadedHisto& histo) {
+    const int nDim {hist.GetDimension()};
+    if (nDim != 1 && nDim != 2) {
+        std::cout << "Cannot compile the histogram \"" << hist.GetName() << "\" of dimension " << nDim << "\n";
+        return false;
+    }
+
+    histo.nDims = nDim;
+    histo.binnings.clear();
+    for (const TAxis* axis : {hist.GetXaxis(), hist.GetYaxis()}) {
+        if (static_cast<int>(histo.binnings.size()) == nDim)
+            break;
+        HistoAxisBinning binning {axis->GetNbins(), axis->GetXmin(), axis->GetXmax(), {}};
+        if (axis->IsVariableBinSize()) {
+            const TArrayD& edges {*axis->GetXbins()};
+            binning.edges.assign(edges.GetArray(), edges.GetArray() + edges.GetSize());
+        }
+        histo.binnings.push_back(std::move(binning));
+    }
+
+    // In-range bins only, the lookups never read the under- and overflows
+    const int nBinsX {hist.GetNbinsX()};
+    const int nBinsY {nDim > 1 ? hist.GetNbinsY() : 1};
+    histo.contents.clear();
+    histo.contents.reserve(static_cast<std::size_t>(nBinsX) * nBinsY);
+    for (int binY = 1; binY <= nBinsY; ++binY)
+        for (int binX = 1; binX <= nBinsX; ++binX)
+            histo.contents.push_back(nDim > 1 ? hist.GetBinContent(binX, binY) : hist.GetBinContent(binX));
+    return true;
+}
+
+bool RootHistoLoader::loadGraph(const std::string& fileName, const std::string& graphName, LoadedGraph& graph) {
+    TFile inputFile(fileName.c_str(), "READ");
+    if (inputFile.IsZombie()) {
+        std::cout << "Failed to open the file to read: " << fileName << "\n";
+        inputFile.Close();
+        return false;
+    }
+
+    std::unique_ptr<TObject> inputObject {inputFile.Get(graphName.c_str())};
+    if (!inputObject) {
+        std::cout << "Failed to retreive the requested curve \"" << graphName << "\" from the file: " << fileName << "\n";
+        inputFile.Close();
+        return false;
+    }
+    // Histograms belong to the file, which would delete them when closed
+    if (TH1* asHist = dynamic_cast<TH1*>(inputObject.get()))
+        asHist->SetDirectory(0);
+    inputFile.Close();
+
+    if (const TGraph* asGraph = dynamic_cast<const TGraph*>(inputObject.get()))
+        return convert(*asGraph, graph);
+    if (const TSpline* asSpline = dynamic_cast<const TSpline*>(inputObject.get()))
+        return convert(*asSpline, graph);
+    if (const TH1* asHist = dynamic_cast<const TH1*>(inputObject.get()))
+        return convert(*asHist, graph);
+    std::cout << "Failed to convert the retrieved input to a curve \"" << graphName << "\" from the file: " << fileName << "\n";
+    return false;
+}
+
+bool RootHistoLoader::convert(const TGraph& graph, LoadedGraph& points) {
+    const int nPoints {graph.GetN()};
+    points.x.assign(graph.GetX(), graph.GetX() + nPoints);
+    points.y.assign(graph.GetY(), graph.GetY() + nPoints);
+    return true;
+}
+
+bool RootHistoLoader::convert(const TSpline& spline, LoadedGraph& points) {
+    points = LoadedGraph();
+    const TSpline3* cubic {dynamic_cast<const TSpline3*>(&spline)};
+    for (int i = 0; i < spline.GetNp(); ++i) {
+        double x, y;
+        if (cubic) {
+            double b, c, d;
+            cubic->GetCoeff(i, x, y, b, c, d);
+            points.b.push_back(b);
+            points.c.push_back(c);
+            points.d.push_back(d);
+        } else {
+            spline.GetKnot(i, x, y);
+        }
+        points.x.push_back(x);
+        points.y.push_back(y);
+    }
+    return true;
+}
+
+bool RootHistoLoader::convert(const TH1& hist, LoadedGraph& points) {
+    if (hist.GetDimension() != 1) {
+        std::cout << "Cannot read the histogram \"" << hist.GetName() << "\" of dimension " << hist.GetDimension() << " as a curve\n";
+        return false;
+    }
+    const TProfile* profile {dynamic_cast<const TProfile*>(&hist)};
+    points.x.clear();
+    points.y.clear();
+    for (int bin = 1; bin <= hist.GetNbinsX(); ++bin) {
+        if (profile && profile->GetBinEntries(bin) == 0)
+            continue;
+        points.x.push_back(hist.GetXaxis()->GetBinCenter(bin));
+        points.y.push_back(hist.GetBinContent(bin));
+    }
+    return true;
+}
+
+std::shared_ptr<const HistoTable> RootHistoLoader::compileHisto(const TH1& hist, const HistoCompression& compression) {
+    LoadedHisto histo;
+    if (!convert(hist, histo))
+        return nullptr;
+    return HistoTable::create(histo.binnings, histo.contents, compression);
+}
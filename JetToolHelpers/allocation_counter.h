@@ -0,0 +1,100 @@
+/**
+ * @file allocation_counter.h
+ * @author S. Schramm, A. Freeman
+ * @brief Counts the heap allocations of all the threads, to check that evaluating
+ * doesn't allocate once warmed up.
+ * @copyright Copyright (C) 2002-2022 CERN for the benefit of the ATLAS collaboration
+ *
+ * Defines the allocation functions of the program : include it in the file defining
+ * main() only, once per executable. With glibc, malloc, calloc, realloc and the aligned
+ * allocations are intercepted, which operator new goes through. Elsewhere the global
+ * operator new is replaced, but for its aligned overloads.
+ */
+
+#ifndef JET_ALLOCATION_COUNTER_H
+#define JET_ALLOCATION_COUNTER_H
+
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+class AllocationCounter {
+    public:
+        // Allocations made by the program so far
+        static std::uint64_t getTotal() { return s_total.load(std::memory_order_relaxed); }
+        static void add() { s_total.fetch_add(1, std::memory_order_relaxed); }
+
+        void start() { m_start = getTotal(); }
+
+        // Allocations made by any thread since start()
+        std::uint64_t getCount() const { return getTotal() - m_start; }
+
+    private:
+        static inline std::atomic<std::uint64_t> s_total {0};
+        std::uint64_t m_start {0};
+};
+
+#if defined(__GLIBC__)
+extern "C" {
+    void* __libc_malloc(std::size_t size);
+    void* __libc_calloc(std::size_t count, std::size_t size);
+    void* __libc_realloc(void* pointer, std::size_t size);
+    void* __libc_memalign(std::size_t alignment, std::size_t size);
+
+    void* malloc(std::size_t size) noexcept {
+        AllocationCounter::add();
+        return __libc_malloc(size);
+    }
+
+    void* calloc(std::size_t count, std::size_t size) noexcept {
+        AllocationCounter::add();
+        return __libc_calloc(count, size);
+    }
+
+    void* realloc(void* pointer, std::size_t size) noexcept {
+        AllocationCounter::add();
+        return __libc_realloc(pointer, size);
+    }
+
+    void* memalign(std::size_t alignment, std::size_t size) noexcept {
+        AllocationCounter::add();
+        return __libc_memalign(alignment, size);
+    }
+
+    void* aligned_alloc(std::size_t alignment, std::size_t size) noexcept {
+        return memalign(alignment, size);
+    }
+
+    int posix_memalign(void** pointer, std::size_t alignment, std::size_t size) noexcept {
+        if (alignment % sizeof(void*) != 0 || (alignment & (alignment - 1)) != 0)
+            return EINVAL;
+        void* allocated {memalign(alignment, size)};
+        if (!allocated)
+            return ENOMEM;
+        *pointer = allocated;
+        return 0;
+    }
+}
+#else
+void* operator new(std::size_t size) {
+    AllocationCounter::add();
+    if (void* pointer = std::malloc(size ? size : 1))
+        return pointer;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) { return operator new(size); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    AllocationCounter::add();
+    return std::malloc(size ? size : 1);
+}
+void* operator new[](std::size_t size, const std::nothrow_t& tag) noexcept { return operator new(size, tag); }
+void operator delete(void* pointer) noexcept { std::free(pointer); }
+void operator delete[](void* pointer) noexcept { std::free(pointer); }
+void operator delete(void* pointer, std::size_t) noexcept { std::free(pointer); }
+void operator delete[](void* pointer, std::size_t) noexcept { std::free(pointer); }
+#endif
+
+#endif
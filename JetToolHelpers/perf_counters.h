@@ -0,0 +1,125 @@
+/**
+ * @file perf_counters.h
+ * @author S. Schramm, A. Freeman
+ * @brief Hardware counters of the benchmark loops, read with Linux perf_event_open.
+ * @copyright Copyright (C) 2002-2022 CERN for the benefit of the ATLAS collaboration
+ *
+ * Enabled by setting JTH_PERF_COUNTERS=1 in the environment. The counters are then
+ * reported per lookup as user counters of the benchmarks. Counters the kernel or the
+ * machine doesn't provide (perf_event_paranoid, virtual machines...) are left out.
+ * The heap allocations per lookup are always reported, see allocation_counter.h.
+ */
+
+#ifndef JET_PERF_COUNTERS_H
+#define JET_PERF_COUNTERS_H
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <benchmark/benchmark.h>
+
+#include "allocation_counter.h"
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+class PerfCounters {
+    public:
+        PerfCounters() {
+            const char* enabled {std::getenv("JTH_PERF_COUNTERS")};
+            if (!enabled || std::string(enabled) == "0")
+                return;
+#if defined(__linux__)
+            const auto cache = [](const std::uint64_t cache, const std::uint64_t result) {
+                return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (result << 16);
+            };
+            open("cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+            open("instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+            open("branch-misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+            open("L1d-misses", PERF_TYPE_HW_CACHE, cache(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_RESULT_MISS));
+            open("LLC-misses", PERF_TYPE_HW_CACHE, cache(PERF_COUNT_HW_CACHE_LL, PERF_COUNT_HW_CACHE_RESULT_MISS));
+            open("dTLB-misses", PERF_TYPE_HW_CACHE, cache(PERF_COUNT_HW_CACHE_DTLB, PERF_COUNT_HW_CACHE_RESULT_MISS));
+#endif
+            if (m_counters.empty() && !s_warned) {
+                std::printf("No hardware counter available, reporting times only\n");
+                s_warned = true;
+            }
+        }
+
+        ~PerfCounters() {
+#if defined(__linux__)
+            for (const Counter& counter : m_counters)
+                close(counter.fd);
+#endif
+        }
+
+        PerfCounters(const PerfCounters&) = delete;
+        PerfCounters& operator=(const PerfCounters&) = delete;
+
+        // Just before the benchmark loop
+        void start() {
+            m_allocations.start();
+#if defined(__linux__)
+            for (const Counter& counter : m_counters) {
+                ioctl(counter.fd, PERF_EVENT_IOC_RESET, 0);
+                ioctl(counter.fd, PERF_EVENT_IOC_ENABLE, 0);
+            }
+#endif
+        }
+
+        /**
+         * @brief Just after the benchmark loop : stop counting and report each counter
+         * divided by the number of lookups, lookupsPerIteration per benchmark iteration.
+         */
+        void report(benchmark::State& state, const double lookupsPerIteration) {
+            const double nLookups {lookupsPerIteration * state.iterations()};
+            if (nLookups > 0)
+                state.counters["allocations/lookup"] = m_allocations.getCount() / nLookups;
+#if defined(__linux__)
+            for (const Counter& counter : m_counters) {
+                ioctl(counter.fd, PERF_EVENT_IOC_DISABLE, 0);
+                // value, time enabled, time running : scaled if the counters were multiplexed
+                std::uint64_t values[3] {0, 0, 0};
+                if (read(counter.fd, values, sizeof(values)) != sizeof(values) || values[2] == 0 || nLookups == 0)
+                    continue;
+                const double count {static_cast<double>(values[0]) * values[1] / values[2]};
+                state.counters[counter.name + "/lookup"] = count / nLookups;
+            }
+#endif
+        }
+
+    private:
+        struct Counter {
+            std::string name;
+            int fd;
+        };
+
+#if defined(__linux__)
+        void open(const std::string& name, const std::uint32_t type, const std::uint64_t config) {
+            perf_event_attr attr {};
+            attr.size = sizeof(attr);
+            attr.type = type;
+            attr.config = config;
+            attr.disabled = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            // This thread, on any CPU
+            const int fd = syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+            if (fd >= 0)
+                m_counters.push_back(Counter{name, fd});
+        }
+#endif
+
+        std::vector<Counter> m_counters;
+        AllocationCounter m_allocations;
+        static inline bool s_warned {false};
+};
+
+#endif
@@ -1,11 +1,30 @@
 #include <iostream>
+#include <cmath>
+#include <cstdlib>
 #include <random>
 #include <limits>
+#include <atomic>
+#include <thread>
 #include <benchmark/benchmark.h>
 
+#include "TFile.h"
+#include "TH2.h"
+#include "TProfile.h"
+#include "TH3.h"
+#include "TROOT.h"
+
 #include "JetToolHelpers/HistoInput.h"
+#include "JetToolHelpers/CompositeInput.h"
+#include "JetToolHelpers/HistoBundle.h"
+#include "JetToolHelpers/EventDriver.h"
+#include "JetToolHelpers/GraphInput.h"
+#include "JetToolHelpers/HistoCapture.h"
 #include "JetToolHelpers/InputVariable.h"
 #include "JetToolHelpers/Mock.h"
+#include "JetToolHelpers/NumaTopology.h"
+#include "JetToolHelpers/RootHistoLoader.h"
+#include "perf_counters.h"
+#include "synthetic_histograms.h"
 
 class JetFixture : public benchmark::Fixture {
     protected:
@@ -57,12 +76,15 @@ BENCHMARK_DEFINE_F(JetFixture, BM_getJetValueOver2DHistogram)(benchmark::State&
 
     JetContext jc;
     
+    PerfCounters counters;
+    counters.start();
     for(auto _: state) {
         for(auto& jet: jets) {
             double value{0};
             histogram.getValue(jet, jc, value);
         }
     }
+    counters.report(state, jets.size());
 }
 
 BENCHMARK_DEFINE_F(JetFixture, BM_getJetValueOver1DHistogram)(benchmark::State& state) {
@@ -74,12 +96,116 @@ BENCHMARK_DEFINE_F(JetFixture, BM_getJetValueOver1DHistogram)(benchmark::State&
 
     JetContext jc;
     // anything before the loop is not counted.
+    PerfCounters counters;
+    counters.start();
+    for(auto _: state) {
+        for(auto& jet: jets) {
+            double value{0};
+            histogram.getValue(jet, jc, value);
+        }
+    }
+    counters.report(state, jets.size());
+};
+
+// Same histograms evaluated from a surrogate, when one is found within 1e-3 of the interpolation
+void evaluateSurrogate(benchmark::State& state, const std::vector<xAOD::Jet>& jets, HistoInput& histogram) {
+    histogram.setSurrogate(1.e-3);
+    histogram.initialize();
+    state.counters["surrogate"] = histogram.getSurrogate() != nullptr;
+
+    JetContext jc;
+    PerfCounters counters;
+    counters.start();
+    for(auto _: state) {
+        for(auto& jet: jets) {
+            double value{0};
+            histogram.getValue(jet, jc, value);
+            benchmark::DoNotOptimize(value);
+        }
+    }
+    counters.report(state, jets.size());
+}
+
+BENCHMARK_DEFINE_F(JetFixture, BM_getJetValueOverSurrogate1DHistogram)(benchmark::State& state) {
+    HistoInput histogram("Test histogram", "./R4_AllComponents.root", "EffectiveNP_1_AntiKt4EMTopo", "pt", "float", true);
+    evaluateSurrogate(state, jets, histogram);
+}
+
+BENCHMARK_DEFINE_F(JetFixture, BM_getJetValueOverSurrogate2DHistogram)(benchmark::State& state) {
+    HistoInput histogram("Test histogram", "./R4_AllComponents.root", "EtaIntercalibration_Modelling_AntiKt4EMPFlow", "pt", "float", true, "abseta", "float", true);
+    evaluateSurrogate(state, jets, histogram);
+}
+
+// Value and gradient in one pass, to compare with the three getValue() of finite differences
+BENCHMARK_DEFINE_F(JetFixture, BM_getJetValueAndGradientOver2DHistogram)(benchmark::State& state) {
+    HistoInput histogram("Test histogram", "./R4_AllComponents.root", "EtaIntercalibration_Modelling_AntiKt4EMPFlow", "pt", "float", true, "abseta", "float", true);
+    histogram.initialize();
+
+    JetContext jc;
+    PerfCounters counters;
+    counters.start();
+    for(auto _: state) {
+        for(auto& jet: jets) {
+            double value{0};
+            double gradient[2];
+            histogram.getValueAndGradient(jet, jc, value, gradient);
+            benchmark::DoNotOptimize(gradient);
+        }
+    }
+    counters.report(state, jets.size());
+}
+
+// Evaluation must not slow down while another thread keeps reloading the histogram
+BENCHMARK_DEFINE_F(JetFixture, BM_getJetValueWhileReloading)(benchmark::State& state) {
+    ROOT::EnableThreadSafety();
+    HistoInput histogram("Test histogram", "./R4_AllComponents.root", "EffectiveNP_1_AntiKt4EMTopo", "pt", "float", true);
+    histogram.initialize();
+
+    std::atomic<bool> stop{false};
+    std::atomic<long> nReloads{0};
+    std::thread reloader([&]() {
+        while (!stop.load() && histogram.reload())
+            ++nReloads;
+    });
+
+    JetContext jc;
+    PerfCounters counters;
+    counters.start();
     for(auto _: state) {
         for(auto& jet: jets) {
             double value{0};
             histogram.getValue(jet, jc, value);
+            benchmark::DoNotOptimize(value);
         }
     }
+    counters.report(state, jets.size());
+    stop.store(true);
+    reloader.join();
+    state.counters["reloads"] = nReloads.load();
+}
+
+BENCHMARK_DEFINE_F(JetFixture, BM_getJetAttributeValueOver1DHistogram)(benchmark::State& state) {
+    std::string fileName("./R4_AllComponents.root");
+    std::string histName1D("EffectiveNP_1_AntiKt4EMTopo");
+
+    // generic attribute holding the same value as pt, to compare with BM_getJetValueOver1DHistogram
+    SG::AuxElement::Accessor<float> ptAttribute("ptAttribute");
+    for(auto& jet: jets)
+        ptAttribute.set(jet, jet.pt());
+
+    HistoInput histogram = HistoInput("Test histogram", fileName, histName1D, "ptAttribute", "float", true);
+    histogram.initialize();
+
+    JetContext jc;
+    PerfCounters counters;
+    counters.start();
+    for(auto _: state) {
+        for(auto& jet: jets) {
+            double value{0};
+            histogram.getValue(jet, jc, value);
+        }
+    }
+    counters.report(state, jets.size());
 };
 
 BENCHMARK_DEFINE_F(JetContextFixture, BM_getJetContextValueOver1DHistogram)(benchmark::State& state) {
@@ -91,12 +217,15 @@ BENCHMARK_DEFINE_F(JetContextFixture, BM_getJetContextValueOver1DHistogram)(benc
 
     xAOD::Jet jet{5, 5, 5, 5};
     // anything before the loop is not counted.
+    PerfCounters counters;
+    counters.start();
     for(auto _: state) {
         for(auto& jc: events) {
             double value{0};
             histogram.getValue(jet, jc, value);
         }
     }
+    counters.report(state, events.size());
 };
 
 BENCHMARK_DEFINE_F(JetContextFixture, BM_getJetContextValueOver2DHistogram)(benchmark::State& state) {
@@ -109,17 +238,667 @@ BENCHMARK_DEFINE_F(JetContextFixture, BM_getJetContextValueOver2DHistogram)(benc
 
     xAOD::Jet jet{5, 5, 5, 5};
     // anything before the loop is not counted.
+    PerfCounters counters;
+    counters.start();
     for(auto _: state) {
         for(auto& jc: events) {
             double value{0};
             histogram.getValue(jet, jc, value);
         }
     }
+    counters.report(state, events.size());
+}
+
+// Filling and reading the context of every event, as an event loop does
+void fillEventContext(JetContext& jc, const int event) {
+    jc.setValue("averageInteractionsPerCrossing", 30.f + event % 7);
+    jc.setValue("actualInteractionsPerCrossing", 31.f + event % 5);
+    jc.setValue("NPV", 20 + event % 11);
+    jc.setValue("rho", 12.5f);
+    jc.setValue("eventNumber", event);
+}
+
+float readEventContext(const JetContext& jc) {
+    return jc.getValue<float>("averageInteractionsPerCrossing") + jc.getValue<int>("NPV") 
+        + (jc.isAvailable("rho") ? jc.getValue<float>("rho") : 0.f);
+}
+
+static void BM_newJetContextPerEvent(benchmark::State& state) {
+    int event{0};
+    PerfCounters counters;
+    counters.start();
+    for(auto _: state) {
+        JetContext jc;
+        fillEventContext(jc, event++);
+        benchmark::DoNotOptimize(readEventContext(jc));
+    }
+    counters.report(state, 1);
+}
+
+static void BM_reusedJetContextPerEvent(benchmark::State& state) {
+    int event{0};
+    JetContext jc;
+    PerfCounters counters;
+    counters.start();
+    for(auto _: state) {
+        jc.clear();
+        fillEventContext(jc, event++);
+        benchmark::DoNotOptimize(readEventContext(jc));
+    }
+    counters.report(state, 1);
+}
+
+// A tool evaluates many inputs per jet, e.g. all the uncertainty components of a jet collection
+std::vector<std::unique_ptr<HistoInput>> makeManyInputs(const int nInputs, const HistoCompression& compression = HistoCompression(),
+    const HistoTuning* tuning = nullptr) {
+    std::string fileName("./R4_AllComponents.root");
+    std::string histName1D("EffectiveNP_1_AntiKt4EMTopo");
+    std::string histName2D("EtaIntercalibration_Modelling_AntiKt4EMPFlow");
+
+    std::vector<std::unique_ptr<HistoInput>> inputs;
+    for(int i=0; i < nInputs; i++) {
+        if (i % 2)
+            inputs.push_back(std::make_unique<HistoInput>("Test histogram", fileName, histName1D, "pt", "float", true));
+        else
+            inputs.push_back(std::make_unique<HistoInput>("Test histogram", fileName, histName2D, "pt", "float", true, "abseta", "float", true));
+        inputs.back()->setCompression(compression);
+        if (tuning)
+            inputs.back()->setTuning(*tuning);
+        inputs.back()->initialize();
+    }
+    return inputs;
+}
+
+void evaluateManyInputs(benchmark::State& state, const std::vector<xAOD::Jet>& jets, const std::vector<std::unique_ptr<HistoInput>>& inputs) {
+    JetContext jc;
+    PerfCounters counters;
+    counters.start();
+    for(auto _: state) {
+        for(auto& jet: jets) {
+            for(auto& input: inputs) {
+                double value{0};
+                input->getValue(jet, jc, value);
+                benchmark::DoNotOptimize(value);
+            }
+        }
+    }
+    counters.report(state, jets.size() * inputs.size());
+    state.SetItemsProcessed(state.iterations() * jets.size() * inputs.size());
+}
+
+BENCHMARK_DEFINE_F(JetFixture, BM_getJetValueOverManyInputs)(benchmark::State& state) {
+    auto inputs = makeManyInputs(state.range(1));
+    evaluateManyInputs(state, jets, inputs);
+}
+
+BENCHMARK_DEFINE_F(JetFixture, BM_getJetValueOverBundledInputs)(benchmark::State& state) {
+    auto inputs = makeManyInputs(state.range(1));
+    std::vector<HistoInput*> order;
+    for(auto& input: inputs)
+        order.push_back(input.get());
+    auto bundle = HistoBundle::create(order);
+    evaluateManyInputs(state, jets, inputs);
+}
+
+// Compressed tables of identical histograms share their contents
+BENCHMARK_DEFINE_F(JetFixture, BM_getJetValueOverCompressedInputs)(benchmark::State& state) {
+    auto inputs = makeManyInputs(state.range(1), HistoCompression{true, 0.});
+    evaluateManyInputs(state, jets, inputs);
+}
+
+// Each input evaluates the fastest exact kernel, tuned once and then read from the cache
+BENCHMARK_DEFINE_F(JetFixture, BM_getJetValueOverTunedInputs)(benchmark::State& state) {
+    HistoTuning tuning;
+    tuning.cacheFile = "./tuning.cache";
+    auto inputs = makeManyInputs(state.range(1), HistoCompression(), &tuning);
+    evaluateManyInputs(state, jets, inputs);
+}
+
+// Systematics : jets in the histogram range, shifted by +-1%, +-2%... of their pt
+// Product of 4 maps with the same binning : each one evaluated by the caller (0), by a
+// composite input reading the variables and searching the bin once (1) or folded into a
+// single table (2), which any folding tolerance allows for.
+BENCHMARK_DEFINE_F(JetFixture, BM_getJetValueOverComposite)(benchmark::State& state) {
+    const int mode = state.range(1);
+    std::vector<std::unique_ptr<IInputBase>> children, separate;
+    for (int i = 0; i < 4; i++) {
+        for (auto* inputs : {&children, &separate})
+            inputs->push_back(std::make_unique<HistoInput>("Test histogram", "./R4_AllComponents.root",
+                "EtaIntercalibration_Modelling_AntiKt4EMPFlow", "pt", "float", true, "abseta", "float", true));
+        separate.back()->initialize();
+    }
+    CompositeInput composite("Test composite", CompositeOperation::Product, std::move(children));
+    if (mode == 2)
+        composite.setFoldingTolerance(std::numeric_limits<double>::max());
+    composite.initialize();
+
+    JetContext jc;
+    PerfCounters counters;
+    counters.start();
+    for(auto _: state) {
+        for(auto& jet: jets) {
+            double value{1};
+            if (mode == 0) {
+                for (const std::unique_ptr<IInputBase>& child : separate) {
+                    double childValue{0};
+                    child->getValue(jet, jc, childValue);
+                    value *= childValue;
+                }
+            } else {
+                composite.getValue(jet, jc, value);
+            }
+            benchmark::DoNotOptimize(value);
+        }
+    }
+    counters.report(state, jets.size());
+}
+
+std::vector<HistoShift> makePtShifts(const int nShifts) {
+    std::vector<HistoShift> shifts;
+    for(int i=0; i < nShifts; i++) {
+        const double delta {0.01 * (i/2 + 1) * (i % 2 ? -1 : 1)};
+        shifts.push_back(HistoShift{{1 + delta, 1}, {0, 0}});
+    }
+    return shifts;
+}
+
+std::vector<xAOD::Jet> makeCalibratedJets(const int nJets) {
+    std::mt19937 gen(43294);
+    std::uniform_real_distribution<double> pt(20, 2500);
+    std::uniform_real_distribution<double> eta(-4.5, 4.5);
+    std::vector<xAOD::Jet> jets;
+    for(int i=0; i < nJets; i++)
+        jets.push_back(xAOD::Jet{pt(gen), eta(gen), 0., 10.});
+    return jets;
+}
+
+// One getValue() per variation, on a shifted copy of the jet
+static void BM_getShiftedJetValues(benchmark::State& state) {
+    HistoInput histogram("Test histogram", "./R4_AllComponents.root", "EtaIntercalibration_Modelling_AntiKt4EMPFlow", "pt", "float", true, "abseta", "float", true);
+    histogram.initialize();
+    const auto jets = makeCalibratedJets(1000);
+    const auto shifts = makePtShifts(state.range(0));
+
+    JetContext jc;
+    PerfCounters counters;
+    counters.start();
+    for(auto _: state) {
+        for(auto& jet: jets) {
+            double value{0};
+            histogram.getValue(jet, jc, value);
+            benchmark::DoNotOptimize(value);
+            for(auto& shift: shifts) {
+                const xAOD::Jet shifted {jet.pt() * shift.scales[0], jet.eta(), jet.phi(), jet.m()};
+                histogram.getValue(shifted, jc, value);
+                benchmark::DoNotOptimize(value);
+            }
+        }
+    }
+    counters.report(state, jets.size() * (shifts.size() + 1));
+    state.SetItemsProcessed(state.iterations() * jets.size() * (shifts.size() + 1));
+}
+
+static void BM_getJetVariations(benchmark::State& state) {
+    HistoInput histogram("Test histogram", "./R4_AllComponents.root", "EtaIntercalibration_Modelling_AntiKt4EMPFlow", "pt", "float", true, "abseta", "float", true);
+    histogram.initialize();
+    const auto jets = makeCalibratedJets(1000);
+    const auto shifts = makePtShifts(state.range(0));
+
+    JetContext jc;
+    std::vector<double> values(shifts.size() + 1);
+    PerfCounters counters;
+    counters.start();
+    for(auto _: state) {
+        for(auto& jet: jets) {
+            histogram.getVariations(jet, jc, shifts.data(), shifts.size(), values.data());
+            benchmark::DoNotOptimize(values.data());
+        }
+    }
+    counters.report(state, jets.size() * (shifts.size() + 1));
+    state.SetItemsProcessed(state.iterations() * jets.size() * (shifts.size() + 1));
+}
+
+// A 1000x1000 map, 8 MB of contents
+void writeLargeMap() {
+    TFile file("./large_map.root", "RECREATE");
+    TH2D hist("large_map", "", 1000, 20, 5000, 1000, 0, 4.5);
+    for (int i = 1; i <= 1000; i++)
+        for (int j = 1; j <= 1000; j++)
+            hist.SetBinContent(i, j, 1 + 1e-3*i + 1e-6*j);
+    file.WriteTObject(&hist);
+    file.Close();
+}
+
+// Columnar reprocessing : batches of random points over a large map, evaluated in order (0)
+// or cell by cell (1). Shows from which batch size sorting pays off.
+static void BM_getValuesOverLargeMap(benchmark::State& state) {
+    const std::size_t nValues = state.range(0);
+    const bool coherent = state.range(1);
+    writeLargeMap();
+    HistoInput histogram("Test histogram", "./large_map.root", "large_map", "pt", "float", true, "abseta", "float", true);
+    if (coherent)
+        histogram.setCoherentBatches(1, 0);
+    histogram.initialize();
+
+    std::mt19937 gen(43294);
+    std::uniform_real_distribution<float> pt(20, 5000);
+    std::uniform_real_distribution<float> abseta(0, 4.5);
+    std::vector<float> pts(nValues), absetas(nValues);
+    for (std::size_t i = 0; i < nValues; i++) {
+        pts[i] = pt(gen);
+        absetas[i] = abseta(gen);
+    }
+    std::vector<double> values(nValues);
+
+    PerfCounters counters;
+    counters.start();
+    for(auto _: state) {
+        histogram.getValues(pts.data(), absetas.data(), values.data(), nValues);
+        benchmark::DoNotOptimize(values.data());
+    }
+    counters.report(state, nValues);
+    state.SetItemsProcessed(state.iterations() * nValues);
+}
+
+// Synthetic histogram of the shape given by the benchmark arguments : dimension, binning
+// (see SyntheticBinning) and bins in total
+void writeSyntheticHistogram(const benchmark::State& state) {
+    const SyntheticBinning binning = static_cast<SyntheticBinning>(state.range(1));
+    TFile file("./synthetic.root", "RECREATE");
+    file.WriteTObject(makeSyntheticHistogram("synthetic", state.range(0), state.range(2), binning).get());
+    file.Close();
+}
+
+std::unique_ptr<HistoInput> makeSyntheticInput(const int nDims) {
+    if (nDims == 1)
+        return std::make_unique<HistoInput>("Test histogram", "./synthetic.root", "synthetic", "pt", "float", true);
+    return std::make_unique<HistoInput>("Test histogram", "./synthetic.root", "synthetic", "pt", "float", true,
+        "abseta", "float", true);
+}
+
+// Reading and compiling a synthetic histogram, per shape. HistoInput doesn't compile 3D
+// histograms, they are only read, as the ROOT lookup of 3D maps needs.
+static void BM_initializeSyntheticHistogram(benchmark::State& state) {
+    writeSyntheticHistogram(state);
+    std::size_t bytes {0};
+    if (state.range(0) == 3) {
+        for(auto _: state) {
+            std::unique_ptr<TH1> hist;
+            if (!RootHistoLoader::readHistoFromFile(hist, "./synthetic.root", "synthetic")) {
+                state.SkipWithError("The histogram cannot be read");
+                return;
+            }
+            bytes = hist->GetNcells() * sizeof(double);
+        }
+        state.counters["bytes"] = bytes;
+        return;
+    }
+    for(auto _: state) {
+        std::unique_ptr<HistoInput> histogram {makeSyntheticInput(state.range(0))};
+        if (!histogram->initialize()) {
+            state.SkipWithError("The histogram cannot be compiled");
+            return;
+        }
+        bytes = histogram->getMemoryUsage();
+    }
+    state.counters["bytes"] = bytes;
+}
+
+// Batches of random points over a synthetic histogram, per shape. The counters per lookup
+// tell what makes the large and the variable binnings expensive. 3D histograms are
+// evaluated with TH3::Interpolate, on points between their first and last bin centers.
+static void BM_getValuesOverSyntheticHistogram(benchmark::State& state) {
+    const int nDims = state.range(0);
+    writeSyntheticHistogram(state);
+    std::unique_ptr<HistoInput> histogram;
+    std::unique_ptr<TH1> hist;
+    if (nDims == 3) {
+        if (!RootHistoLoader::readHistoFromFile(hist, "./synthetic.root", "synthetic")) {
+            state.SkipWithError("The histogram cannot be read");
+            return;
+        }
+        state.counters["bytes"] = hist->GetNcells() * sizeof(double);
+    } else {
+        histogram = makeSyntheticInput(nDims);
+        if (!histogram->initialize()) {
+            state.SkipWithError("The histogram cannot be compiled");
+            return;
+        }
+        state.counters["bytes"] = histogram->getMemoryUsage();
+    }
+
+    const std::size_t nValues {4096};
+    std::mt19937 gen(43294);
+    std::uniform_real_distribution<float> pt(SYNTHETICRANGES[0][0], SYNTHETICRANGES[0][1]);
+    std::uniform_real_distribution<float> abseta(SYNTHETICRANGES[1][0], SYNTHETICRANGES[1][1]);
+    std::uniform_real_distribution<float> mOverPt(SYNTHETICRANGES[2][0], SYNTHETICRANGES[2][1]);
+    if (nDims == 3) {
+        // TH3::Interpolate fails outside of the box of the first and last bin centers
+        auto centers = [](const TAxis& axis) {
+            return std::uniform_real_distribution<float>(axis.GetBinCenter(1), axis.GetBinCenter(axis.GetNbins()));
+        };
+        pt = centers(*hist->GetXaxis());
+        abseta = centers(*hist->GetYaxis());
+        mOverPt = centers(*hist->GetZaxis());
+    }
+    std::vector<float> pts(nValues), absetas(nValues), mOverPts(nValues);
+    for (std::size_t i = 0; i < nValues; i++) {
+        pts[i] = pt(gen);
+        absetas[i] = abseta(gen);
+        mOverPts[i] = mOverPt(gen);
+    }
+    std::vector<double> values(nValues);
+
+    PerfCounters counters;
+    counters.start();
+    for(auto _: state) {
+        if (nDims == 1) {
+            histogram->getValues(pts.data(), values.data(), nValues);
+        } else if (nDims == 2) {
+            histogram->getValues(pts.data(), absetas.data(), values.data(), nValues);
+        } else {
+            for (std::size_t i = 0; i < nValues; i++)
+                values[i] = RootHistoLoader::readFromHisto(*hist, RootHistoLoader::enforceAxisRange(*hist->GetXaxis(), pts[i]),
+                    RootHistoLoader::enforceAxisRange(*hist->GetYaxis(), absetas[i]),
+                    RootHistoLoader::enforceAxisRange(*hist->GetZaxis(), mOverPts[i]));
+        }
+        benchmark::DoNotOptimize(values.data());
+    }
+    counters.report(state, nValues);
+    state.SetItemsProcessed(state.iterations() * nValues);
+}
+
+// A response profile of nBins bins
+void writeProfile(const int nBins) {
+    TFile file("./profile.root", "RECREATE");
+    TProfile profile("response", "", nBins, 20, 5000);
+    for (int i = 0; i < 20 * nBins; i++) {
+        const double pt {20 + (i + 0.5) * 4980. / (20 * nBins)};
+        profile.Fill(pt, 1 + 0.1*std::log(pt));
+    }
+    file.WriteTObject(&profile);
+    file.Close();
+}
+
+// Batches of pts over a profile of 100 or 10000 bins, evaluated as a histogram (0) or as a
+// curve, linear (1) or monotone cubic (2)
+static void BM_getValuesOverProfile(benchmark::State& state) {
+    const int nBins = state.range(0);
+    const int kind = state.range(1);
+    writeProfile(nBins);
+    HistoInput histogram("Test histogram", "./profile.root", "response", "pt", "float", true);
+    GraphInput curve("Test curve", "./profile.root", "response", "pt", "float", true,
+        kind == 2 ? GraphInterpolation::MonotoneCubic : GraphInterpolation::Linear);
+    if (kind == 0)
+        histogram.initialize();
+    else
+        curve.initialize();
+
+    const std::size_t nValues {10000};
+    std::mt19937 gen(43294);
+    std::uniform_real_distribution<float> pt(20, 5000);
+    std::vector<float> pts(nValues);
+    for (float& value : pts)
+        value = pt(gen);
+    std::vector<double> values(nValues);
+
+    for(auto _: state) {
+        if (kind == 0)
+            histogram.getValues(pts.data(), values.data(), nValues);
+        else
+            curve.getValues(pts.data(), values.data(), nValues);
+        benchmark::DoNotOptimize(values.data());
+    }
+    state.SetItemsProcessed(state.iterations() * nValues);
+}
+
+// Numerical inversion of a monotone response : bisection over getValue() (0), as a
+// calibration step would do it, or the inverse built at initialize() (1)
+static void BM_invertResponse(benchmark::State& state) {
+    const bool inverse = state.range(0);
+    {
+        TFile file("./response.root", "RECREATE");
+        TH1D hist("response", "", 200, 20, 5000);
+        for (int i = 1; i <= 200; i++)
+            hist.SetBinContent(i, 0.8 + 0.1*std::log(i));
+        file.WriteTObject(&hist);
+        file.Close();
+    }
+    HistoInput response("Test response", "./response.root", "response", "pt", "float", true);
+    response.setInverse(inverse);
+    response.initialize();
+
+    const std::size_t nValues {1000};
+    std::mt19937 gen(43294);
+    std::uniform_real_distribution<double> dist(0.85, 1.3);
+    std::vector<double> targets(nValues), pts(nValues);
+    for (double& target : targets)
+        target = dist(gen);
+
+    for(auto _: state) {
+        if (inverse) {
+            response.getInverses(targets.data(), pts.data(), nValues);
+        } else {
+            for (std::size_t i = 0; i < nValues; i++) {
+                double low {20}, high {5000};
+                for (int iteration = 0; iteration < 30; iteration++) {
+                    const double middle {0.5 * (low + high)};
+                    double value {0};
+                    response.getValues(&middle, &value, 1);
+                    (value < targets[i] ? low : high) = middle;
+                }
+                pts[i] = 0.5 * (low + high);
+            }
+        }
+        benchmark::DoNotOptimize(pts.data());
+    }
+    state.SetItemsProcessed(state.iterations() * nValues);
+}
+
+// Random lookups over 4 large maps (32 MB) bundled on normal (0), transparent huge (1) or
+// explicit huge (2) pages, with one replica (1) or one per NUMA node (0) read by threads on
+// every node. The dTLB counters show the effect of the pages.
+static void BM_getValuesOverBundledLargeMaps(benchmark::State& state) {
+    const HistoPages pages = static_cast<HistoPages>(state.range(0));
+    const int nReplicas = state.range(1);
+    writeLargeMap();
+    std::vector<std::unique_ptr<HistoInput>> inputs;
+    std::vector<HistoInput*> order;
+    for (int i = 0; i < 4; i++) {
+        inputs.push_back(std::make_unique<HistoInput>("Test histogram", "./large_map.root", "large_map", "pt", "float", true, "abseta", "float", true));
+        inputs.back()->initialize();
+        order.push_back(inputs.back().get());
+    }
+    auto bundle = HistoBundle::create(order, HistoBundleOptions{pages, nReplicas});
+    if (!bundle) {
+        state.SkipWithError("Failed to bundle the maps");
+        return;
+    }
+    state.counters["replicas"] = bundle->getNumReplicas();
+    state.counters["hugePages"] = bundle->getPages() != HistoPages::Normal;
+
+    const std::size_t nValues {4096};
+    std::mt19937 gen(43294);
+    std::uniform_real_distribution<float> pt(20, 5000);
+    std::uniform_real_distribution<float> abseta(0, 4.5);
+    std::vector<float> pts(nValues), absetas(nValues);
+    for (std::size_t i = 0; i < nValues; i++) {
+        pts[i] = pt(gen);
+        absetas[i] = abseta(gen);
+    }
+
+    auto evaluate = [&]() {
+        std::vector<double> values(nValues);
+        for (auto& input: inputs) {
+            input->getValues(pts.data(), absetas.data(), values.data(), nValues);
+            benchmark::DoNotOptimize(values.data());
+        }
+    };
+
+    // One thread per node evaluating the same batches, the calling thread on a single node
+    const int nNodes {NumaTopology::getNumNodes()};
+    PerfCounters counters;
+    counters.start();
+    for(auto _: state) {
+        if (nNodes == 1) {
+            evaluate();
+            continue;
+        }
+        std::vector<std::thread> threads;
+        for (int node = 0; node < nNodes; node++)
+            threads.emplace_back([&, node]() { NumaTopology::runOnNode(node, evaluate); });
+        for (std::thread& thread: threads)
+            thread.join();
+    }
+    counters.report(state, nNodes * nValues * inputs.size());
+    state.SetItemsProcessed(state.iterations() * nNodes * nValues * inputs.size());
+}
+
+// The capture given in JTH_CAPTURE, recorded in a job (see HistoCapture.h), or else one
+// recorded here from a falling pt spectrum and central jets
+std::vector<CapturedStream> loadCapture() {
+    std::vector<CapturedStream> streams;
+    if (const char* fileName = std::getenv("JTH_CAPTURE")) {
+        if (!HistoCapture::read(fileName, streams))
+            streams.clear();
+        return streams;
+    }
+
+    std::shared_ptr<HistoCapture> capture {HistoCapture::create("./replay.jthc")};
+    HistoInput np1("np1", "./R4_AllComponents.root", "EffectiveNP_1_AntiKt4EMTopo", "pt", "float", true);
+    HistoInput modelling("modelling", "./R4_AllComponents.root", "EtaIntercalibration_Modelling_AntiKt4EMPFlow",
+        "pt", "float", true, "abseta", "float", true);
+    for (HistoInput* input : {&np1, &modelling}) {
+        input->initialize();
+        input->setCapture(capture);
+    }
+    std::mt19937 gen(43294);
+    std::exponential_distribution<double> pt(1. / 80);
+    std::normal_distribution<double> eta(0, 1.5);
+    JetContext jc;
+    double value;
+    for (int i = 0; i < 100000; i++) {
+        const xAOD::Jet jet {20 + pt(gen), eta(gen), 0, 10};
+        np1.getValue(jet, jc, value);
+        modelling.getValue(jet, jc, value);
+    }
+    capture->close();
+    HistoCapture::read("./replay.jthc", streams);
+    return streams;
+}
+
+// Replays the recorded axis values of every input through getValue() (0) or getValues() (1)
+static void BM_replayCapture(benchmark::State& state) {
+    const bool batched = state.range(0);
+    const std::vector<CapturedStream> streams {loadCapture()};
+    if (streams.empty()) {
+        state.SkipWithError("No capture to replay");
+        return;
+    }
+
+    // The values are those of the axes, whatever variables the job read them from
+    std::vector<std::unique_ptr<HistoInput>> inputs;
+    std::vector<std::vector<xAOD::Jet>> jets(streams.size());
+    std::size_t nValues {0};
+    for (std::size_t i = 0; i < streams.size(); i++) {
+        const CapturedStream& stream {streams[i]};
+        if (stream.nDims == 1)
+            inputs.push_back(std::make_unique<HistoInput>(stream.name, stream.fileName, stream.histName, "pt", "float", true));
+        else
+            inputs.push_back(std::make_unique<HistoInput>(stream.name, stream.fileName, stream.histName,
+                "pt", "float", true, "eta", "float", true));
+        if (!inputs.back()->initialize()) {
+            state.SkipWithError("Failed to initialize a replayed input");
+            return;
+        }
+        for (std::size_t j = 0; j < stream.x.size(); j++)
+            jets[i].push_back(xAOD::Jet{stream.x[j], stream.nDims > 1 ? stream.y[j] : 0.f, 0, 10});
+        nValues += stream.x.size();
+    }
+    std::vector<double> values;
+
+    JetContext jc;
+    PerfCounters counters;
+    counters.start();
+    for(auto _: state) {
+        for (std::size_t i = 0; i < streams.size(); i++) {
+            const CapturedStream& stream {streams[i]};
+            if (batched) {
+                values.resize(stream.x.size());
+                if (stream.nDims == 1)
+                    inputs[i]->getValues(stream.x.data(), values.data(), stream.x.size());
+                else
+                    inputs[i]->getValues(stream.x.data(), stream.y.data(), values.data(), stream.x.size());
+                benchmark::DoNotOptimize(values.data());
+            } else {
+                for (const xAOD::Jet& jet : jets[i]) {
+                    double value {0};
+                    inputs[i]->getValue(jet, jc, value);
+                    benchmark::DoNotOptimize(value);
+                }
+            }
+        }
+    }
+    counters.report(state, nValues);
+    state.SetItemsProcessed(state.iterations() * nValues);
+}
+
+// Offline reprocessing : events of very different sizes, the scaling curve over threads
+static void BM_evaluateEventsInParallel(benchmark::State& state) {
+    auto inputs = makeManyInputs(10);
+    std::vector<const IInputBase*> order;
+    for(auto& input: inputs)
+        order.push_back(input.get());
+
+    std::mt19937 gen( 43294 );
+    std::uniform_real_distribution< double > dist( -10000, 10000 );
+    std::geometric_distribution<int> multiplicity(0.2);
+    const int N_EVENTS = 20000;
+    std::vector<std::vector<xAOD::Jet>> jets(N_EVENTS);
+    std::vector<JetContext> contexts(N_EVENTS);
+    std::vector<EventDriver::Event> events;
+    std::size_t nJets{0};
+    for(int i=0; i < N_EVENTS; i++) {
+        const int n = i % 1000 == 0 ? 1000 : multiplicity(gen);    // a few very busy events
+        for(int j=0; j < n; j++)
+            jets[i].push_back(xAOD::Jet{dist(gen), dist(gen), dist(gen), dist(gen)});
+        events.push_back(EventDriver::Event{jets[i].data(), jets[i].size(), &contexts[i]});
+        nJets += n;
+    }
+
+    EventDriver driver(state.range(0));
+    std::vector<double> values;
+    for(auto _: state)
+        driver.evaluate(events, order, values);
+    state.SetItemsProcessed(state.iterations() * nJets * inputs.size());
 }
 
 BENCHMARK_REGISTER_F(JetFixture, BM_getJetValueOver1DHistogram)->RangeMultiplier(2)->Range(100, 10<<5);
 BENCHMARK_REGISTER_F(JetFixture, BM_getJetValueOver2DHistogram)->RangeMultiplier(2)->Range(100, 10<<5);
+BENCHMARK_REGISTER_F(JetFixture, BM_getJetValueOverSurrogate1DHistogram)->RangeMultiplier(2)->Range(100, 10<<5);
+BENCHMARK_REGISTER_F(JetFixture, BM_getJetValueOverSurrogate2DHistogram)->RangeMultiplier(2)->Range(100, 10<<5);
+BENCHMARK_REGISTER_F(JetFixture, BM_getJetValueAndGradientOver2DHistogram)->RangeMultiplier(2)->Range(100, 10<<5);
+BENCHMARK_REGISTER_F(JetFixture, BM_getJetValueWhileReloading)->RangeMultiplier(2)->Range(100, 10<<5);
+BENCHMARK_REGISTER_F(JetFixture, BM_getJetAttributeValueOver1DHistogram)->RangeMultiplier(2)->Range(100, 10<<5);
 BENCHMARK_REGISTER_F(JetContextFixture, BM_getJetContextValueOver1DHistogram)->RangeMultiplier(2)->Range(100, 10<<5);
 BENCHMARK_REGISTER_F(JetContextFixture, BM_getJetContextValueOver2DHistogram)->RangeMultiplier(2)->Range(100, 10<<5);
 
+BENCHMARK(BM_newJetContextPerEvent);
+BENCHMARK(BM_reusedJetContextPerEvent);
+BENCHMARK_REGISTER_F(JetFixture, BM_getJetValueOverManyInputs)->ArgsProduct({{1000}, {10, 100}});
+BENCHMARK_REGISTER_F(JetFixture, BM_getJetValueOverBundledInputs)->ArgsProduct({{1000}, {10, 100}});
+BENCHMARK_REGISTER_F(JetFixture, BM_getJetValueOverCompressedInputs)->ArgsProduct({{1000}, {10, 100}});
+BENCHMARK_REGISTER_F(JetFixture, BM_getJetValueOverTunedInputs)->ArgsProduct({{1000}, {10, 100}});
+BENCHMARK_REGISTER_F(JetFixture, BM_getJetValueOverComposite)->ArgsProduct({{1000}, {0, 1, 2}});
+BENCHMARK(BM_getShiftedJetValues)->Arg(10)->Arg(50);
+BENCHMARK(BM_getJetVariations)->Arg(10)->Arg(50);
+BENCHMARK(BM_getValuesOverLargeMap)->ArgsProduct({benchmark::CreateRange(64, 1<<20, 4), {0, 1}});
+BENCHMARK(BM_initializeSyntheticHistogram)->ArgsProduct({{1, 2, 3}, {0, 1, 2}, benchmark::CreateRange(10, 1000000, 10)});
+BENCHMARK(BM_getValuesOverSyntheticHistogram)->ArgsProduct({{1, 2, 3}, {0, 1, 2}, benchmark::CreateRange(10, 1000000, 10)});
+BENCHMARK(BM_getValuesOverProfile)->ArgsProduct({{100, 10000}, {0, 1, 2}});
+BENCHMARK(BM_invertResponse)->Arg(0)->Arg(1);
+BENCHMARK(BM_getValuesOverBundledLargeMaps)->ArgsProduct({{0, 1, 2}, {1, 0}})->UseRealTime();
+BENCHMARK(BM_replayCapture)->Arg(0)->Arg(1);
+BENCHMARK(BM_evaluateEventsInParallel)->RangeMultiplier(2)->Range(1, 64)->UseRealTime();
+
 BENCHMARK_MAIN();
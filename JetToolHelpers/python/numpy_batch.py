@@ -0,0 +1,100 @@
+"""
+Zero-copy evaluation of a HistoInput over NumPy arrays through PyROOT.
+
+HistoInput.getValues() takes raw pointers, which PyROOT maps onto the buffer
+of a NumPy array without copying it. The helpers below only check that the
+arrays can be handed over as they are and pick the right overload, the loop
+over the jets then runs entirely in C++.
+
+    import numpy as np
+    from numpy_batch import evaluate, evaluate_fields
+
+    pt = np.asarray(tree["jet_pt"], dtype=np.float32)
+    values = evaluate(myH1D, pt)
+
+    jets = np.zeros(n, dtype=[("pt", "f8"), ("abseta", "f8"), ("phi", "f8")])
+    values = evaluate_fields(myH2D, jets, ("pt", "abseta"))
+
+Nothing is converted behind the caller's back: an array with the wrong dtype
+or memory layout raises a ValueError instead of being silently copied.
+"""
+
+import numpy as np
+
+SUPPORTED_DTYPES = (np.dtype(np.float32), np.dtype(np.float64))
+
+
+def _output(out, n):
+    if out is None:
+        return np.empty(n, dtype=np.float64)
+    if out.dtype != np.float64 or out.ndim != 1 or not out.flags.c_contiguous or not out.flags.writeable:
+        raise ValueError("The output must be a writeable, contiguous 1D float64 array")
+    if len(out) < n:
+        raise ValueError("The output array holds %d values but %d are needed" % (len(out), n))
+    return out
+
+
+def _call(histo, axes, out, n, stride):
+    ok = histo.getValues(*axes, out, n, stride)
+    if not ok:
+        raise RuntimeError("HistoInput.getValues() failed, check that the histogram is initialized "
+                           "and that one array is given per axis")
+    return out
+
+
+def evaluate(histo, x, y=None, out=None):
+    """
+    Evaluate histo for every entry of the axis value arrays x (and y for 2D histograms).
+
+    The arrays must be 1D, C-contiguous and share a float32 or float64 dtype.
+    The results are written to out (float64) which is allocated if not provided.
+    """
+    axes = [x] if y is None else [x, y]
+    for axis in axes:
+        if not isinstance(axis, np.ndarray) or axis.ndim != 1 or not axis.flags.c_contiguous:
+            raise ValueError("Axis values must be contiguous 1D NumPy arrays")
+    if axes[0].dtype not in SUPPORTED_DTYPES or any(axis.dtype != axes[0].dtype for axis in axes):
+        raise ValueError("Axis values must all be float32 or all be float64")
+    n = len(x)
+    if any(len(axis) != n for axis in axes):
+        raise ValueError("Axis value arrays must have the same length")
+
+    return _call(histo, axes, _output(out, n), n, 1)
+
+
+def evaluate_fields(histo, jets, fields, out=None):
+    """
+    Evaluate histo reading the axis values from the given fields of a structured array.
+
+    jets must be a contiguous 1D structured array, the fields must all be float32
+    or all be float64. The fields are read in place by striding over the records.
+    """
+    if not isinstance(jets, np.ndarray) or jets.dtype.names is None:
+        raise ValueError("jets must be a NumPy structured array")
+    if jets.ndim != 1 or not jets.flags.c_contiguous:
+        raise ValueError("jets must be a contiguous 1D structured array")
+    if len(fields) not in (1, 2):
+        raise ValueError("One field per histogram axis must be given")
+
+    dtype, offsets = None, []
+    for field in fields:
+        fieldDtype, offset = jets.dtype.fields[field][:2]
+        if fieldDtype not in SUPPORTED_DTYPES or (dtype is not None and fieldDtype != dtype):
+            raise ValueError("Fields must all be float32 or all be float64, %s is %s" % (field, fieldDtype))
+        dtype = fieldDtype
+        offsets.append(offset)
+
+    itemsize = jets.dtype.itemsize
+    if itemsize % dtype.itemsize or any(offset % dtype.itemsize for offset in offsets):
+        raise ValueError("The record layout doesn't allow aligned strided access to the fields")
+    stride = itemsize // dtype.itemsize
+
+    n = len(jets)
+    out = _output(out, n)
+    if n == 0:
+        return out
+
+    # Views of the raw record memory starting at each field, nothing is copied
+    span = (n - 1) * stride + 1
+    axes = [np.ndarray(shape=(span,), dtype=dtype, buffer=jets, offset=offset) for offset in offsets]
+    return _call(histo, axes, out, n, stride)
@@ -0,0 +1,107 @@
+/**
+ * @file synthetic_histograms.h
+ * @author S. Schramm, A. Freeman
+ * @brief Histograms of any dimension, binning and size generated in memory, for the
+ * benchmarks to measure how initializing and evaluating scale with the shape.
+ * @copyright Copyright (C) 2002-2022 CERN for the benefit of the ATLAS collaboration
+ *
+ * The axes are those of the calibration maps : pt (20 to 5000), |eta| (0.05 to 4.5)
+ * and the mass over pt (0.01 to 1). The contents vary smoothly along each of them.
+ */
+
+#ifndef JET_SYNTHETIC_HISTOGRAMS_H
+#define JET_SYNTHETIC_HISTOGRAMS_H
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "TH1.h"
+#include "TH2.h"
+#include "TH3.h"
+
+/**
+ * @brief Bins of the same width, of the same width in log scale (as pt bins are), or of
+ * random widths, between a fifth and twice the average one.
+ */
+enum class SyntheticBinning { Uniform, Log, Random };
+
+constexpr double SYNTHETICRANGES[3][2] {{20, 5000}, {0.05, 4.5}, {0.01, 1}};
+
+// The bins along each axis for about nBins in total, at least 2 for the interpolation
+inline int getSyntheticBinsPerAxis(const int nBins, const int nDims) {
+    return std::max(2, static_cast<int>(std::lround(std::pow(nBins, 1.0 / nDims))));
+}
+
+inline std::vector<double> makeSyntheticEdges(const int nBins, const double min, const double max,
+    const SyntheticBinning binning, std::mt19937& gen) {
+    std::vector<double> edges(nBins + 1);
+    if (binning == SyntheticBinning::Random) {
+        std::uniform_real_distribution<double> width(0.2, 2);
+        edges[0] = 0;
+        for (int i = 1; i <= nBins; ++i)
+            edges[i] = edges[i-1] + width(gen);
+        const double scale {(max - min) / edges[nBins]};
+        for (double& edge : edges)
+            edge = min + edge * scale;
+    } else {
+        for (int i = 0; i <= nBins; ++i)
+            edges[i] = binning == SyntheticBinning::Log ? min * std::pow(max / min, static_cast<double>(i) / nBins)
+                : min + (max - min) * i / nBins;
+    }
+    edges[nBins] = max;
+    return edges;
+}
+
+/**
+ * @brief Generate a TH1D, TH2D or TH3D of about nBins bins in total, as many along each
+ * axis. Uniform histograms have fixed bins, the others variable bins.
+ * @param seed of the random widths and of the noise on the contents.
+ */
+inline std::unique_ptr<TH1> makeSyntheticHistogram(const std::string& name, const int nDims, const int nBins,
+    const SyntheticBinning binning, const unsigned seed = 43294) {
+    std::mt19937 gen(seed);
+    const int n {getSyntheticBinsPerAxis(nBins, nDims)};
+    std::vector<double> edges[3];
+    for (int axis = 0; axis < nDims; ++axis)
+        edges[axis] = makeSyntheticEdges(n, SYNTHETICRANGES[axis][0], SYNTHETICRANGES[axis][1], binning, gen);
+
+    std::unique_ptr<TH1> hist;
+    const bool fixed {binning == SyntheticBinning::Uniform};
+    const char* title {""};
+    if (nDims == 1) {
+        hist = fixed ? std::make_unique<TH1D>(name.c_str(), title, n, SYNTHETICRANGES[0][0], SYNTHETICRANGES[0][1])
+            : std::make_unique<TH1D>(name.c_str(), title, n, edges[0].data());
+    } else if (nDims == 2) {
+        hist = fixed ? std::make_unique<TH2D>(name.c_str(), title, n, SYNTHETICRANGES[0][0], SYNTHETICRANGES[0][1],
+                n, SYNTHETICRANGES[1][0], SYNTHETICRANGES[1][1])
+            : std::make_unique<TH2D>(name.c_str(), title, n, edges[0].data(), n, edges[1].data());
+    } else {
+        hist = fixed ? std::make_unique<TH3D>(name.c_str(), title, n, SYNTHETICRANGES[0][0], SYNTHETICRANGES[0][1],
+                n, SYNTHETICRANGES[1][0], SYNTHETICRANGES[1][1], n, SYNTHETICRANGES[2][0], SYNTHETICRANGES[2][1])
+            : std::make_unique<TH3D>(name.c_str(), title, n, edges[0].data(), n, edges[1].data(), n, edges[2].data());
+    }
+    hist->SetDirectory(nullptr);
+
+    // A response falling with pt and rising with |eta| and the mass, with some noise
+    std::normal_distribution<double> noise(0, 1e-3);
+    const int nY {nDims > 1 ? n : 1};
+    const int nZ {nDims > 2 ? n : 1};
+    for (int binZ = 1; binZ <= nZ; ++binZ) {
+        for (int binY = 1; binY <= nY; ++binY) {
+            for (int binX = 1; binX <= n; ++binX) {
+                const double pt {hist->GetXaxis()->GetBinCenter(binX)};
+                const double eta {nDims > 1 ? hist->GetYaxis()->GetBinCenter(binY) : 0};
+                const double mass {nDims > 2 ? hist->GetZaxis()->GetBinCenter(binZ) : 0};
+                const double content {1.2 - 0.05 * std::log(pt) + 0.02 * eta * eta + 0.1 * mass + noise(gen)};
+                hist->SetBinContent(hist->GetBin(binX, binY, binZ), content);
+            }
+        }
+    }
+    return hist;
+}
+
+#endif
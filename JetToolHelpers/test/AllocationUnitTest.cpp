@@ -0,0 +1,144 @@
+/**
+ * @file AllocationUnitTest.cpp
+ * @author S. Schramm, A. Freeman
+ * @brief Once warmed up, evaluating must not allocate : allocator locks limit the
+ * scaling of multithreaded jobs. Builds without ROOT.
+ *
+ * What we test for :
+ * - the allocations of the program are counted.
+ * - scalar, batched, gradient, variation and inverse evaluations of HistoInput don't
+ *   allocate, nor those of GraphInput and of folded or unfolded CompositeInputs.
+ * - reading InputVariables, jet attributes and JetContext values doesn't allocate.
+ * - refilling a cleared JetContext with the names of the previous event doesn't allocate.
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "allocation_counter.h"
+#include "JetToolHelpers/CompositeInput.h"
+#include "JetToolHelpers/GraphInput.h"
+#include "JetToolHelpers/HistoFile.h"
+#include "JetToolHelpers/HistoInput.h"
+#include "JetToolHelpers/InputVariable.h"
+#include "JetToolHelpers/JetContext.h"
+#include "test/Test.h"
+
+namespace {
+    std::vector<std::unique_ptr<IInputBase>> makeChildren() {
+        std::vector<std::unique_ptr<IInputBase>> children;
+        for (const char* histName : {"map", "map"})
+            children.push_back(std::make_unique<HistoInput>(histName, "allocation.jth", histName, "pt", "float", true, "abseta", "float", true));
+        return children;
+    }
+}
+
+int main() {
+    TEST_BEGIN("Allocation Unit Test");
+
+    // Counted at all
+    AllocationCounter counter;
+    counter.start();
+    std::unique_ptr<int> allocated {std::make_unique<int>(1)};
+    std::vector<double> grown(100);
+    ASSERT_THROW(counter.getCount() >= 2);
+
+    std::map<std::string, LoadedHisto> histos;
+    LoadedHisto& response {histos["response"]};
+    response.nDims = 1;
+    response.binnings.push_back(HistoAxisBinning{100, 20, 3000, {}});
+    for (int i = 0; i < 100; i++)
+        response.contents.push_back(0.8 + 0.1*std::log(1 + i));
+    LoadedHisto& map {histos["map"]};
+    map.nDims = 2;
+    map.binnings.push_back(HistoAxisBinning{50, 20, 3000, {}});
+    map.binnings.push_back(HistoAxisBinning{5, 0, 4.5, {0, 0.5, 1.2, 2, 3, 4.5}});
+    for (int j = 0; j < 5; j++)
+        for (int i = 0; i < 50; i++)
+            map.contents.push_back(1 + 0.01*i + 0.1*j);
+    ASSERT_THROW(HistoFile::write("allocation.jth", histos) == true);
+
+    HistoInput input1D("input1D", "allocation.jth", "response", "pt", "float", true);
+    input1D.setInverse();
+    HistoInput input2D("input2D", "allocation.jth", "map", "pt", "float", true, "abseta", "float", true);
+    HistoInput coherent("coherent", "allocation.jth", "map", "pt", "float", true, "abseta", "float", true);
+    coherent.setCoherentBatches(16, 0);
+    HistoInput fromContext("fromContext", "allocation.jth", "response", "rho", "float", false);
+    GraphInput graph("graph", "allocation.jth", "response", "pt", "float", true);
+    CompositeInput folded("folded", CompositeOperation::Sum, makeChildren());
+    CompositeInput unfolded("unfolded", CompositeOperation::Product, makeChildren());
+    for (IInputBase* input : std::vector<IInputBase*>{&input1D, &input2D, &coherent, &fromContext, &graph, &folded, &unfolded})
+        ASSERT_THROW(input->initialize() == true);
+    ASSERT_THROW(folded.isFolded() && !unfolded.isFolded());
+
+    SG::AuxElement::Accessor<float> width("Width");
+    std::unique_ptr<InputVariable> ptVar {InputVariable::createVariable("pt", "float", true)};
+    std::unique_ptr<InputVariable> widthVar {InputVariable::createVariable("Width", "float", true)};
+    std::unique_ptr<InputVariable> rhoVar {InputVariable::createVariable("rho", "float", false)};
+    std::unique_ptr<InputVariable> npvVar {InputVariable::createVariable("NumberOfPrimaryVertices", "int", false)};
+
+    std::vector<xAOD::Jet> jets;
+    for (int i = 0; i < 64; i++) {
+        jets.push_back(xAOD::Jet{20.f + 47.f*i, -4.4f + 0.14f*i, 0, 10});
+        width.set(jets.back(), 0.01f*i);
+    }
+    std::vector<float> x, y;
+    for (const xAOD::Jet& jet : jets) {
+        x.push_back(jet.pt());
+        y.push_back(std::abs(jet.eta()));
+    }
+    std::vector<double> values(jets.size()), gradients(2*jets.size()), inverses(jets.size());
+    const HistoShift shifts[2] {{{1.01, 1}, {0, 0}}, {{0.99, 1}, {0, 0}}};
+    double variations[3];
+
+    JetContext jc;
+    double sum {0};
+    auto evaluate = [&](const int event) {
+        // Names longer than the small string buffer, stored again after clear()
+        jc.clear();
+        jc.setValue("rho", static_cast<float>(event));
+        jc.setValue("NumberOfPrimaryVertices", 10 + event);
+        jc.setValue("AverageInteractionsPerCrossing", 30.f);
+
+        double value {0};
+        for (const xAOD::Jet& jet : jets) {
+            for (const IInputBase* input : {static_cast<const IInputBase*>(&input1D), static_cast<const IInputBase*>(&input2D),
+                static_cast<const IInputBase*>(&fromContext), static_cast<const IInputBase*>(&graph),
+                static_cast<const IInputBase*>(&folded), static_cast<const IInputBase*>(&unfolded)}) {
+                input->getValue(jet, jc, value);
+                sum += value + input->getValue(jet, jc);
+            }
+            input2D.getValueAndGradient(jet, jc, value, gradients.data());
+            input2D.getVariations(jet, jc, shifts, 2, variations);
+            sum += ptVar->getValue(jet, jc) + widthVar->getValue(jet, jc) + rhoVar->getValue(jet, jc) + npvVar->getValue(jet, jc);
+            sum += jc.getValue<float>("rho") + jc.getValue<int>("NumberOfPrimaryVertices") + jc.isAvailable("mu");
+        }
+
+        input1D.getValues(x.data(), values.data(), x.size());
+        input1D.getInverses(values.data(), inverses.data(), values.size());
+        input2D.getValues(x.data(), y.data(), values.data(), x.size());
+        input2D.getValuesAndGradients(x.data(), y.data(), values.data(), gradients.data(), x.size());
+        coherent.getValues(x.data(), y.data(), values.data(), x.size());
+        graph.getValues(x.data(), values.data(), x.size());
+        folded.getValues(x.data(), y.data(), values.data(), x.size());
+        unfolded.getValues(x.data(), y.data(), values.data(), x.size());
+        sum += values[0] + inverses[0];
+    };
+
+    // The first evaluations register the thread and size the scratch buffers
+    evaluate(0);
+    counter.start();
+    for (int event = 1; event <= 100; event++)
+        evaluate(event);
+    ASSERT_EQUAL(counter.getCount(), 0);
+    ASSERT_THROW(std::isfinite(sum));
+
+    std::remove("allocation.jth");
+
+    TEST_END("Allocation Unit Test");
+    return 0;
+}
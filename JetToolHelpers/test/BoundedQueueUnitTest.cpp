@@ -0,0 +1,172 @@
+/**
+ * @file BoundedQueueUnitTest.cpp
+ * @author S. Schramm, A. Freeman
+ * @brief The queues connecting the stages of calibrate_ntuple must block at capacity,
+ * hand over every item once and in order, and let the stages stop. Builds without ROOT.
+ *
+ * What we test for :
+ * - a full queue blocks the producer until an item is popped, a capacity of 0 holds 1.
+ * - an empty queue blocks the consumer until an item is pushed.
+ * - close() wakes the blocked producers and consumers, pushes then fail and pops drain
+ *   the items left before failing.
+ * - with several producers and consumers every item is popped exactly once, the items
+ *   of each producer in the order it pushed them.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "JetToolHelpers/BoundedQueue.h"
+#include "test/Test.h"
+
+namespace {
+    // Long enough for a blocked thread to have run if it wasn't blocked
+    void settle() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+}
+
+int main() {
+    TEST_BEGIN("BoundedQueue Unit Test");
+
+    // Capacity : the third push waits for a pop
+    {
+        BoundedQueue<int> queue(2);
+        ASSERT_THROW(queue.push(1) == true);
+        ASSERT_THROW(queue.push(2) == true);
+        std::atomic<bool> pushed {false};
+        std::thread producer([&] {
+            queue.push(3);
+            pushed = true;
+        });
+        settle();
+        ASSERT_THROW(!pushed);
+        int item {0};
+        ASSERT_THROW(queue.pop(item) == true);
+        ASSERT_EQUAL(item, 1);
+        producer.join();
+        ASSERT_THROW(pushed);
+        for (const int expected : {2, 3}) {
+            ASSERT_THROW(queue.pop(item) == true);
+            ASSERT_EQUAL(item, expected);
+        }
+    }
+    {
+        BoundedQueue<int> queue(0);
+        ASSERT_THROW(queue.push(1) == true);
+        std::atomic<bool> pushed {false};
+        std::thread producer([&] {
+            queue.push(2);
+            pushed = true;
+        });
+        settle();
+        ASSERT_THROW(!pushed);
+        int item {0};
+        ASSERT_THROW(queue.pop(item) == true);
+        producer.join();
+        ASSERT_THROW(pushed);
+    }
+
+    // An empty queue blocks the consumer, move-only items are handed over
+    {
+        BoundedQueue<std::unique_ptr<int>> queue(1);
+        std::atomic<bool> popped {false};
+        std::unique_ptr<int> item;
+        std::thread consumer([&] {
+            queue.pop(item);
+            popped = true;
+        });
+        settle();
+        ASSERT_THROW(!popped);
+        ASSERT_THROW(queue.push(std::make_unique<int>(7)) == true);
+        consumer.join();
+        ASSERT_THROW(popped && item && *item == 7);
+    }
+
+    // Closing : the items left are drained, then pops and pushes fail
+    {
+        BoundedQueue<int> queue(4);
+        queue.push(1);
+        queue.push(2);
+        queue.close();
+        ASSERT_THROW(queue.push(3) == false);
+        int item {0};
+        ASSERT_THROW(queue.pop(item) == true);
+        ASSERT_EQUAL(item, 1);
+        ASSERT_THROW(queue.pop(item) == true);
+        ASSERT_EQUAL(item, 2);
+        ASSERT_THROW(queue.pop(item) == false);
+        ASSERT_THROW(queue.pop(item) == false);
+    }
+    // Closing wakes the blocked threads
+    {
+        BoundedQueue<int> empty(1);
+        BoundedQueue<int> full(1);
+        full.push(1);
+        std::atomic<int> consumerResult {-1}, producerResult {-1};
+        std::thread consumer([&] {
+            int item;
+            consumerResult = empty.pop(item);
+        });
+        std::thread producer([&] {
+            producerResult = full.push(2);
+        });
+        settle();
+        ASSERT_EQUAL(consumerResult.load(), -1);
+        ASSERT_EQUAL(producerResult.load(), -1);
+        empty.close();
+        full.close();
+        consumer.join();
+        producer.join();
+        ASSERT_EQUAL(consumerResult.load(), 0);
+        ASSERT_EQUAL(producerResult.load(), 0);
+        int item {0};
+        ASSERT_THROW(full.pop(item) == true);
+        ASSERT_EQUAL(item, 1);
+    }
+
+    // Stress : 4 producers and 3 consumers through a queue of 3 items
+    {
+        const int nProducers {4}, nConsumers {3}, nItems {20000};
+        BoundedQueue<int> queue(3);
+        std::vector<std::vector<int>> received(nConsumers);
+        std::vector<std::thread> producers, consumers;
+        for (int c = 0; c < nConsumers; c++) {
+            consumers.emplace_back([&, c] {
+                int item;
+                while (queue.pop(item))
+                    received[c].push_back(item);
+            });
+        }
+        for (int p = 0; p < nProducers; p++) {
+            producers.emplace_back([&, p] {
+                for (int i = 0; i < nItems; i++)
+                    queue.push(p*nItems + i);
+            });
+        }
+        for (std::thread& producer : producers)
+            producer.join();
+        queue.close();
+        for (std::thread& consumer : consumers)
+            consumer.join();
+
+        std::vector<int> count(nProducers*nItems, 0);
+        for (const std::vector<int>& items : received) {
+            // Each consumer sees the items of a producer in the order they were pushed
+            std::vector<int> last(nProducers, -1);
+            for (const int item : items) {
+                ASSERT_THROW(item > last[item / nItems]);
+                last[item / nItems] = item;
+                count[item]++;
+            }
+        }
+        for (const int n : count)
+            ASSERT_EQUAL(n, 1);
+    }
+
+    TEST_END("BoundedQueue Unit Test");
+    return 0;
+}
@@ -0,0 +1,140 @@
+/**
+ * @file CalibrateNtupleUnitTest.cpp
+ * @author S. Schramm, A. Freeman
+ * @brief calibrate_ntuple, run on a generated tree, must write the values HistoInput
+ * gives for the same jets. The path of calibrate_ntuple is the first argument.
+ *
+ * What we test for :
+ * - the friend tree has an entry per input entry and a value per jet, events without
+ *   jets included.
+ * - the values of 1D and 2D outputs, |branch| axes included, are those of
+ *   HistoInput::getValue() on the jets, up to the float stored.
+ * - reading a branch missing from the tree fails.
+ * - the same values come out of clusters smaller than the tree's, a single cluster in
+ *   flight between the stages and no unzip threads.
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "TFile.h"
+#include "TTree.h"
+
+#include "JetToolHelpers/HistoFile.h"
+#include "JetToolHelpers/HistoInput.h"
+#include "test/Test.h"
+
+namespace {
+    const int NENTRIES {2000};
+
+    void writeHistograms(const std::string& fileName) {
+        std::map<std::string, LoadedHisto> histos;
+        LoadedHisto& response {histos["response"]};
+        response.nDims = 1;
+        response.binnings.push_back(HistoAxisBinning{40, 20, 3000, {}});
+        for (int i = 0; i < 40; i++)
+            response.contents.push_back(0.8 + 0.1*std::log(1 + i));
+        LoadedHisto& map {histos["map"]};
+        map.nDims = 2;
+        map.binnings.push_back(HistoAxisBinning{30, 20, 3000, {}});
+        map.binnings.push_back(HistoAxisBinning{5, 0, 4.5, {0, 0.5, 1.2, 2, 3, 4.5}});
+        for (int j = 0; j < 5; j++)
+            for (int i = 0; i < 30; i++)
+                map.contents.push_back(1 + 0.01*i + 0.1*j*j);
+        ASSERT_THROW(HistoFile::write(fileName, histos) == true);
+    }
+
+    // Jets out of the histogram ranges too, and empty events
+    void writeTree(const std::string& fileName, std::vector<std::vector<xAOD::Jet>>& events) {
+        std::unique_ptr<TFile> file {TFile::Open(fileName.c_str(), "RECREATE")};
+        ASSERT_THROW(file && !file->IsZombie());
+        file->cd();
+        TTree* tree {new TTree("nominal", "generated jets")};
+        // Storage clusters of 100 entries
+        tree->SetAutoFlush(100);
+        std::vector<float> pt, eta;
+        tree->Branch("jet_pt", &pt);
+        tree->Branch("jet_eta", &eta);
+        std::mt19937 gen(9521);
+        std::uniform_int_distribution<int> nJets(0, 5);
+        std::uniform_real_distribution<float> ptDist(10, 3500), etaDist(-5, 5);
+        for (int entry = 0; entry < NENTRIES; entry++) {
+            pt.clear();
+            eta.clear();
+            events.emplace_back();
+            for (int jet = nJets(gen); jet > 0; jet--) {
+                pt.push_back(ptDist(gen));
+                eta.push_back(etaDist(gen));
+                events.back().push_back(xAOD::Jet{pt.back(), eta.back(), 0, 10});
+            }
+            tree->Fill();
+        }
+        tree->Write();
+        file->Close();
+    }
+
+    void checkFriend(const std::string& fileName, const std::vector<std::vector<xAOD::Jet>>& events,
+        const std::vector<std::pair<std::string, const HistoInput*>>& references) {
+        std::unique_ptr<TFile> file {TFile::Open(fileName.c_str(), "READ")};
+        ASSERT_THROW(file && !file->IsZombie());
+        TTree* tree {file->Get<TTree>("nominal")};
+        ASSERT_THROW(tree != nullptr);
+        ASSERT_EQUAL(tree->GetEntries(), static_cast<Long64_t>(events.size()));
+
+        std::vector<std::vector<float>*> buffers(references.size(), nullptr);
+        for (std::size_t i = 0; i < references.size(); i++)
+            ASSERT_THROW(tree->SetBranchAddress(references[i].first.c_str(), &buffers[i]) >= 0);
+        JetContext jc;
+        double expected {0};
+        for (std::size_t entry = 0; entry < events.size(); entry++) {
+            tree->GetEntry(entry);
+            for (std::size_t i = 0; i < references.size(); i++) {
+                ASSERT_EQUAL(buffers[i]->size(), events[entry].size());
+                for (std::size_t jet = 0; jet < events[entry].size(); jet++) {
+                    ASSERT_THROW(references[i].second->getValue(events[entry][jet], jc, expected) == true);
+                    ASSERT_THROW(std::abs((*buffers[i])[jet] - expected) <= 1e-6*std::abs(expected));
+                }
+            }
+        }
+    }
+}
+
+int main(int argc, char* argv[]) {
+    TEST_BEGIN("calibrate_ntuple Unit Test");
+    ASSERT_THROW(argc == 2);
+    const std::string calibrate {argv[1]};
+
+    writeHistograms("calibrate_ntuple.jth");
+    std::vector<std::vector<xAOD::Jet>> events;
+    writeTree("calibrate_ntuple_in.root", events);
+
+    HistoInput response("jet_response", "calibrate_ntuple.jth", "response", "pt", "float", true);
+    HistoInput map("jet_map", "calibrate_ntuple.jth", "map", "pt", "float", true, "abseta", "float", true);
+    ASSERT_THROW(response.initialize() == true);
+    ASSERT_THROW(map.initialize() == true);
+    const std::vector<std::pair<std::string, const HistoInput*>> references {{"jet_response", &response}, {"jet_map", &map}};
+
+    const std::string arguments {" calibrate_ntuple_in.root nominal calibrate_ntuple_out.root calibrate_ntuple.jth"
+        " jet_response=response:jet_pt 'jet_map=map:jet_pt,|jet_eta|'"};
+    for (const std::string options : {"", "--cluster-size 7 --queue-depth 1 --unzip-threads 0"}) {
+        std::remove("calibrate_ntuple_out.root");
+        ASSERT_EQUAL(std::system((calibrate + " " + options + arguments).c_str()), 0);
+        checkFriend("calibrate_ntuple_out.root", events, references);
+    }
+
+    // A branch missing from the tree is an error
+    ASSERT_THROW(std::system((calibrate + arguments + " jet_mass=response:jet_m").c_str()) != 0);
+
+    std::remove("calibrate_ntuple.jth");
+    std::remove("calibrate_ntuple_in.root");
+    std::remove("calibrate_ntuple_out.root");
+
+    TEST_END("calibrate_ntuple Unit Test");
+    return 0;
+}
@@ -0,0 +1,112 @@
+/**
+ * @file ChebyshevSurrogateUnitTest.cpp
+ * @author S. Schramm, A. Freeman
+ * @brief A surrogate may only be used where it is within the requested error of
+ * TH1::Interpolate.
+ *
+ * What we test for :
+ * - smooth 1D and 2D histograms are fitted within the requested error, including
+ *   outside of the bin centers where the interpolation is flat.
+ * - histograms that can't be approximated are refused and the best error is reported.
+ * - the error reported bounds the difference everywhere : over a dense scan of a few
+ *   wide bins, where expansions of a higher degree than the bins can swing, the
+ *   difference stays within it.
+ */
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "TH1.h"
+#include "TH2.h"
+
+#include "JetToolHelpers/ChebyshevSurrogate.h"
+#include "JetToolHelpers/RootHistoLoader.h"
+#include "test/Test.h"
+
+void testWithinError(const TH1& hist, const double maxError) {
+    std::shared_ptr<const HistoTable> table {RootHistoLoader::compileHisto(hist)};
+    double error {-1};
+    std::shared_ptr<const ChebyshevSurrogate> surrogate {ChebyshevSurrogate::fit(*table, maxError, 16, error)};
+    ASSERT_THROW(surrogate != nullptr);
+    ASSERT_THROW(error >= 0 && error <= maxError);
+    ASSERT_EQUAL(surrogate->getNDims(), hist.GetDimension());
+
+    std::mt19937 gen(1234);
+    const TAxis& xAxis {*hist.GetXaxis()};
+    const TAxis& yAxis {*hist.GetYaxis()};
+    std::uniform_real_distribution<double> unit(-0.1, 1.1);
+    for (int i = 0; i < 10000; i++) {
+        const double x {RootHistoLoader::enforceAxisRange(xAxis, xAxis.GetXmin() + unit(gen)*(xAxis.GetXmax() - xAxis.GetXmin()))};
+        if (hist.GetDimension() == 1) {
+            ASSERT_THROW(std::abs(surrogate->evaluate(x) - hist.Interpolate(x)) <= maxError);
+            continue;
+        }
+        const double y {RootHistoLoader::enforceAxisRange(yAxis, yAxis.GetXmin() + unit(gen)*(yAxis.GetXmax() - yAxis.GetXmin()))};
+        ASSERT_THROW(std::abs(surrogate->evaluate(x, y) - hist.Interpolate(x, y)) <= maxError);
+    }
+}
+
+int main() {
+    TEST_BEGIN("ChebyshevSurrogate Unit Test");
+
+    // Densely binned smooth functions : the interpolation is close to the function itself
+    TH1D smooth1D("smooth1D", "", 400, 0, 4.5);
+    for (int i = 1; i <= smooth1D.GetNbinsX(); i++)
+        smooth1D.SetBinContent(i, 1. + 0.05*std::sin(smooth1D.GetXaxis()->GetBinCenter(i)));
+    testWithinError(smooth1D, 1.e-4);
+
+    TH2D smooth2D("smooth2D", "", 200, 20, 1000, 90, 0, 4.5);
+    for (int i = 1; i <= smooth2D.GetNbinsX(); i++) {
+        for (int j = 1; j <= smooth2D.GetNbinsY(); j++) {
+            const double pt {smooth2D.GetXaxis()->GetBinCenter(i)};
+            const double eta {smooth2D.GetYaxis()->GetBinCenter(j)};
+            smooth2D.SetBinContent(i, j, 0.01 + 1.e-5*pt + 0.002*eta*eta);
+        }
+    }
+    testWithinError(smooth2D, 1.e-4);
+
+    // a linear histogram is exactly a degree 1 expansion
+    TH1D linear("linear", "", 10, 0, 1);
+    for (int i = 1; i <= linear.GetNbinsX(); i++)
+        linear.SetBinContent(i, 2.*i);
+    double error {-1};
+    std::shared_ptr<const ChebyshevSurrogate> surrogate {ChebyshevSurrogate::fit(*RootHistoLoader::compileHisto(linear), 1.e-9, 16, error)};
+    ASSERT_THROW(surrogate != nullptr);
+    ASSERT_EQUAL(surrogate->getDegree(0), 1);
+
+    // noise can't be approximated, the table must be used
+    std::mt19937 gen(43294);
+    std::uniform_real_distribution<double> content(-1, 1);
+    TH1D noise("noise", "", 50, 0, 1);
+    for (int i = 1; i <= noise.GetNbinsX(); i++)
+        noise.SetBinContent(i, content(gen));
+    error = -1;
+    ASSERT_THROW(ChebyshevSurrogate::fit(*RootHistoLoader::compileHisto(noise), 1.e-3, 16, error) == nullptr);
+    ASSERT_THROW(error > 1.e-3);
+
+    // a few wide bins, where an expansion can oscillate within a bin
+    std::uniform_real_distribution<double> tolerance(0.02, 0.12);
+    int nFitted {0};
+    for (int trial = 0; trial < 500; trial++) {
+        const int nBins {2 + trial % 6};
+        std::vector<double> contents(nBins);
+        for (double& value : contents)
+            value = 0.5*(1 + content(gen));
+        const std::shared_ptr<const HistoTable> table {HistoTable::create({HistoAxisBinning{nBins, 0, 1, {}}}, contents)};
+        const double maxError {tolerance(gen)};
+        surrogate = ChebyshevSurrogate::fit(*table, maxError, 16, error);
+        if (!surrogate)
+            continue;
+        nFitted++;
+        ASSERT_THROW(error <= maxError);
+        for (int i = 0; i <= 10000; i++) {
+            const double x {table->axes[0].enforceRange(i / 10000.)};
+            ASSERT_THROW(std::abs(surrogate->evaluate(x) - table->interpolate(x)) <= error);
+        }
+    }
+    ASSERT_THROW(nFitted > 100);
+
+    TEST_END("ChebyshevSurrogate Unit Test");
+    return 0;
+}
@@ -0,0 +1,232 @@
+/**
+ * @file CompositeInputUnitTest.cpp
+ * @author S. Schramm, A. Freeman
+ * @brief A composite input must return the combination of the values of its children,
+ * whether it folds them or not. Builds without ROOT.
+ *
+ * What we test for :
+ * - sums and differences of histograms with the same binning are folded.
+ * - products and ratios are only folded within the folding tolerance, otherwise their
+ *   contents are fused and give the children's values exactly, in 1D and 2D.
+ * - children with another binning, other variables or which aren't histograms are
+ *   evaluated one after the other, with the same values.
+ * - batches give the values of getValue().
+ * - a ratio isn't folded when its largest difference, away from the bin centers and
+ *   midpoints, exceeds the tolerance.
+ * - differences and ratios of other than two children are rejected.
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "JetToolHelpers/CompositeInput.h"
+#include "JetToolHelpers/GraphInput.h"
+#include "JetToolHelpers/HistoFile.h"
+#include "JetToolHelpers/HistoInput.h"
+#include "test/Test.h"
+
+namespace {
+    std::unique_ptr<IInputBase> make2D(const std::string& histName, const std::string& varName2 = "abseta") {
+        return std::make_unique<HistoInput>(histName, "composite.jth", histName, "pt", "float", true, varName2, "float", true);
+    }
+
+    std::vector<std::unique_ptr<IInputBase>> children(std::unique_ptr<IInputBase> first, std::unique_ptr<IInputBase> second) {
+        std::vector<std::unique_ptr<IInputBase>> inputs;
+        inputs.push_back(std::move(first));
+        inputs.push_back(std::move(second));
+        return inputs;
+    }
+}
+
+int main() {
+    TEST_BEGIN("CompositeInput Unit Test");
+
+    std::map<std::string, LoadedHisto> histos;
+    for (const std::string name : {"a", "b", "c", "coarse"}) {
+        const int nBinsX {name == "coarse" ? 10 : 40};
+        LoadedHisto& histo {histos[name]};
+        histo.nDims = 2;
+        histo.binnings.push_back(HistoAxisBinning{nBinsX, 20, 3000, {}});
+        histo.binnings.push_back(HistoAxisBinning{5, 0, 4.5, {0, 0.5, 1.2, 2, 3, 4.5}});
+        for (int j = 0; j < 5; j++)
+            for (int i = 0; i < nBinsX; i++)
+                histo.contents.push_back(1 + 0.001*name[0]*std::sin(0.3*i + j) + 0.02*j);
+    }
+    ASSERT_THROW(HistoFile::write("composite.jth", histos) == true);
+
+    // The children evaluated on their own
+    std::map<std::string, std::unique_ptr<IInputBase>> references;
+    for (const std::string name : {"a", "b", "c", "coarse"}) {
+        references[name] = make2D(name);
+        ASSERT_THROW(references[name]->initialize() == true);
+    }
+    std::mt19937 gen(1234);
+    std::uniform_real_distribution<float> pt(0, 3500), eta(-5, 5);
+    std::vector<xAOD::Jet> jets;
+    for (int i = 0; i < 1000; i++)
+        jets.push_back(xAOD::Jet{pt(gen), eta(gen), 0, 10});
+    JetContext jc;
+    auto reference = [&](const xAOD::Jet& jet, const std::string& name) {
+        return references[name]->getValue(jet, jc);
+    };
+    // The getValue() returning the value is hidden by the derived classes
+    auto valueOf = [&](const IInputBase& input, const xAOD::Jet& jet) {
+        return input.getValue(jet, jc);
+    };
+
+    // Sums are folded
+    std::vector<std::unique_ptr<IInputBase>> three;
+    for (const std::string name : {"a", "b", "c"})
+        three.push_back(make2D(name));
+    CompositeInput sum("sum", CompositeOperation::Sum, std::move(three));
+    ASSERT_THROW(sum.initialize() == true);
+    ASSERT_THROW(sum.isFolded());
+    for (const xAOD::Jet& jet : jets)
+        ASSERT_THROW(std::abs(valueOf(sum, jet) - (reference(jet, "a") + reference(jet, "b") + reference(jet, "c"))) < 1e-12);
+
+    CompositeInput difference("difference", CompositeOperation::Difference, children(make2D("a"), make2D("b")));
+    ASSERT_THROW(difference.initialize() == true);
+    ASSERT_THROW(difference.isFolded());
+    for (const xAOD::Jet& jet : jets)
+        ASSERT_THROW(std::abs(valueOf(difference, jet) - (reference(jet, "a") - reference(jet, "b"))) < 1e-12);
+
+    // Products : evaluated child by child unless folding is allowed
+    CompositeInput product("product", CompositeOperation::Product, children(make2D("a"), make2D("b")));
+    ASSERT_THROW(product.initialize() == true);
+    ASSERT_THROW(!product.isFolded());
+    ASSERT_THROW(product.isFused());
+    for (const xAOD::Jet& jet : jets)
+        ASSERT_THROW(valueOf(product, jet) == reference(jet, "a") * reference(jet, "b"));
+
+    CompositeInput tight("tight", CompositeOperation::Product, children(make2D("a"), make2D("b")));
+    tight.setFoldingTolerance(1e-9);
+    ASSERT_THROW(tight.initialize() == true);
+    ASSERT_THROW(!tight.isFolded());
+
+    CompositeInput ratio("ratio", CompositeOperation::Ratio, children(make2D("a"), make2D("b")));
+    ASSERT_THROW(ratio.initialize() == true);
+    ASSERT_THROW(ratio.isFused());
+    for (const xAOD::Jet& jet : jets)
+        ASSERT_THROW(valueOf(ratio, jet) == reference(jet, "a") / reference(jet, "b"));
+
+    CompositeInput loose("loose", CompositeOperation::Ratio, children(make2D("a"), make2D("b")));
+    loose.setFoldingTolerance(0.05);
+    ASSERT_THROW(loose.initialize() == true);
+    ASSERT_THROW(loose.isFolded());
+    for (const xAOD::Jet& jet : jets)
+        ASSERT_THROW(std::abs(valueOf(loose, jet) - reference(jet, "a") / reference(jet, "b")) <= 0.05);
+
+    // Not foldable : another binning, other variables, not a histogram
+    CompositeInput binning("binning", CompositeOperation::Sum, children(make2D("a"), make2D("coarse")));
+    ASSERT_THROW(binning.initialize() == true);
+    ASSERT_THROW(!binning.isFolded());
+    ASSERT_THROW(!binning.isFused());
+    for (const xAOD::Jet& jet : jets)
+        ASSERT_THROW(valueOf(binning, jet) == reference(jet, "a") + reference(jet, "coarse"));
+
+    CompositeInput variables("variables", CompositeOperation::Sum, children(make2D("a"), make2D("b", "eta")));
+    ASSERT_THROW(variables.initialize() == true);
+    ASSERT_THROW(!variables.isFolded());
+    HistoInput signedEta("b", "composite.jth", "b", "pt", "float", true, "eta", "float", true);
+    ASSERT_THROW(signedEta.initialize() == true);
+    for (const xAOD::Jet& jet : jets)
+        ASSERT_THROW(valueOf(variables, jet) == reference(jet, "a") + valueOf(signedEta, jet));
+
+    std::map<std::string, LoadedHisto> curves;
+    LoadedHisto& curve {curves["curve"]};
+    curve.nDims = 1;
+    curve.binnings.push_back(HistoAxisBinning{10, 20, 3000, {}});
+    for (int i = 0; i < 10; i++)
+        curve.contents.push_back(1 + 0.1*i);
+    ASSERT_THROW(HistoFile::write("curve.jth", curves) == true);
+    CompositeInput mixed("mixed", CompositeOperation::Product, children(make2D("a"),
+        std::make_unique<GraphInput>("curve", "curve.jth", "curve", "pt", "float", true)));
+    ASSERT_THROW(mixed.initialize() == true);
+    ASSERT_THROW(!mixed.isFolded());
+    GraphInput graph("curve", "curve.jth", "curve", "pt", "float", true);
+    ASSERT_THROW(graph.initialize() == true);
+    for (const xAOD::Jet& jet : jets)
+        ASSERT_THROW(valueOf(mixed, jet) == reference(jet, "a") * valueOf(graph, jet));
+
+    // Batches
+    std::vector<float> x, y;
+    for (const xAOD::Jet& jet : jets) {
+        x.push_back(jet.pt());
+        y.push_back(std::abs(jet.eta()));
+    }
+    std::vector<double> values(jets.size());
+    for (CompositeInput* input : {&sum, &product, &ratio, &loose, &binning}) {
+        ASSERT_THROW(input->getValues(x.data(), y.data(), values.data(), values.size()) == true);
+        for (std::size_t i = 0; i < jets.size(); i++)
+            ASSERT_THROW(values[i] == valueOf(*input, jets[i]));
+        ASSERT_THROW(input->getValues(x.data(), values.data(), values.size()) == false);
+    }
+    ASSERT_THROW(mixed.getValues(x.data(), y.data(), values.data(), values.size()) == false);
+
+    // 1D products of three, fused
+    std::vector<std::unique_ptr<IInputBase>> curveChildren, curveReferences;
+    for (int i = 0; i < 3; i++) {
+        for (auto* inputs : {&curveChildren, &curveReferences})
+            inputs->push_back(std::make_unique<HistoInput>("curve", "curve.jth", "curve", "pt", "float", true));
+        ASSERT_THROW(curveReferences.back()->initialize() == true);
+    }
+    CompositeInput cube("cube", CompositeOperation::Product, std::move(curveChildren));
+    ASSERT_THROW(cube.initialize() == true);
+    ASSERT_THROW(cube.isFused());
+    ASSERT_THROW(cube.getValues(x.data(), values.data(), values.size()) == true);
+    for (std::size_t i = 0; i < jets.size(); i++) {
+        const double child {valueOf(*curveReferences[0], jets[i])};
+        ASSERT_THROW(valueOf(cube, jets[i]) == child * child * child);
+        ASSERT_THROW(values[i] == valueOf(cube, jets[i]));
+    }
+
+    ASSERT_THROW(sum.finalize() == true);
+    ASSERT_THROW(product.finalize() == true);
+    double value {0};
+    ASSERT_THROW(sum.getValue(jets[0], jc, value) == false);
+
+    // The ratio 1/(1+9t) between two bins is furthest from its folding, by 0.4676, at
+    // t = 0.24 : more than the 0.3682 of the midpoint
+    std::map<std::string, LoadedHisto> steep;
+    for (const std::string name : {"numerator", "denominator"}) {
+        LoadedHisto& histo {steep[name]};
+        histo.nDims = 1;
+        histo.binnings.push_back(HistoAxisBinning{2, 0, 2, {}});
+        histo.contents = {1, name == "numerator" ? 1. : 10.};
+    }
+    ASSERT_THROW(HistoFile::write("steep.jth", steep) == true);
+    auto steepRatio = [](const double tolerance) {
+        std::vector<std::unique_ptr<IInputBase>> inputs;
+        for (const std::string name : {"numerator", "denominator"})
+            inputs.push_back(std::make_unique<HistoInput>(name, "steep.jth", name, "pt", "float", true));
+        auto ratio = std::make_unique<CompositeInput>("steep", CompositeOperation::Ratio, std::move(inputs));
+        ratio->setFoldingTolerance(tolerance);
+        ASSERT_THROW(ratio->initialize() == true);
+        return ratio;
+    };
+    ASSERT_THROW(!steepRatio(0.4)->isFolded());
+    ASSERT_THROW(steepRatio(0.6)->isFolded());
+    std::remove("steep.jth");
+
+    // Two children only
+    bool thrown {false};
+    try {
+        std::vector<std::unique_ptr<IInputBase>> one;
+        one.push_back(make2D("a"));
+        CompositeInput ratio("ratio", CompositeOperation::Ratio, std::move(one));
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    ASSERT_THROW(thrown);
+
+    std::remove("composite.jth");
+    std::remove("curve.jth");
+
+    TEST_END("CompositeInput Unit Test");
+    return 0;
+}
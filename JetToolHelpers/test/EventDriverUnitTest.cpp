@@ -0,0 +1,94 @@
+/**
+ * @file EventDriverUnitTest.cpp
+ * @author S. Schramm, A. Freeman
+ * @brief The parallel evaluation must give what a plain loop over the events gives.
+ *
+ * What we test for :
+ * - identical outputs for any number of threads, with empty and busy events.
+ * - failures of inputs are reported, exceptions are rethrown to the caller.
+ * - the driver can be reused.
+ */
+
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include "JetToolHelpers/EventDriver.h"
+#include "test/Test.h"
+
+// Depends on the jet and on the event
+class LinearInput : public IInputBase {
+    public:
+        LinearInput(const double slope) : IInputBase("linear"), m_slope{slope} {}
+        bool initialize() { return true; }
+        bool finalize() { return true; }
+        bool getValue(const xAOD::Jet& jet, const JetContext& event, double& value) const {
+            if (jet.pt() < 0)
+                return false;
+            if (jet.eta() > 100)
+                throw std::invalid_argument("eta out of range");
+            value = m_slope * jet.pt() + event.getValue<int>("eventNumber");
+            return true;
+        }
+    private:
+        double m_slope;
+};
+
+int main() {
+    TEST_BEGIN("EventDriver Unit Test");
+
+    // Mostly small events, some empty and a few very busy
+    std::mt19937 gen(43294);
+    std::geometric_distribution<int> multiplicity(0.2);
+    std::uniform_real_distribution<double> pt(20, 2000);
+    const std::size_t nEvents {2000};
+    std::vector<std::vector<xAOD::Jet>> jets(nEvents);
+    std::vector<JetContext> contexts(nEvents);
+    std::vector<EventDriver::Event> events;
+    for (std::size_t e = 0; e < nEvents; e++) {
+        const int nJets {e % 500 == 0 ? 2000 : multiplicity(gen)};
+        for (int j = 0; j < nJets; j++)
+            jets[e].push_back(xAOD::Jet{pt(gen), 1., 0., 10.});
+        contexts[e].setValue("eventNumber", static_cast<int>(e));
+    }
+    for (std::size_t e = 0; e < nEvents; e++)
+        events.push_back(EventDriver::Event{jets[e].data(), jets[e].size(), &contexts[e]});
+
+    LinearInput first(1.), second(-0.5);
+    const std::vector<const IInputBase*> inputs {&first, &second};
+
+    std::vector<double> expected;
+    for (std::size_t e = 0; e < nEvents; e++)
+        for (const xAOD::Jet& jet : jets[e])
+            for (const IInputBase* input : inputs)
+                expected.push_back(input->getValue(jet, contexts[e]));
+
+    for (const std::size_t nThreads : {1, 3, 8}) {
+        EventDriver driver(nThreads);
+        ASSERT_EQUAL(driver.getNumThreads(), nThreads);
+        for (int repeat = 0; repeat < 3; repeat++) {
+            std::vector<double> values;
+            ASSERT_THROW(driver.evaluate(events, inputs, values) == true);
+            ASSERT_THROW(values == expected);
+        }
+    }
+
+    EventDriver driver(4);
+    std::vector<double> values;
+    ASSERT_THROW(driver.evaluate({}, inputs, values) == true);
+    ASSERT_THROW(values.empty());
+
+    // a failing jet is reported and set to 0, the others are evaluated
+    jets[1].push_back(xAOD::Jet{-1., 1., 0., 10.});
+    events[1].jets = jets[1].data();
+    events[1].nJets = jets[1].size();
+    ASSERT_THROW(driver.evaluate(events, inputs, values) == false);
+    ASSERT_EQUAL(values[(jets[0].size() + jets[1].size() - 1) * inputs.size()], 0.);
+    ASSERT_EQUAL(values.back(), expected.back());
+
+    jets[1].back() = xAOD::Jet{100., 1000., 0., 10.};
+    EXPECT_EXCEPTION(driver.evaluate(events, inputs, values), std::invalid_argument);
+
+    TEST_END("EventDriver Unit Test");
+    return 0;
+}
@@ -0,0 +1,164 @@
+/**
+ * @file GraphInputUnitTest.cpp
+ * @author S. Schramm, A. Freeman
+ * @brief GraphInput must evaluate graphs, splines and profiles as piecewise curves
+ * through their points, clamped to their range.
+ *
+ * What we test for :
+ * - a TGraph, unsorted, is linear between its points and constant outside of them.
+ * - a TProfile gives the values HistoInput gives, its empty bins are skipped.
+ * - the knots of a TSpline are read, monotone cubic interpolation doesn't overshoot.
+ * - a TSpline3 evaluated with its own cubics gives TSpline3::Eval within its knots,
+ *   curves without cubics cannot be evaluated so.
+ * - batches give the values getValue() gives, with strided float and double inputs.
+ * - 1D histograms of the native format are read as curves.
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <map>
+#include <random>
+#include <vector>
+
+#include "TFile.h"
+#include "TGraph.h"
+#include "TH1.h"
+#include "TProfile.h"
+#include "TSpline.h"
+
+#include "JetToolHelpers/GraphInput.h"
+#include "JetToolHelpers/HistoFile.h"
+#include "JetToolHelpers/HistoInput.h"
+#include "test/Test.h"
+
+void writeCurves() {
+    TFile file("graphs.root", "RECREATE");
+    const double graphX[] {500, 20, 100, 100, 2500};
+    const double graphY[] {1.5, 1, 2, 7, 0.5};
+    TGraph graph(5, graphX, graphY);
+    file.WriteTObject(&graph, "graph");
+
+    std::mt19937 gen(1337);
+    std::uniform_real_distribution<double> ptDist(20, 3000);
+    TProfile profile("profile", "", 60, 20, 3000);
+    TProfile holes("holes", "", 60, 20, 3000);
+    for (int i = 0; i < 20000; i++) {
+        const double pt {ptDist(gen)};
+        profile.Fill(pt, 1 + 0.1*std::log(pt));
+        if (pt < 1000 || pt > 1500)
+            holes.Fill(pt, 1 + 0.1*std::log(pt));
+    }
+    file.WriteTObject(&profile);
+    file.WriteTObject(&holes);
+
+    const double splineX[] {20, 50, 100, 300, 1000, 3000};
+    const double splineY[] {0.9, 0.95, 1.2, 1.25, 1.3, 2};
+    TSpline3 spline("spline", splineX, splineY, 6);
+    file.WriteTObject(&spline, "spline");
+    file.Close();
+}
+
+int main() {
+    TEST_BEGIN("GraphInput Unit Test");
+
+    writeCurves();
+    JetContext jc;
+
+    // Graph : sorted, the first of the points at 100 is kept
+    GraphInput graph("graph", "graphs.root", "graph", "pt", "float", true);
+    ASSERT_THROW(graph.initialize() == true);
+    ASSERT_THROW(graph.initialize() == false);
+    ASSERT_EQUAL(graph.getTable()->getNumKnots(), 4);
+    double value {0};
+    ASSERT_THROW(graph.getValue(xAOD::Jet{20, 0, 0, 10}, jc, value) == true);
+    ASSERT_THROW(value == 1);
+    ASSERT_THROW(graph.getValue(xAOD::Jet{60, 0, 0, 10}, jc, value) == true);
+    ASSERT_THROW(std::abs(value - 1.5) < 1e-12);
+    ASSERT_THROW(graph.getValue(xAOD::Jet{300, 0, 0, 10}, jc, value) == true);
+    ASSERT_THROW(std::abs(value - 1.75) < 1e-12);
+    ASSERT_THROW(graph.getValue(xAOD::Jet{5, 0, 0, 10}, jc, value) == true);
+    ASSERT_THROW(value == 1);
+    ASSERT_THROW(graph.getValue(xAOD::Jet{5000, 0, 0, 10}, jc, value) == true);
+    ASSERT_THROW(value == 0.5);
+
+    // Profile : same values as the histogram, also for evenly spaced knots
+    GraphInput profile("profile", "graphs.root", "profile", "pt", "float", true);
+    HistoInput histo("histo", "graphs.root", "profile", "pt", "float", true);
+    ASSERT_THROW(profile.initialize() == true);
+    ASSERT_THROW(histo.initialize() == true);
+    ASSERT_EQUAL(profile.getTable()->getNumKnots(), 60);
+
+    std::mt19937 gen(4242);
+    std::uniform_real_distribution<double> ptDist(0, 3500);
+    const std::size_t nValues {5000};
+    std::vector<double> pts(2 * nValues);
+    std::vector<float> floatPts(2 * nValues);
+    for (std::size_t i = 0; i < 2 * nValues; i++)
+        floatPts[i] = pts[i] = ptDist(gen);
+    std::vector<double> expected(nValues), values(nValues);
+    ASSERT_THROW(histo.getValues(pts.data(), expected.data(), nValues, 2) == true);
+    ASSERT_THROW(profile.getValues(pts.data(), values.data(), nValues, 2) == true);
+    for (std::size_t i = 0; i < nValues; i++)
+        ASSERT_THROW(std::abs(values[i] - expected[i]) < 1e-12);
+    std::vector<double> floatValues(nValues);
+    ASSERT_THROW(profile.getValues(floatPts.data(), floatValues.data(), nValues, 2) == true);
+    ASSERT_THROW(floatValues == values);
+    for (std::size_t i = 0; i < nValues; i += 100) {
+        ASSERT_THROW(profile.getValue(xAOD::Jet{static_cast<float>(pts[2*i]), 0, 0, 10}, jc, value) == true);
+        ASSERT_THROW(value == values[i]);
+    }
+
+    // Empty bins of the profile : the curve goes from one filled bin to the next
+    GraphInput holes("holes", "graphs.root", "holes", "pt", "float", true);
+    ASSERT_THROW(holes.initialize() == true);
+    ASSERT_THROW(holes.getTable()->getNumKnots() < 60);
+    ASSERT_THROW(holes.getValue(xAOD::Jet{1250, 0, 0, 10}, jc, value) == true);
+    ASSERT_THROW(value > 1.6 && value < 1.8);
+
+    // Spline knots, monotone cubic
+    GraphInput spline("spline", "graphs.root", "spline", "pt", "float", true, GraphInterpolation::MonotoneCubic);
+    ASSERT_THROW(spline.initialize() == true);
+    ASSERT_EQUAL(spline.getTable()->getNumKnots(), 6);
+    const double splineX[] {20, 50, 100, 300, 1000, 3000};
+    const double splineY[] {0.9, 0.95, 1.2, 1.25, 1.3, 2};
+    for (int i = 0; i < 6; i++)
+        ASSERT_THROW(std::abs(spline.getTable()->evaluate(splineX[i]) - splineY[i]) < 1e-12);
+    double previous {spline.getTable()->evaluate(20)};
+    for (double pt = 20; pt <= 3000; pt += 0.5) {
+        const double current {spline.getTable()->evaluate(pt)};
+        ASSERT_THROW(current >= previous - 1e-12);
+        previous = current;
+    }
+
+    // Spline cubics, as stored in the file
+    GraphInput cubic("cubic", "graphs.root", "spline", "pt", "float", true, GraphInterpolation::Spline);
+    ASSERT_THROW(cubic.initialize() == true);
+    const TSpline3 reference("spline", splineX, splineY, 6);
+    for (double pt = 20; pt <= 3000; pt += 0.5)
+        ASSERT_THROW(std::abs(cubic.getTable()->evaluate(pt) - reference.Eval(pt)) < 1e-12);
+    ASSERT_THROW(cubic.getTable()->evaluate(5000) == cubic.getTable()->evaluate(3000));
+    GraphInput graphCubic("graph", "graphs.root", "graph", "pt", "float", true, GraphInterpolation::Spline);
+    ASSERT_THROW(graphCubic.initialize() == false);
+
+    // Native format : the bin centers of the histogram
+    std::map<std::string, LoadedHisto> histos;
+    LoadedHisto& native {histos["native"]};
+    native.nDims = 1;
+    native.binnings.push_back(HistoAxisBinning{4, 0, 0, {0, 10, 30, 60, 100}});
+    native.contents = {1, 2, 4, 3};
+    ASSERT_THROW(HistoFile::write("graphs.jth", histos) == true);
+    GraphInput fromNative("native", "graphs.jth", "native", "pt", "float", true);
+    ASSERT_THROW(fromNative.initialize() == true);
+    ASSERT_THROW(fromNative.getTable()->evaluate(5) == 1);
+    ASSERT_THROW(fromNative.getTable()->evaluate(20) == 2);
+    ASSERT_THROW(fromNative.getTable()->evaluate(32.5) == 3);
+    ASSERT_THROW(fromNative.getTable()->evaluate(80) == 3);
+
+    GraphInput missing("missing", "graphs.root", "missing", "pt", "float", true);
+    ASSERT_THROW(missing.initialize() == false);
+    ASSERT_THROW(missing.getValue(xAOD::Jet{20, 0, 0, 10}, jc, value) == false);
+    std::remove("graphs.jth");
+
+    TEST_END("GraphInput Unit Test");
+    return 0;
+}
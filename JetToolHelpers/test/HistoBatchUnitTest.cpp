@@ -0,0 +1,89 @@
+/**
+ * @file HistoBatchUnitTest.cpp
+ * @author S. Schramm, A. Freeman
+ * @brief Evaluating a batch cell by cell must give the values evaluating it in order gives.
+ *
+ * What we test for :
+ * - identical values and gradients, 1D and 2D, with strided float and double inputs.
+ * - batches smaller than the threshold and small tables are evaluated in order.
+ */
+
+#include <random>
+#include <vector>
+
+#include "TFile.h"
+
+#include "JetToolHelpers/HistoInput.h"
+#include "test/Test.h"
+
+void writeCalibrations() {
+    TFile file("batch.root", "RECREATE");
+    Test::writeHistogram(file, "calibration1D", Test::geometricBinning(15, 3000, 1.01),
+        [](int i, int, double, double) { return 1. / i; });
+    Test::writeHistogram(file, "calibration2D", {300, 20, 3000, {}}, {200, 0, 4.5, {}},
+        [](int i, int j, double, double) { return i + 0.01*i*j; });
+    file.Close();
+}
+
+int main() {
+    TEST_BEGIN("HistoBatch Unit Test");
+
+    writeCalibrations();
+    HistoInput inOrder1D("1D", "batch.root", "calibration1D", "pt", "float", true);
+    HistoInput inOrder2D("2D", "batch.root", "calibration2D", "pt", "float", true, "abseta", "float", true);
+    HistoInput coherent1D("1D", "batch.root", "calibration1D", "pt", "float", true);
+    HistoInput coherent2D("2D", "batch.root", "calibration2D", "pt", "float", true, "abseta", "float", true);
+    coherent1D.setCoherentBatches(100, 0);
+    coherent2D.setCoherentBatches(100, 0);
+    for (HistoInput* input : {&inOrder1D, &inOrder2D, &coherent1D, &coherent2D})
+        ASSERT_THROW(input->initialize() == true);
+
+    // pt and abseta interleaved, some outside of the axes
+    std::mt19937 gen(5532);
+    std::uniform_real_distribution<double> ptDist(0, 3500);
+    std::uniform_real_distribution<double> etaDist(-0.5, 5);
+    for (const std::size_t nValues : {10, 99, 100, 5000, 100000}) {
+        std::vector<double> jets(2 * nValues);
+        std::vector<float> floatJets(2 * nValues);
+        for (std::size_t i = 0; i < nValues; i++) {
+            floatJets[2*i] = jets[2*i] = ptDist(gen);
+            floatJets[2*i+1] = jets[2*i+1] = etaDist(gen);
+        }
+        std::vector<double> expected(nValues), values(nValues);
+        std::vector<double> expectedGradients(2 * nValues), gradients(2 * nValues);
+
+        ASSERT_THROW(inOrder1D.getValues(jets.data(), expected.data(), nValues, 2) == true);
+        ASSERT_THROW(coherent1D.getValues(jets.data(), values.data(), nValues, 2) == true);
+        ASSERT_THROW(values == expected);
+        ASSERT_THROW(coherent1D.getValues(floatJets.data(), values.data(), nValues, 2) == true);
+        ASSERT_THROW(values == expected);
+        ASSERT_THROW(inOrder1D.getValuesAndGradients(jets.data(), expected.data(), expectedGradients.data(), nValues, 2) == true);
+        ASSERT_THROW(coherent1D.getValuesAndGradients(jets.data(), values.data(), gradients.data(), nValues, 2) == true);
+        ASSERT_THROW(values == expected);
+        ASSERT_THROW(gradients == expectedGradients);
+
+        ASSERT_THROW(inOrder2D.getValues(jets.data(), jets.data() + 1, expected.data(), nValues, 2) == true);
+        ASSERT_THROW(coherent2D.getValues(jets.data(), jets.data() + 1, values.data(), nValues, 2) == true);
+        ASSERT_THROW(values == expected);
+        ASSERT_THROW(coherent2D.getValues(floatJets.data(), floatJets.data() + 1, values.data(), nValues, 2) == true);
+        ASSERT_THROW(values == expected);
+        ASSERT_THROW(inOrder2D.getValuesAndGradients(jets.data(), jets.data() + 1, expected.data(), expectedGradients.data(), nValues, 2) == true);
+        ASSERT_THROW(coherent2D.getValuesAndGradients(jets.data(), jets.data() + 1, values.data(), gradients.data(), nValues, 2) == true);
+        ASSERT_THROW(values == expected);
+        ASSERT_THROW(gradients == expectedGradients);
+    }
+
+    // only large tables, the same values anyway
+    HistoInput smallTable("2D", "batch.root", "calibration2D", "pt", "float", true, "abseta", "float", true);
+    smallTable.setCoherentBatches(1, 1 << 30);
+    ASSERT_THROW(smallTable.initialize() == true);
+    const double pts[] {100, 200, 300}, absetas[] {0.5, 1.5, 2.5};
+    double values[3], expected[3];
+    ASSERT_THROW(smallTable.getValues(pts, absetas, values, 3) == true);
+    ASSERT_THROW(inOrder2D.getValues(pts, absetas, expected, 3) == true);
+    for (int i = 0; i < 3; i++)
+        ASSERT_EQUAL(values[i], expected[i]);
+
+    TEST_END("HistoBatch Unit Test");
+    return 0;
+}
@@ -0,0 +1,137 @@
+/**
+ * @file HistoCaptureUnitTest.cpp
+ * @author S. Schramm, A. Freeman
+ * @brief A capture must hold the axis values the inputs were evaluated at, and replaying
+ * them must give the values of the job. Builds without ROOT.
+ *
+ * What we test for :
+ * - scalar, batched and nominal variation evaluations are recorded, from several threads.
+ * - the values of each thread stay in order, 2D values stay paired.
+ * - replaying the streams through getValues() gives the values of the job.
+ * - inputs without capture aren't recorded, truncated captures are rejected.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "JetToolHelpers/HistoCapture.h"
+#include "JetToolHelpers/HistoFile.h"
+#include "JetToolHelpers/HistoInput.h"
+#include "test/Test.h"
+
+int main() {
+    TEST_BEGIN("HistoCapture Unit Test");
+
+    std::map<std::string, LoadedHisto> histos;
+    LoadedHisto& response {histos["response"]};
+    response.nDims = 1;
+    response.binnings.push_back(HistoAxisBinning{50, 20, 3000, {}});
+    for (int i = 0; i < 50; i++)
+        response.contents.push_back(1 + 0.01*i);
+    LoadedHisto& map {histos["map"]};
+    map.nDims = 2;
+    map.binnings.push_back(HistoAxisBinning{30, 20, 3000, {}});
+    map.binnings.push_back(HistoAxisBinning{10, 0, 4.5, {}});
+    for (int j = 0; j < 10; j++)
+        for (int i = 0; i < 30; i++)
+            map.contents.push_back(i + 0.1*j);
+    ASSERT_THROW(HistoFile::write("capture.jth", histos) == true);
+
+    HistoInput input1D("input1D", "capture.jth", "response", "pt", "float", true);
+    HistoInput input2D("input2D", "capture.jth", "map", "pt", "float", true, "abseta", "float", true);
+    HistoInput notCaptured("notCaptured", "capture.jth", "response", "pt", "float", true);
+    for (HistoInput* input : {&input1D, &input2D, &notCaptured})
+        ASSERT_THROW(input->initialize() == true);
+
+    std::shared_ptr<HistoCapture> capture {HistoCapture::create("capture.jthc")};
+    ASSERT_THROW(capture != nullptr);
+    input1D.setCapture(capture);
+    input2D.setCapture(capture);
+
+    // Each thread evaluates its own jets, more than a block of them : jet i of thread t
+    // has pt 20+i/2+t/4
+    const int nJets {5000};
+    std::vector<std::vector<double>> jobValues(2);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 2; t++) {
+        threads.emplace_back([&, t]() {
+            JetContext jc;
+            double value;
+            for (int i = 0; i < nJets; i++) {
+                const xAOD::Jet jet {20.f + i*0.5f + t*0.25f, -4.f + i*0.001f, 0, 10};
+                input1D.getValue(jet, jc, value);
+                jobValues[t].push_back(value);
+                input2D.getValue(jet, jc, value);
+                jobValues[t].push_back(value);
+                notCaptured.getValue(jet, jc, value);
+            }
+        });
+    }
+    for (std::thread& thread : threads)
+        thread.join();
+
+    const std::vector<float> batch {25, 250, 2500};
+    std::vector<double> batchValues(3);
+    ASSERT_THROW(input1D.getValues(batch.data(), batchValues.data(), 3) == true);
+    const HistoShift shift {{1.1, 1}, {0, 0}};
+    double variations[2];
+    ASSERT_THROW(input1D.getVariations(xAOD::Jet{100, 0, 0, 10}, JetContext(), &shift, 1, variations) == true);
+    ASSERT_THROW(capture->close() == true);
+
+    std::vector<CapturedStream> streams;
+    ASSERT_THROW(HistoCapture::read("capture.jthc", streams) == true);
+    ASSERT_EQUAL(streams.size(), 2);
+    ASSERT_THROW(streams[0].name == "input1D" && streams[0].histName == "response" && streams[0].fileName == "capture.jth");
+    ASSERT_EQUAL(streams[0].nDims, 1);
+    ASSERT_EQUAL(streams[1].nDims, 2);
+    ASSERT_EQUAL(streams[0].x.size(), 2*nJets + 3 + 1);
+    ASSERT_EQUAL(streams[0].y.size(), 0);
+    ASSERT_EQUAL(streams[1].x.size(), 2*nJets);
+    ASSERT_EQUAL(streams[1].y.size(), 2*nJets);
+
+    // In order within each thread, and paired
+    std::vector<int> previous {-1, -1};
+    for (std::size_t i = 0; i < streams[1].x.size(); i++) {
+        const int quarters {static_cast<int>(streams[1].x[i]*4) - 80};
+        const int thread {quarters % 2};
+        const int jet {quarters / 2};
+        ASSERT_THROW(jet > previous[thread]);
+        ASSERT_THROW(streams[1].y[i] == std::abs(-4.f + jet*0.001f));
+        previous[thread] = jet;
+    }
+    ASSERT_EQUAL(previous[0], nJets - 1);
+    ASSERT_EQUAL(previous[1], nJets - 1);
+
+    // Replay : the values of the job
+    input2D.setCapture(nullptr);
+    std::vector<double> replayed(streams[1].x.size());
+    ASSERT_THROW(input2D.getValues(streams[1].x.data(), streams[1].y.data(), replayed.data(), replayed.size()) == true);
+    std::vector<double> expected;
+    for (const std::vector<double>& values : jobValues)
+        for (std::size_t i = 1; i < values.size(); i += 2)
+            expected.push_back(values[i]);
+    std::sort(expected.begin(), expected.end());
+    std::sort(replayed.begin(), replayed.end());
+    ASSERT_THROW(replayed == expected);
+
+    // Truncated
+    std::ifstream in("capture.jthc", std::ios::binary);
+    std::string content((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    std::ofstream out("truncated.jthc", std::ios::binary);
+    out.write(content.data(), content.size() - 10);
+    out.close();
+    ASSERT_THROW(HistoCapture::read("truncated.jthc", streams) == false);
+
+    std::remove("capture.jth");
+    std::remove("capture.jthc");
+    std::remove("truncated.jthc");
+
+    TEST_END("HistoCapture Unit Test");
+    return 0;
+}
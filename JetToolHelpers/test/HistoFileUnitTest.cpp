@@ -0,0 +1,116 @@
+/**
+ * @file HistoFileUnitTest.cpp
+ * @author S. Schramm, A. Freeman
+ * @brief The native histogram files must give back what was written, and HistoInput
+ * must evaluate them without ROOT. Builds without ROOT.
+ *
+ * What we test for :
+ * - histograms written and read back are identical, 1D and 2D, fixed and variable bins.
+ * - missing histograms, truncated and foreign files are refused.
+ * - HistoInput evaluates a .jth file like the table compiled from the same histogram.
+ * - files without a registered loader are refused, registered loaders are used.
+ */
+
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "JetToolHelpers/HistoFile.h"
+#include "JetToolHelpers/HistoInput.h"
+#include "JetToolHelpers/HistoLoader.h"
+#include "test/Test.h"
+
+bool sameHisto(const LoadedHisto& a, const LoadedHisto& b) {
+    if (a.nDims != b.nDims || a.binnings.size() != b.binnings.size() || a.contents != b.contents)
+        return false;
+    for (std::size_t i = 0; i < a.binnings.size(); i++)
+        if (a.binnings[i].nBins != b.binnings[i].nBins || a.binnings[i].xMin != b.binnings[i].xMin
+            || a.binnings[i].xMax != b.binnings[i].xMax || a.binnings[i].edges != b.binnings[i].edges)
+            return false;
+    return true;
+}
+
+int main() {
+    TEST_BEGIN("HistoFile Unit Test");
+
+    std::map<std::string, LoadedHisto> histos;
+    LoadedHisto& variable1D {histos["variable1D"]};
+    variable1D.nDims = 1;
+    variable1D.binnings.push_back(HistoAxisBinning{4, 15, 3000, {15, 40, 200, 1000, 3000}});
+    variable1D.contents = {1.5, 1.2, 1.05, 1.01};
+    LoadedHisto& fixed2D {histos["fixed2D"]};
+    fixed2D.nDims = 2;
+    fixed2D.binnings.push_back(HistoAxisBinning{30, 20, 3000, {}});
+    fixed2D.binnings.push_back(HistoAxisBinning{9, 0, 4.5, {}});
+    for (int j = 0; j < 9; j++)
+        for (int i = 0; i < 30; i++)
+            fixed2D.contents.push_back(1 + 0.1*i + 0.01*i*j);
+
+    // written and read back
+    ASSERT_THROW(HistoFile::write("histos.jth", histos) == true);
+    ASSERT_THROW((HistoFile::getHistNames("histos.jth") == std::vector<std::string>{"fixed2D", "variable1D"}));
+    for (const auto& entry : histos) {
+        LoadedHisto read;
+        ASSERT_THROW(HistoFile::read("histos.jth", entry.first, read) == true);
+        ASSERT_THROW(sameHisto(read, entry.second));
+        ASSERT_THROW(HistoLoader::load("histos.jth", entry.first, read) == true);
+        ASSERT_THROW(sameHisto(read, entry.second));
+    }
+
+    // refused
+    LoadedHisto read;
+    ASSERT_THROW(HistoFile::read("histos.jth", "missing", read) == false);
+    ASSERT_THROW(HistoFile::read("missing.jth", "fixed2D", read) == false);
+    std::map<std::string, LoadedHisto> inconsistent {histos};
+    inconsistent["fixed2D"].contents.pop_back();
+    ASSERT_THROW(HistoFile::write("inconsistent.jth", inconsistent) == false);
+    {
+        std::ifstream in("histos.jth", std::ios::binary);
+        const std::string bytes {std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+        std::ofstream("truncated.jth", std::ios::binary) << bytes.substr(0, bytes.size() - 8);
+        std::ofstream("foreign.jth", std::ios::binary) << "not a histogram file";
+    }
+    ASSERT_THROW(HistoFile::read("truncated.jth", "variable1D", read) == false);
+    ASSERT_THROW(HistoFile::read("foreign.jth", "variable1D", read) == false);
+
+    // evaluated like the table
+    HistoInput input1D("1D", "histos.jth", "variable1D", "pt", "float", true);
+    HistoInput input2D("2D", "histos.jth", "fixed2D", "pt", "float", true, "abseta", "float", true);
+    ASSERT_THROW(input1D.initialize() == true);
+    ASSERT_THROW(input2D.initialize() == true);
+    const std::shared_ptr<const HistoTable> table1D {HistoTable::create(variable1D.binnings, variable1D.contents)};
+    const std::shared_ptr<const HistoTable> table2D {HistoTable::create(fixed2D.binnings, fixed2D.contents)};
+    const float pts[] {10, 20, 35.5, 150, 999, 2500, 4000};
+    const float absetas[] {-0.1, 0, 0.3, 1.7, 2.25, 4.4, 5};
+    double values[7];
+    ASSERT_THROW(input1D.getValues(pts, values, 7) == true);
+    for (int i = 0; i < 7; i++) {
+        const float x {static_cast<float>(table1D->axes[0].enforceRange(pts[i]))};
+        ASSERT_EQUAL(values[i], table1D->interpolate(x));
+    }
+    ASSERT_THROW(input2D.getValues(pts, absetas, values, 7) == true);
+    for (int i = 0; i < 7; i++) {
+        const float x {static_cast<float>(table2D->axes[0].enforceRange(pts[i]))};
+        const float y {static_cast<float>(table2D->axes[1].enforceRange(absetas[i]))};
+        ASSERT_EQUAL(values[i], table2D->interpolate(x, y));
+    }
+
+    // loaders by extension
+    ASSERT_THROW(HistoLoader::getExtension("dir.v2/calib.JTH") == ".jth");
+    ASSERT_THROW(HistoLoader::getExtension("dir.v2/calib") == "");
+    HistoInput unknown("unknown", "histos.unknown", "variable1D", "pt", "float", true);
+    ASSERT_THROW(unknown.initialize() == false);
+    HistoLoader::registerLoader(".unknown", [](const std::string&, const std::string& histName, LoadedHisto& histo) {
+        return HistoFile::read("histos.jth", histName, histo);
+    });
+    HistoInput registered("registered", "histos.unknown", "variable1D", "pt", "float", true);
+    ASSERT_THROW(registered.initialize() == true);
+
+    for (const char* fileName : {"histos.jth", "truncated.jth", "foreign.jth"})
+        std::remove(fileName);
+
+    TEST_END("HistoFile Unit Test");
+    return 0;
+}
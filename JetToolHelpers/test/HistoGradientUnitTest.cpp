@@ -0,0 +1,176 @@
+/**
+ * @file HistoGradientUnitTest.cpp
+ * @author S. Schramm, A. Freeman
+ * @brief The gradients must be those of the interpolation actually evaluated.
+ *
+ * What we test for :
+ * - the values are unchanged when the gradient is requested.
+ * - the gradients match finite differences away from the bin centers, 1D and 2D,
+ *   for the table and for the surrogate.
+ * - the batched gradients are those of the single evaluations, 0 outside of the axes.
+ * - through a HistoInput evaluating a surrogate, the clamped axes have a gradient of 0
+ *   and the others that of the surrogate at the clamped inputs.
+ */
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "TFile.h"
+
+#include "JetToolHelpers/HistoInput.h"
+#include "test/Test.h"
+
+// Central difference of f at x, in a region where it is linear or smooth
+template <typename F>
+double difference(const F& f, const double x, const double h) {
+    return (f(x + h) - f(x - h)) / (2*h);
+}
+
+void writeCalibrations() {
+    TFile file("gradient.root", "RECREATE");
+    Test::writeHistogram(file, "calibration1D", {40, 0, 4000, {}},
+        [](int, int, double x, double) { return 1 + std::exp(-x/800.); });
+    Test::writeHistogram(file, "calibration2D", {30, 20, 3000, {}}, {8, 0, 4.5, {0, 0.3, 0.8, 1.2, 1.6, 2.1, 2.8, 3.6, 4.5}},
+        [](int, int j, double x, double) { return 1 + 0.2*j/std::sqrt(x); });
+    file.Close();
+}
+
+int main() {
+    TEST_BEGIN("HistoGradient Unit Test");
+
+    writeCalibrations();
+    std::mt19937 gen(8121);
+    std::uniform_real_distribution<double> ptDist(0, 4500);
+    std::uniform_real_distribution<double> etaDist(0, 5);
+    const double h {1e-4};
+
+    // tables
+    HistoInput input1D("1D", "gradient.root", "calibration1D", "pt", "float", true);
+    HistoInput input2D("2D", "gradient.root", "calibration2D", "pt", "float", true, "abseta", "float", true);
+    ASSERT_THROW(input1D.initialize() == true);
+    ASSERT_THROW(input2D.initialize() == true);
+    const std::shared_ptr<const HistoTable> table1D {input1D.getTable()};
+    const std::shared_ptr<const HistoTable> table2D {input2D.getTable()};
+    for (int i = 0; i < 10000; i++) {
+        const double x {ptDist(gen)};
+        const double y {etaDist(gen)};
+        double gradient[2] {-1, -1};
+        ASSERT_EQUAL(table1D->interpolate(x, gradient), table1D->interpolate(x));
+        const double derivative {difference([&](const double v) { return table1D->interpolate(v); }, x, h)};
+        ASSERT_THROW(std::abs(gradient[0] - derivative) < 1e-8);
+
+        ASSERT_EQUAL(table2D->interpolate(x, y, gradient), table2D->interpolate(x, y));
+        const double dX {difference([&](const double v) { return table2D->interpolate(v, y); }, x, h)};
+        const double dY {difference([&](const double v) { return table2D->interpolate(x, v); }, y, h)};
+        // a difference straddling a bin center or an edge mixes two segments, skip those
+        const HistoAxis& xAxis {table2D->axes[0]};
+        const HistoAxis& yAxis {table2D->axes[1]};
+        const int binX {xAxis.findBin(x)};
+        const int binY {yAxis.findBin(y)};
+        if (binX < 1 || binX > xAxis.nBins || binY < 1 || binY > yAxis.nBins
+            || std::abs(x - xAxis.getBinCenter(binX)) < 2*h || std::abs(y - yAxis.getBinCenter(binY)) < 2*h
+            || std::abs(x - xAxis.getBinLowEdge(binX)) < 2*h || std::abs(y - yAxis.getBinLowEdge(binY)) < 2*h)
+            continue;
+        ASSERT_THROW(std::abs(gradient[0] - dX) < 1e-8);
+        ASSERT_THROW(std::abs(gradient[1] - dY) < 1e-6);
+    }
+
+    // batches against single evaluations, through the float inputs of the jets
+    std::vector<float> pts, etas;
+    for (int i = 0; i < 1000; i++) {
+        pts.push_back(ptDist(gen));
+        etas.push_back(etaDist(gen));
+    }
+    std::vector<double> values(pts.size()), gradients(2 * pts.size());
+    ASSERT_THROW(input1D.getValuesAndGradients(pts.data(), values.data(), gradients.data(), pts.size()) == true);
+    JetContext jc;
+    for (std::size_t i = 0; i < pts.size(); i++) {
+        const xAOD::Jet jet {pts[i], etas[i], 0., 10.};
+        double value {0}, gradient[2] {0, 0};
+        ASSERT_THROW(input1D.getValueAndGradient(jet, jc, value, gradient) == true);
+        ASSERT_EQUAL(values[i], value);
+        ASSERT_EQUAL(gradients[i], gradient[0]);
+        double plainValue {0};
+        ASSERT_THROW(input1D.getValue(jet, jc, plainValue) == true);
+        ASSERT_EQUAL(value, plainValue);
+    }
+    ASSERT_THROW(input2D.getValuesAndGradients(pts.data(), etas.data(), values.data(), gradients.data(), pts.size()) == true);
+    for (std::size_t i = 0; i < pts.size(); i++) {
+        const xAOD::Jet jet {pts[i], etas[i], 0., 10.};
+        double value {0}, gradient[2] {0, 0};
+        ASSERT_THROW(input2D.getValueAndGradient(jet, jc, value, gradient) == true);
+        ASSERT_EQUAL(values[i], value);
+        ASSERT_EQUAL(gradients[2*i], gradient[0]);
+        ASSERT_EQUAL(gradients[2*i+1], gradient[1]);
+        // clamped inputs don't move the value
+        if (pts[i] > 3000 || etas[i] > 4.5)
+            ASSERT_EQUAL(gradient[pts[i] > 3000 ? 0 : 1], 0.);
+    }
+    ASSERT_THROW(input1D.getValuesAndGradients(pts.data(), etas.data(), values.data(), gradients.data(), pts.size()) == false);
+
+    // surrogates, smooth everywhere inside of the bin centers
+    HistoInput surrogate1D("1D", "gradient.root", "calibration1D", "pt", "float", true);
+    HistoInput surrogate2D("2D", "gradient.root", "calibration2D", "pt", "float", true, "abseta", "float", true);
+    surrogate1D.setSurrogate(1e-2, 32);
+    surrogate2D.setSurrogate(1e-2, 32);
+    ASSERT_THROW(surrogate1D.initialize() == true);
+    ASSERT_THROW(surrogate2D.initialize() == true);
+    ASSERT_THROW(surrogate1D.getSurrogate() != nullptr);
+    ASSERT_THROW(surrogate2D.getSurrogate() != nullptr);
+    const std::shared_ptr<const ChebyshevSurrogate> chebyshev1D {surrogate1D.getSurrogate()};
+    const std::shared_ptr<const ChebyshevSurrogate> chebyshev2D {surrogate2D.getSurrogate()};
+    std::uniform_real_distribution<double> innerPt(200, 2800);
+    std::uniform_real_distribution<double> innerEta(0.3, 3.5);
+    for (int i = 0; i < 1000; i++) {
+        const double x {innerPt(gen)};
+        const double y {innerEta(gen)};
+        double gradient[2] {0, 0};
+        ASSERT_EQUAL(chebyshev1D->evaluate(x, gradient), chebyshev1D->evaluate(x));
+        const double derivative {difference([&](const double v) { return chebyshev1D->evaluate(v); }, x, 1e-2)};
+        ASSERT_THROW(std::abs(gradient[0] - derivative) < 1e-6 * (1 + std::abs(derivative)));
+
+        ASSERT_EQUAL(chebyshev2D->evaluate(x, y, gradient), chebyshev2D->evaluate(x, y));
+        const double dX {difference([&](const double v) { return chebyshev2D->evaluate(v, y); }, x, 1e-2)};
+        const double dY {difference([&](const double v) { return chebyshev2D->evaluate(x, v); }, y, 1e-5)};
+        ASSERT_THROW(std::abs(gradient[0] - dX) < 1e-6 * (1 + std::abs(dX)));
+        ASSERT_THROW(std::abs(gradient[1] - dY) < 1e-5 * (1 + std::abs(dY)));
+    }
+    double gradient[2] {1, 1};
+    chebyshev1D->evaluate(5000., gradient);
+    ASSERT_EQUAL(gradient[0], 0.);
+
+    // jets out of the axis ranges, one axis at a time and both
+    const std::vector<std::pair<float, float>> outside {{5, 1.5}, {3500, 1.5}, {800, 4.8}, {5, 4.8}, {3500, 6}, {800, 1.5}};
+    std::vector<float> outPts, outEtas;
+    for (const std::pair<float, float>& point : outside) {
+        outPts.push_back(point.first);
+        outEtas.push_back(point.second);
+    }
+    std::vector<double> outValues(outside.size()), outGradients(2 * outside.size());
+    ASSERT_THROW(surrogate2D.getValuesAndGradients(outPts.data(), outEtas.data(), outValues.data(), outGradients.data(), outside.size()) == true);
+    for (std::size_t i = 0; i < outside.size(); i++) {
+        const xAOD::Jet jet {outPts[i], outEtas[i], 0., 10.};
+        double value {0}, jetGradient[2] {1, 1};
+        ASSERT_THROW(surrogate2D.getValueAndGradient(jet, jc, value, jetGradient) == true);
+        ASSERT_EQUAL(outValues[i], value);
+        ASSERT_EQUAL(outGradients[2*i], jetGradient[0]);
+        ASSERT_EQUAL(outGradients[2*i+1], jetGradient[1]);
+
+        const bool clampedX {outPts[i] < 20 || outPts[i] > 3000};
+        const bool clampedY {outEtas[i] > 4.5};
+        const double x {table2D->axes[0].enforceRange(outPts[i])};
+        const double y {table2D->axes[1].enforceRange(outEtas[i])};
+        ASSERT_EQUAL(value, chebyshev2D->evaluate(x, y));
+        chebyshev2D->evaluate(x, y, gradient);
+        ASSERT_EQUAL(jetGradient[0], clampedX ? 0. : gradient[0]);
+        ASSERT_EQUAL(jetGradient[1], clampedY ? 0. : gradient[1]);
+    }
+    ASSERT_THROW(outGradients[10] != 0 && outGradients[11] != 0);
+    double value1D {0};
+    ASSERT_THROW(surrogate1D.getValueAndGradient(xAOD::Jet{4200., 0., 0., 10.}, jc, value1D, gradient) == true);
+    ASSERT_EQUAL(gradient[0], 0.);
+
+    TEST_END("HistoGradient Unit Test");
+    return 0;
+}
@@ -0,0 +1,125 @@
+/**
+ * @file HistoInverseUnitTest.cpp
+ * @author S. Schramm, A. Freeman
+ * @brief The inverse of a monotone 1D histogram must return the axis values the histogram
+ * is evaluated at. Builds without ROOT.
+ *
+ * What we test for :
+ * - increasing and decreasing responses, fixed and variable bins, are inverted.
+ * - values beyond the contents give the first or last bin center.
+ * - the inverse is rebuilt by reload().
+ * - non monotone and 2D histograms aren't inverted and initialize() fails.
+ * - surrogates and quantized contents, whose getValue() isn't the interpolation being
+ *   inverted, aren't either. Exactly compressed contents are, and tuning only picks
+ *   exact kernels.
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "JetToolHelpers/HistoFile.h"
+#include "JetToolHelpers/HistoInput.h"
+#include "JetToolHelpers/HistoTuning.h"
+#include "test/Test.h"
+
+int main() {
+    TEST_BEGIN("HistoInverse Unit Test");
+
+    std::map<std::string, LoadedHisto> histos;
+    LoadedHisto& response {histos["response"]};
+    response.nDims = 1;
+    response.binnings.push_back(HistoAxisBinning{100, 20, 3000, {}});
+    for (int i = 0; i < 100; i++)
+        response.contents.push_back(0.8 + 0.1*std::log(1 + i));
+    LoadedHisto& falling {histos["falling"]};
+    falling.nDims = 1;
+    falling.binnings.push_back(HistoAxisBinning{5, 0, 4.5, {0, 0.5, 1.5, 2.5, 3.5, 4.5}});
+    falling.contents = {1.2, 1.1, 1.05, 0.95, 0.7};
+    LoadedHisto& flat {histos["flat"]};
+    flat.nDims = 1;
+    flat.binnings.push_back(HistoAxisBinning{4, 0, 4, {}});
+    flat.contents = {1, 2, 2, 3};
+    LoadedHisto& map {histos["map"]};
+    map.nDims = 2;
+    map.binnings.push_back(HistoAxisBinning{2, 0, 2, {}});
+    map.binnings.push_back(HistoAxisBinning{2, 0, 2, {}});
+    map.contents = {1, 2, 3, 4};
+    ASSERT_THROW(HistoFile::write("inverse.jth", histos) == true);
+
+    // f(finv(y)) == y over the range of the interpolation
+    HistoInput increasing("increasing", "inverse.jth", "response", "pt", "float", true);
+    increasing.setInverse();
+    ASSERT_THROW(increasing.initialize() == true);
+    const double firstCenter {20 + 0.5*29.8}, lastCenter {3000 - 0.5*29.8};
+    std::mt19937 gen(1234);
+    std::uniform_real_distribution<float> pt(firstCenter, lastCenter);
+    std::vector<double> pts(1000), values(1000), inverses(1000);
+    for (double& value : pts)
+        value = pt(gen);
+    ASSERT_THROW(increasing.getValues(pts.data(), values.data(), 1000) == true);
+    ASSERT_THROW(increasing.getInverses(values.data(), inverses.data(), 1000) == true);
+    for (int i = 0; i < 1000; i++)
+        ASSERT_THROW(std::abs(inverses[i] - pts[i]) < 1e-9*pts[i]);
+    double x {0};
+    ASSERT_THROW(increasing.getInverse(0.5, x) == true);
+    ASSERT_THROW(std::abs(x - firstCenter) < 1e-9);
+    ASSERT_THROW(increasing.getInverse(10, x) == true);
+    ASSERT_THROW(std::abs(x - lastCenter) < 1e-9);
+    ASSERT_THROW(increasing.reload() == true);
+    ASSERT_THROW(increasing.getInverse(values[0], x) == true);
+    ASSERT_THROW(std::abs(x - pts[0]) < 1e-9*pts[0]);
+
+    HistoInput decreasing("decreasing", "inverse.jth", "falling", "abseta", "float", true);
+    decreasing.setInverse();
+    ASSERT_THROW(decreasing.initialize() == true);
+    for (const double eta : {0.25, 0.6, 1.0, 2.2, 3.9, 4.0}) {
+        double value {0};
+        ASSERT_THROW(decreasing.getValues(&eta, &value, 1) == true);
+        ASSERT_THROW(decreasing.getInverse(value, x) == true);
+        ASSERT_THROW(std::abs(x - eta) < 1e-6);
+    }
+
+    // Not invertible
+    HistoInput notMonotone("flat", "inverse.jth", "flat", "pt", "float", true);
+    notMonotone.setInverse();
+    ASSERT_THROW(notMonotone.initialize() == false);
+    HistoInput twoDims("map", "inverse.jth", "map", "pt", "float", true, "abseta", "float", true);
+    twoDims.setInverse();
+    ASSERT_THROW(twoDims.initialize() == false);
+    HistoInput notRequested("flat", "inverse.jth", "flat", "pt", "float", true);
+    ASSERT_THROW(notRequested.initialize() == true);
+    ASSERT_THROW(notRequested.getInverse(2, x) == false);
+
+    // Lossy kernels
+    HistoInput surrogate("surrogate", "inverse.jth", "response", "pt", "float", true);
+    surrogate.setSurrogate(0.1);
+    surrogate.setInverse();
+    ASSERT_THROW(surrogate.initialize() == false);
+    HistoInput quantized("quantized", "inverse.jth", "response", "pt", "float", true);
+    quantized.setCompression(HistoCompression{true, 0.01});
+    quantized.setInverse();
+    ASSERT_THROW(quantized.initialize() == false);
+    HistoInput compressed("compressed", "inverse.jth", "response", "pt", "float", true);
+    compressed.setCompression(HistoCompression{true, 0.});
+    compressed.setInverse();
+    ASSERT_THROW(compressed.initialize() == true);
+    ASSERT_THROW(compressed.getInverse(values[0], x) == true);
+    ASSERT_THROW(std::abs(x - pts[0]) < 1e-9*pts[0]);
+    HistoTuning tuning;
+    tuning.maxError = 0.1;
+    HistoInput tuned("tuned", "inverse.jth", "response", "pt", "float", true);
+    tuned.setTuning(tuning);
+    tuned.setInverse();
+    ASSERT_THROW(tuned.initialize() == true);
+    ASSERT_THROW(tuned.getKernel() == HistoKernel::Table || tuned.getKernel() == HistoKernel::CompressedTable);
+    ASSERT_THROW(tuned.getInverse(values[0], x) == true);
+
+    std::remove("inverse.jth");
+
+    TEST_END("HistoInverse Unit Test");
+    return 0;
+}
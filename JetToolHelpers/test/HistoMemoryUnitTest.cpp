@@ -0,0 +1,129 @@
+/**
+ * @file HistoMemoryUnitTest.cpp
+ * @author S. Schramm, A. Freeman
+ * @brief The memory accounting must add up and evicted inputs must keep working.
+ *
+ * What we test for :
+ * - every initialized input reports its bytes, per input, per file and in total.
+ * - under a budget the least recently evaluated inputs are evicted until it fits.
+ * - an evicted input reads its histogram again and gives the same values, also
+ * when several threads evaluate inputs evicting each other.
+ */
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "TFile.h"
+
+#include "JetToolHelpers/HistoInput.h"
+#include "JetToolHelpers/HistoMemoryManager.h"
+#include "test/Test.h"
+
+// Histograms of different sizes with content depending on the bin
+void writeCalibrations(const std::string& fileName, const int nHists) {
+    TFile file(fileName.c_str(), "RECREATE");
+    for (int h = 0; h < nHists; h++) {
+        Test::writeHistogram(file, "calibration" + std::to_string(h), {100 * (h + 1), 0, 5000, {}},
+            [h](int i, int, double, double) { return h + 0.001 * i; });
+    }
+    file.Close();
+}
+
+int main() {
+    TEST_BEGIN("HistoMemory Unit Test");
+
+    HistoMemoryManager& manager {HistoMemoryManager::instance()};
+    ASSERT_EQUAL(manager.getTotalBytes(), std::size_t(0));
+
+    writeCalibrations("memory_a.root", 4);
+    writeCalibrations("memory_b.root", 2);
+    std::vector<std::unique_ptr<HistoInput>> inputs;
+    for (int h = 0; h < 4; h++)
+        inputs.push_back(std::make_unique<HistoInput>("a" + std::to_string(h), "memory_a.root",
+            "calibration" + std::to_string(h), "pt", "float", true));
+    for (int h = 0; h < 2; h++)
+        inputs.push_back(std::make_unique<HistoInput>("b" + std::to_string(h), "memory_b.root",
+            "calibration" + std::to_string(h), "pt", "float", true));
+
+    // only initialized inputs are accounted
+    ASSERT_EQUAL(inputs[0]->getMemoryUsage(), std::size_t(0));
+    for (auto& input : inputs)
+        ASSERT_THROW(input->initialize() == true);
+
+    std::size_t sum {0};
+    for (auto& input : inputs) {
+        ASSERT_THROW(input->getMemoryUsage() > 0);
+        sum += input->getMemoryUsage();
+    }
+    ASSERT_THROW(inputs[3]->getMemoryUsage() > inputs[0]->getMemoryUsage());
+    ASSERT_EQUAL(manager.getTotalBytes(), sum);
+    ASSERT_EQUAL(manager.getBytesPerInput().size(), inputs.size());
+    const auto perFile {manager.getBytesPerFile()};
+    ASSERT_EQUAL(perFile.size(), std::size_t(2));
+    ASSERT_EQUAL(perFile.at("memory_a.root") + perFile.at("memory_b.root"), sum);
+    ASSERT_EQUAL(perFile.at("memory_b.root"), inputs[4]->getMemoryUsage() + inputs[5]->getMemoryUsage());
+
+    JetContext jc;
+    std::vector<xAOD::Jet> jets;
+    for (int i = 0; i < 50; i++)
+        jets.push_back(xAOD::Jet{10. + 97.3 * i, 1., 0., 10.});
+    std::vector<std::vector<double>> expected(inputs.size());
+    for (std::size_t h = 0; h < inputs.size(); h++)
+        for (const xAOD::Jet& jet : jets)
+            expected[h].push_back(static_cast<const IInputBase&>(*inputs[h]).getValue(jet, jc));
+
+    // half of the memory : some inputs go, the total fits
+    manager.setBudget(sum / 2);
+    ASSERT_THROW(manager.getNumEvictions() > 0);
+    ASSERT_THROW(manager.getTotalBytes() <= sum / 2);
+    std::size_t nEvicted {0};
+    for (auto& input : inputs)
+        nEvicted += input->getMemoryUsage() == 0;
+    ASSERT_THROW(nEvicted > 0);
+
+    // evicted inputs come back transparently, evicting others
+    for (int repeat = 0; repeat < 3; repeat++) {
+        for (std::size_t h = 0; h < inputs.size(); h++) {
+            for (std::size_t j = 0; j < jets.size(); j++)
+                ASSERT_EQUAL(static_cast<const IInputBase&>(*inputs[h]).getValue(jets[j], jc), expected[h][j]);
+            ASSERT_THROW(inputs[h]->getMemoryUsage() > 0);
+            ASSERT_THROW(manager.getTotalBytes() <= sum / 2);
+        }
+    }
+
+    // threads evaluating all the inputs under a budget fitting about one of them
+    manager.setBudget(inputs[3]->getMemoryUsage());
+    std::atomic<int> nWrong {0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([&, t]() {
+            for (int repeat = 0; repeat < 20; repeat++) {
+                for (std::size_t h = 0; h < inputs.size(); h++) {
+                    const std::size_t input {(h + t) % inputs.size()};
+                    for (std::size_t j = 0; j < jets.size(); j++) {
+                        double value {0};
+                        if (!inputs[input]->getValue(jets[j], jc, value) || value != expected[input][j])
+                            ++nWrong;
+                    }
+                }
+            }
+        });
+    }
+    for (std::thread& thread : threads)
+        thread.join();
+    ASSERT_EQUAL(nWrong.load(), 0);
+
+    // no limit anymore, finalized and destroyed inputs leave the accounting
+    manager.setBudget(0);
+    ASSERT_THROW(inputs[0]->finalize() == true);
+    ASSERT_EQUAL(inputs[0]->getMemoryUsage(), std::size_t(0));
+    inputs.clear();
+    ASSERT_EQUAL(manager.getTotalBytes(), std::size_t(0));
+    ASSERT_THROW(manager.getBytesPerInput().empty());
+
+    TEST_END("HistoMemory Unit Test");
+    return 0;
+}
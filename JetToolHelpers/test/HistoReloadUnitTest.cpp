@@ -0,0 +1,158 @@
+/**
+ * @file HistoReloadUnitTest.cpp
+ * @author S. Schramm, A. Freeman
+ * @brief Reloading a histogram must not disturb the threads evaluating it.
+ *
+ * What we test for :
+ * - evaluating threads only ever see the previous or the new histogram.
+ * - reload() and reloadAsync() switch to the contents and binning now in the file.
+ * - a failed reload keeps the previous histogram, reloading requires initialize().
+ * - a thread refused a reader slot, all of them being held, is protected by its next
+ *   guard once slots are free again.
+ */
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "TFile.h"
+
+#include "JetToolHelpers/EpochReclaimer.h"
+#include "JetToolHelpers/HistoInput.h"
+#include "test/Test.h"
+
+// Sets the flag when the reclaimer deletes it
+struct Tracked {
+    std::atomic<bool>* deleted;
+    ~Tracked() { deleted->store(true); }
+};
+
+// A histogram that is constant, so that every jet gets content
+void writeCalibration(const int nBins, const double content) {
+    TFile file("reload.root", "RECREATE");
+    Test::writeHistogram(file, "calibration", {nBins, 0, 5000, {}}, [content](int, int, double, double) { return content; });
+    file.Close();
+}
+
+int main() {
+    TEST_BEGIN("HistoReload Unit Test");
+
+    writeCalibration(10, 1.);
+    HistoInput histogram("Reloaded histogram", "reload.root", "calibration", "pt", "float", true);
+    ASSERT_THROW(histogram.reload() == false);
+    ASSERT_THROW(histogram.initialize() == true);
+
+    std::atomic<bool> stop {false};
+    std::atomic<int> nUnexpected {0};
+    std::atomic<long> nEvaluated {0};
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 4; i++) {
+        readers.emplace_back([&, i]() {
+            JetContext jc;
+            const xAOD::Jet jet {100. + i, 1., 0., 10.};
+            while (!stop.load()) {
+                double value {0};
+                if (!histogram.getValue(jet, jc, value) || (value != 1. && value != 2. && value != 3.))
+                    ++nUnexpected;
+                ++nEvaluated;
+            }
+        });
+    }
+
+    JetContext jc;
+    const xAOD::Jet jet {100., 1., 0., 10.};
+    double value {0};
+    for (int i = 0; i < 20; i++) {
+        writeCalibration(10 + i, 2.);
+        ASSERT_THROW(histogram.reload() == true);
+        ASSERT_THROW(histogram.getValue(jet, jc, value) == true);
+        ASSERT_EQUAL(value, 2.);
+        ASSERT_EQUAL(histogram.getTable()->axes[0].nBins, 10 + i);
+    }
+
+    writeCalibration(7, 3.);
+    ASSERT_THROW(histogram.reloadAsync().get() == true);
+    ASSERT_THROW(histogram.getValue(jet, jc, value) == true);
+    ASSERT_EQUAL(value, 3.);
+
+    // the histogram disappeared from the file, keep the last one
+    TFile("reload.root", "RECREATE").Close();
+    ASSERT_THROW(histogram.reload() == false);
+    ASSERT_THROW(histogram.getValue(jet, jc, value) == true);
+    ASSERT_EQUAL(value, 3.);
+
+    stop.store(true);
+    for (std::thread& reader : readers)
+        reader.join();
+    ASSERT_EQUAL(nUnexpected.load(), 0);
+    ASSERT_THROW(nEvaluated.load() > 0);
+
+    ASSERT_THROW(histogram.finalize() == true);
+    ASSERT_THROW(histogram.reload() == false);
+
+    // The main thread holds a slot, so one of MAXTHREADS more readers is refused
+    std::mutex mutex;
+    std::condition_variable changed;
+    int nHolding {0}, nRefused {0};
+    bool released {false}, guarded {false}, done {false};
+    std::vector<std::thread> holders;
+    for (std::size_t i = 0; i < EpochReclaimer::MAXTHREADS; i++) {
+        holders.emplace_back([&]() {
+            std::unique_lock<std::mutex> lock(mutex, std::defer_lock);
+            try {
+                EpochReclaimer::Guard guard;
+                lock.lock();
+                ++nHolding;
+                changed.notify_all();
+                changed.wait(lock, [&] { return released; });
+                return;
+            } catch (const std::runtime_error&) {
+                lock.lock();
+                ++nRefused;
+                changed.notify_all();
+                changed.wait(lock, [&] { return released; });
+                lock.unlock();
+            }
+            // Retried until the holders exited
+            while (true) {
+                try {
+                    EpochReclaimer::Guard guard;
+                    lock.lock();
+                    guarded = true;
+                    changed.notify_all();
+                    changed.wait(lock, [&] { return done; });
+                    return;
+                } catch (const std::runtime_error&) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        changed.wait(lock, [&] { return nHolding + nRefused == static_cast<int>(EpochReclaimer::MAXTHREADS); });
+        ASSERT_EQUAL(nRefused, 1);
+        released = true;
+        changed.notify_all();
+        changed.wait(lock, [&] { return guarded; });
+    }
+    std::atomic<bool> deleted {false};
+    EpochReclaimer::instance().retire(new Tracked{&deleted});
+    EpochReclaimer::instance().reclaim();
+    ASSERT_THROW(!deleted.load());
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        done = true;
+        changed.notify_all();
+    }
+    for (std::thread& holder : holders)
+        holder.join();
+    EpochReclaimer::instance().reclaim();
+    ASSERT_THROW(deleted.load());
+
+    TEST_END("HistoReload Unit Test");
+    return 0;
+}
@@ -0,0 +1,145 @@
+/**
+ * @file HistoTableUnitTest.cpp
+ * @author S. Schramm, A. Freeman
+ * @brief HistoTable replaces the ROOT objects on the evaluation path, it 
+ * must return exactly what TAxis and TH1/TH2::Interpolate return.
+ * 
+ * What we test for : 
+ * - enforceRange() against RootHistoLoader::enforceAxisRange(), fixed and variable bins.
+ * - interpolate() against TH1::Interpolate(), 1D and 2D, fixed and variable bins.
+ * - inconsistent binnings are refused.
+ * - compressed tables give the same results, constant and identical contents are stored once,
+ *   quantized contents stay within the tolerance.
+ */
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "TH1.h"
+#include "TH2.h"
+
+#include "JetToolHelpers/RootHistoLoader.h"
+#include "JetToolHelpers/HistoTable.h"
+#include "test/Test.h"
+
+void compareAxis(const TAxis& axis, const HistoAxis& compiled, std::mt19937& gen) {
+    const double width {axis.GetXmax() - axis.GetXmin()};
+    std::uniform_real_distribution<double> dist(axis.GetXmin() - 0.2*width, axis.GetXmax() + 0.2*width);
+    for (int i = 0; i < 10000; i++) {
+        const double x {dist(gen)};
+        ASSERT_EQUAL(compiled.findBin(x), axis.FindFixBin(x));
+        ASSERT_EQUAL(compiled.enforceRange(x), RootHistoLoader::enforceAxisRange(axis, x));
+    }
+    for (int bin = 0; bin <= axis.GetNbins() + 1; bin++) {
+        ASSERT_EQUAL(compiled.getBinCenter(bin), axis.GetBinCenter(bin));
+        ASSERT_EQUAL(compiled.getBinUpEdge(bin), axis.GetBinUpEdge(bin));
+        ASSERT_EQUAL(compiled.findBin(axis.GetBinLowEdge(bin)), axis.FindFixBin(axis.GetBinLowEdge(bin)));
+    }
+    ASSERT_EQUAL(compiled.findBin(axis.GetXmax()), axis.FindFixBin(axis.GetXmax()));
+}
+
+void testHisto(const TH1& hist, const HistoCompression& compression = HistoCompression()) {
+    std::shared_ptr<const HistoTable> table {RootHistoLoader::compileHisto(hist, compression)};
+    ASSERT_THROW(table != nullptr);
+    ASSERT_EQUAL(table->nDims, hist.GetDimension());
+
+    std::mt19937 gen(1234);
+    compareAxis(*hist.GetXaxis(), table->axes[0], gen);
+    if (hist.GetDimension() > 1)
+        compareAxis(*hist.GetYaxis(), table->axes[1], gen);
+
+    // Inputs are always within the axes once enforceRange() was applied
+    std::uniform_real_distribution<double> unit(-0.1, 1.1);
+    const TAxis& xAxis {*hist.GetXaxis()};
+    const TAxis& yAxis {*hist.GetYaxis()};
+    for (int i = 0; i < 10000; i++) {
+        const double x {RootHistoLoader::enforceAxisRange(xAxis, xAxis.GetXmin() + unit(gen)*(xAxis.GetXmax() - xAxis.GetXmin()))};
+        if (hist.GetDimension() == 1) {
+            ASSERT_EQUAL(table->interpolate(x), hist.Interpolate(x));
+            continue;
+        }
+        const double y {RootHistoLoader::enforceAxisRange(yAxis, yAxis.GetXmin() + unit(gen)*(yAxis.GetXmax() - yAxis.GetXmin()))};
+        ASSERT_EQUAL(table->interpolate(x, y), hist.Interpolate(x, y));
+    }
+}
+
+int main() {
+    TEST_BEGIN("HistoTable Unit Test");
+
+    std::mt19937 gen(43294);
+    std::uniform_real_distribution<double> content(-1, 1);
+    const std::vector<double> ptEdges {15, 20, 25, 35, 50, 75, 100, 150, 250, 500, 1000, 2500};
+    const std::vector<double> etaEdges {0, 0.3, 0.8, 1.2, 1.37, 1.52, 2.0, 2.5, 3.2, 4.5};
+
+    TH1D fixed1D("fixed1D", "", 37, -2.5, 4.1);
+    TH1F variable1D("variable1D", "", ptEdges.size() - 1, ptEdges.data());
+    TH2D fixed2D("fixed2D", "", 23, 15, 2500, 17, 0, 4.5);
+    TH2F variable2D("variable2D", "", ptEdges.size() - 1, ptEdges.data(), etaEdges.size() - 1, etaEdges.data());
+    for (TH1* hist : std::vector<TH1*>{&fixed1D, &variable1D})
+        for (int i = 1; i <= hist->GetNbinsX(); i++)
+            hist->SetBinContent(i, content(gen));
+    for (TH1* hist : std::vector<TH1*>{&fixed2D, &variable2D})
+        for (int i = 1; i <= hist->GetNbinsX(); i++)
+            for (int j = 1; j <= hist->GetNbinsY(); j++)
+                hist->SetBinContent(i, j, content(gen));
+
+    testHisto(fixed1D);
+    testHisto(variable1D);
+    testHisto(fixed2D);
+    testHisto(variable2D);
+
+    // lossless compression doesn't change any result
+    HistoCompression exact;
+    exact.enabled = true;
+    testHisto(fixed1D, exact);
+    testHisto(variable1D, exact);
+    testHisto(fixed2D, exact);
+    testHisto(variable2D, exact);
+
+    // constant regions are stored as single values
+    TH2D flat("flat", "", 100, 0, 1, 50, 0, 1);
+    for (int i = 1; i <= flat.GetNbinsX(); i++)
+        for (int j = 1; j <= flat.GetNbinsY(); j++)
+            flat.SetBinContent(i, j, i > 90 ? content(gen) : 1.);
+    testHisto(flat, exact);
+    std::shared_ptr<const HistoTable> compressed {RootHistoLoader::compileHisto(flat, exact)};
+    ASSERT_THROW(compressed->tiles != nullptr);
+    ASSERT_THROW(compressed->getNumBytes() < RootHistoLoader::compileHisto(flat)->getNumBytes() / 2);
+
+    // identical contents are shared between tables, not copied
+    TH2D copy(flat);
+    copy.SetName("copy");
+    std::shared_ptr<const HistoTable> shared {RootHistoLoader::compileHisto(copy, exact)};
+    ASSERT_THROW(shared->tiles == compressed->tiles);
+    ASSERT_THROW(shared->contents == compressed->contents);
+
+    // quantized contents are within the tolerance
+    TH2D smooth("smooth", "", 64, 0, 1, 32, 0, 1);
+    for (int i = 1; i <= smooth.GetNbinsX(); i++)
+        for (int j = 1; j <= smooth.GetNbinsY(); j++)
+            smooth.SetBinContent(i, j, 1. + 0.01*i + 0.001*j*j);
+    HistoCompression lossy {true, 1.e-5};
+    std::shared_ptr<const HistoTable> quantized {RootHistoLoader::compileHisto(smooth, lossy)};
+    ASSERT_THROW(quantized->nQuantized > 0);
+    ASSERT_THROW(quantized->getNumBytes() < RootHistoLoader::compileHisto(smooth)->getNumBytes());
+    for (int i = 1; i <= smooth.GetNbinsX(); i++)
+        for (int j = 1; j <= smooth.GetNbinsY(); j++)
+            ASSERT_THROW(std::abs(quantized->getBinContent(i, j) - smooth.GetBinContent(i, j)) <= lossy.quantizationTolerance);
+
+    // a single bin histogram interpolates to its content everywhere
+    TH1D single("single", "", 1, 0, 1);
+    single.SetBinContent(1, 0.5);
+    testHisto(single);
+
+    // binnings that don't describe a histogram are refused
+    ASSERT_THROW(HistoTable::create({{0, 0., 1., {}}}, {}) == nullptr);
+    ASSERT_THROW(HistoTable::create({{2, 1., 0., {}}}, {1., 2.}) == nullptr);
+    ASSERT_THROW(HistoTable::create({{2, 0., 1., {0., 0.5}}}, {1., 2.}) == nullptr);
+    ASSERT_THROW(HistoTable::create({{2, 0., 1., {0., 0.5, 0.5}}}, {1., 2.}) == nullptr);
+    ASSERT_THROW(HistoTable::create({{2, 0., 1., {}}}, {1.}) == nullptr);
+    ASSERT_THROW(HistoTable::create({{2, 0., 1., {}}}, {1., 2.}) != nullptr);
+
+    TEST_END("HistoTable Unit Test");
+    return 0;
+}
@@ -0,0 +1,140 @@
+/**
+ * @file HistoTuningUnitTest.cpp
+ * @author S. Schramm, A. Freeman
+ * @brief The tuned kernel must keep the accuracy contract and the cache must be used by
+ * the following initializations. Builds without ROOT.
+ *
+ * What we test for :
+ * - without tolerance only exact kernels are chosen, the values are identical.
+ * - with a tolerance the values stay within it, also at every bin center and edge, even
+ *   timed on a single point.
+ * - the choice is written to the cache, read back from it and the cached kernel is used.
+ * - a histogram changed in the file has another key.
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "JetToolHelpers/HistoFile.h"
+#include "JetToolHelpers/HistoInput.h"
+#include "JetToolHelpers/HistoTuning.h"
+#include "test/Test.h"
+
+int countLines(const std::string& fileName) {
+    std::ifstream in(fileName);
+    int nLines {0};
+    std::string line;
+    while (std::getline(in, line))
+        nLines++;
+    return nLines;
+}
+
+int main() {
+    TEST_BEGIN("HistoTuning Unit Test");
+
+    // smooth map
+    std::map<std::string, LoadedHisto> histos;
+    LoadedHisto& smooth {histos["smooth"]};
+    smooth.nDims = 2;
+    smooth.binnings.push_back(HistoAxisBinning{60, 20, 3000, {}});
+    smooth.binnings.push_back(HistoAxisBinning{45, 0, 4.5, {}});
+    for (int j = 0; j < 45; j++)
+        for (int i = 0; i < 60; i++)
+            smooth.contents.push_back(1 + 0.1*std::log(1 + i) + 0.02*j);
+    ASSERT_THROW(HistoFile::write("tuning.jth", histos) == true);
+    std::remove("tuning.cache");
+
+    HistoInput reference("reference", "tuning.jth", "smooth", "pt", "float", true, "abseta", "float", true);
+    ASSERT_THROW(reference.initialize() == true);
+    ASSERT_THROW(reference.getKernel() == HistoKernel::Table);
+
+    std::mt19937 gen(1234);
+    std::uniform_real_distribution<float> pt(0, 3500), abseta(0, 5);
+    std::vector<float> pts(1000), absetas(1000);
+    for (int i = 0; i < 1000; i++) {
+        pts[i] = pt(gen);
+        absetas[i] = abseta(gen);
+    }
+    std::vector<double> expected(1000), values(1000);
+    ASSERT_THROW(reference.getValues(pts.data(), absetas.data(), expected.data(), 1000) == true);
+
+    // exact
+    HistoTuning exact;
+    exact.nSamples = 1000;
+    exact.cacheFile = "tuning.cache";
+    HistoInput tunedExact("exact", "tuning.jth", "smooth", "pt", "float", true, "abseta", "float", true);
+    tunedExact.setTuning(exact);
+    ASSERT_THROW(tunedExact.initialize() == true);
+    ASSERT_THROW(tunedExact.getKernel() == HistoKernel::Table || tunedExact.getKernel() == HistoKernel::CompressedTable);
+    ASSERT_THROW(tunedExact.getValues(pts.data(), absetas.data(), values.data(), 1000) == true);
+    ASSERT_THROW(values == expected);
+    ASSERT_EQUAL(countLines("tuning.cache"), 1);
+
+    // within the tolerance
+    HistoTuning lossy {exact};
+    lossy.maxError = 1e-2;
+    HistoInput tunedLossy("lossy", "tuning.jth", "smooth", "pt", "float", true, "abseta", "float", true);
+    tunedLossy.setTuning(lossy);
+    ASSERT_THROW(tunedLossy.initialize() == true);
+    ASSERT_THROW(tunedLossy.getValues(pts.data(), absetas.data(), values.data(), 1000) == true);
+    for (int i = 0; i < 1000; i++)
+        ASSERT_THROW(std::abs(values[i] - expected[i]) <= lossy.maxError);
+    ASSERT_EQUAL(countLines("tuning.cache"), 2);
+
+    // at the knots of the interpolation, which the random points miss
+    std::vector<float> knotPts, knotAbsetas;
+    for (int j = 0; j <= 90; j++) {
+        for (int i = 0; i <= 120; i++) {
+            knotPts.push_back(20 + 2980.*i/120);
+            knotAbsetas.push_back(4.5*j/90);
+        }
+    }
+    std::vector<double> knotExpected(knotPts.size()), knotValues(knotPts.size());
+    ASSERT_THROW(reference.getValues(knotPts.data(), knotAbsetas.data(), knotExpected.data(), knotPts.size()) == true);
+    HistoTuning sparse {lossy};
+    sparse.nSamples = 1;
+    sparse.cacheFile = "";
+    HistoInput tunedSparse("sparse", "tuning.jth", "smooth", "pt", "float", true, "abseta", "float", true);
+    tunedSparse.setTuning(sparse);
+    ASSERT_THROW(tunedSparse.initialize() == true);
+    for (const HistoInput* tuned : {&tunedLossy, &tunedSparse}) {
+        ASSERT_THROW(tuned->getValues(knotPts.data(), knotAbsetas.data(), knotValues.data(), knotPts.size()) == true);
+        for (std::size_t i = 0; i < knotPts.size(); i++)
+            ASSERT_THROW(std::abs(knotValues[i] - knotExpected[i]) <= lossy.maxError);
+    }
+
+    // read from the cache : no new line, and a kernel forced in the cache is used
+    HistoInput cachedExact("exact", "tuning.jth", "smooth", "pt", "float", true, "abseta", "float", true);
+    cachedExact.setTuning(exact);
+    ASSERT_THROW(cachedExact.initialize() == true);
+    ASSERT_THROW(cachedExact.getKernel() == tunedExact.getKernel());
+    ASSERT_EQUAL(countLines("tuning.cache"), 2);
+
+    const std::string key {HistoTuningCache::getKey("smooth", smooth, lossy.maxError)};
+    ASSERT_THROW(HistoTuningCache::record("tuning.cache", key, HistoKernel::QuantizedTable) == true);
+    HistoKernel kernel;
+    ASSERT_THROW(HistoTuningCache::lookup("tuning.cache", key, kernel) == true);
+    ASSERT_THROW(kernel == HistoKernel::QuantizedTable);
+    HistoInput cachedLossy("lossy", "tuning.jth", "smooth", "pt", "float", true, "abseta", "float", true);
+    cachedLossy.setTuning(lossy);
+    ASSERT_THROW(cachedLossy.initialize() == true);
+    ASSERT_THROW(cachedLossy.getKernel() == HistoKernel::QuantizedTable);
+
+    // a changed histogram is tuned again
+    LoadedHisto changed {smooth};
+    changed.contents[100] += 1;
+    ASSERT_THROW(HistoTuningCache::getKey("smooth", changed, lossy.maxError) != key);
+    ASSERT_THROW(HistoTuningCache::getKey("smooth", smooth, 0.) != key);
+    ASSERT_THROW(HistoTuningCache::lookup("tuning.cache", HistoTuningCache::getKey("smooth", changed, 0.), kernel) == false);
+
+    std::remove("tuning.jth");
+    std::remove("tuning.cache");
+
+    TEST_END("HistoTuning Unit Test");
+    return 0;
+}
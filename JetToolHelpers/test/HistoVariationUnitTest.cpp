@@ -0,0 +1,104 @@
+/**
+ * @file HistoVariationUnitTest.cpp
+ * @author S. Schramm, A. Freeman
+ * @brief Reusing the bin search and contents between nearby points must not change
+ * any value.
+ *
+ * What we test for :
+ * - findBin() with any hint finds the bin findBin() finds.
+ * - interpolate() carrying a cell along a random walk returns the plain interpolation.
+ * - getVariations() returns what getValues() returns for the shifted axis values.
+ */
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "TFile.h"
+
+#include "JetToolHelpers/HistoInput.h"
+#include "test/Test.h"
+
+void writeCalibrations() {
+    TFile file("variation.root", "RECREATE");
+    const HistoAxisBinning pt {Test::geometricBinning(15, 3000, 1.17)};
+    const HistoAxisBinning eta {8, 0, 4.5, {0, 0.3, 0.8, 1.2, 1.6, 2.1, 2.8, 3.6, 4.5}};
+    Test::writeHistogram(file, "calibration1D", pt, [](int i, int, double, double) { return 1. / i; });
+    Test::writeHistogram(file, "calibration2D", pt, eta, [](int i, int j, double, double) { return i + 0.01*i*j; });
+    file.Close();
+}
+
+int main() {
+    TEST_BEGIN("HistoVariation Unit Test");
+
+    writeCalibrations();
+    HistoInput input1D("1D", "variation.root", "calibration1D", "pt", "float", true);
+    HistoInput input2D("2D", "variation.root", "calibration2D", "pt", "float", true, "abseta", "float", true);
+    ASSERT_THROW(input1D.initialize() == true);
+    ASSERT_THROW(input2D.initialize() == true);
+    const std::shared_ptr<const HistoTable> table1D {input1D.getTable()};
+    const std::shared_ptr<const HistoTable> table2D {input2D.getTable()};
+    const HistoAxis& ptAxis {table2D->axes[0]};
+
+    std::mt19937 gen(9431);
+    std::uniform_real_distribution<double> ptDist(0, 3500);
+    std::uniform_real_distribution<double> etaDist(-0.5, 5);
+    std::normal_distribution<double> step(0, 30);
+    std::uniform_int_distribution<int> hintDist(-1, ptAxis.nBins + 2);
+    for (int i = 0; i < 10000; i++) {
+        const double x {ptDist(gen)};
+        ASSERT_EQUAL(ptAxis.findBin(x, hintDist(gen)), ptAxis.findBin(x));
+        ASSERT_EQUAL(ptAxis.findBin(x, ptAxis.findBin(x) + 1), ptAxis.findBin(x));
+        ASSERT_EQUAL(ptAxis.findBin(x, ptAxis.findBin(x) - 1), ptAxis.findBin(x));
+    }
+    ASSERT_EQUAL(ptAxis.findBin(ptAxis.xMax, ptAxis.nBins), ptAxis.nBins + 1);
+
+    HistoCell cell1D, cell2D;
+    double x {100}, y {1};
+    for (int i = 0; i < 100000; i++) {
+        x += step(gen);
+        y += step(gen) / 100;
+        if (i % 1000 == 0) {
+            x = ptDist(gen);
+            y = etaDist(gen);
+        }
+        ASSERT_EQUAL(table1D->interpolate(x, cell1D), table1D->interpolate(x));
+        ASSERT_EQUAL(table2D->interpolate(x, y, cell2D), table2D->interpolate(x, y));
+    }
+
+    // nominal and systematic shifts of pt and eta, some crossing bins and the axis ranges
+    const std::vector<HistoShift> shifts {
+        {{1.01, 1}, {0, 0}}, {{0.99, 1}, {0, 0}}, {{1.05, 1}, {0, 0}}, {{0.95, 1}, {0, 0}},
+        {{1, 1}, {0, 0.05}}, {{1, 1}, {0, -0.05}}, {{1.02, 1}, {0, 0.1}}, {{2, 1}, {0, 0}}
+    };
+    JetContext jc;
+    std::vector<double> values(shifts.size() + 1);
+    for (int i = 0; i < 2000; i++) {
+        const xAOD::Jet jet {ptDist(gen), etaDist(gen), 0., 10.};
+        std::vector<float> pts {static_cast<float>(jet.pt())};
+        std::vector<float> etas {static_cast<float>(std::abs(jet.eta()))};
+        for (const HistoShift& shift : shifts) {
+            pts.push_back(pts[0]*shift.scales[0] + shift.offsets[0]);
+            etas.push_back(etas[0]*shift.scales[1] + shift.offsets[1]);
+        }
+        std::vector<double> expected(pts.size());
+
+        ASSERT_THROW(input1D.getVariations(jet, jc, shifts.data(), shifts.size(), values.data()) == true);
+        ASSERT_THROW(input1D.getValues(pts.data(), expected.data(), pts.size()) == true);
+        ASSERT_THROW(values == expected);
+
+        ASSERT_THROW(input2D.getVariations(jet, jc, shifts.data(), shifts.size(), values.data()) == true);
+        ASSERT_THROW(input2D.getValues(pts.data(), etas.data(), expected.data(), pts.size()) == true);
+        ASSERT_THROW(values == expected);
+    }
+
+    // only the nominal value
+    const xAOD::Jet jet {250., 1.3, 0., 10.};
+    double nominal {0};
+    ASSERT_THROW(input2D.getVariations(jet, jc, nullptr, 0, values.data()) == true);
+    ASSERT_THROW(input2D.getValue(jet, jc, nominal) == true);
+    ASSERT_EQUAL(values[0], nominal);
+
+    TEST_END("HistoVariation Unit Test");
+    return 0;
+}
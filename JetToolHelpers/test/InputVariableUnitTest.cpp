@@ -11,6 +11,7 @@
  * What we test for : 
  * - Creating supported variables (jetVar or not jetVar).
  * - Creating unsupported variables (jetVar or not).
+ * - Reading generic jet attributes, available or not.
  * - getting var name, getting scale, setting scale.
  * - getting GeV setting GeV...
  */
@@ -46,12 +47,50 @@ void testSupportedNames() {
     c = InputVariable::createVariable("y", "double", true);
     ASSERT_THROW(c->getName() == "y");
 
+    // not a predefined name : a generic jet attribute, of a supported type only
     std::unique_ptr<InputVariable> a = InputVariable::createVariable("random", "float", true);
+    ASSERT_THROW(a != nullptr);
+    ASSERT_THROW(a->getName() == "random");
+
+    a = InputVariable::createVariable("random", "string", true);
+    ASSERT_THROW(a == nullptr);
+
+    // an attribute name can only have one type
+    a = InputVariable::createVariable("random", "int", true);
     ASSERT_THROW(a == nullptr);
 
     std::unique_ptr<InputVariable> b = InputVariable::createVariable("e", "double", false);
     ASSERT_THROW(b == nullptr);
 }
+void testJetAttributes() {
+    std::unique_ptr<InputVariable> width = InputVariable::createVariable("Width", "float", true);
+    std::unique_ptr<InputVariable> nTrk = InputVariable::createVariable("NumTrkPt1000", "int", true);
+    ASSERT_THROW(width != nullptr);
+    ASSERT_THROW(nTrk != nullptr);
+
+    JetContext jc;
+    xAOD::Jet jet{30, 1.2, 0, 0};
+    xAOD::Jet other{40, -0.5, 0, 0};
+
+    // not decorated yet
+    ASSERT_EQUAL(width->getValue(jet, jc), InputVariable::ERRORVALUE);
+    ASSERT_EQUAL(nTrk->getValue(jet, jc), InputVariable::ERRORVALUE);
+
+    jet.setAttribute("Width", 0.125f);
+    SG::AuxElement::Accessor<int>("NumTrkPt1000").set(jet, 7);
+    ASSERT_EQUAL(width->getValue(jet, jc), 0.125f);
+    ASSERT_EQUAL(nTrk->getValue(jet, jc), 7);
+    
+    // attributes are per jet
+    ASSERT_EQUAL(width->getValue(other, jc), InputVariable::ERRORVALUE);
+    other.setAttribute("Width", 0.25f);
+    ASSERT_EQUAL(width->getValue(other, jc), 0.25f);
+    ASSERT_EQUAL(width->getValue(jet, jc), 0.125f);
+
+    // the scale applies to attributes as to any variable
+    width->setScale(2.f);
+    ASSERT_EQUAL(width->getValue(jet, jc), 0.25f);
+}
 /*
 void testSupportedFunctions() {
     xAOD::TEvent event;
@@ -99,6 +138,7 @@ int main() {
     TEST_BEGIN("InputVariable Unit Test");
 
     testSupportedNames();
+    testJetAttributes();
     
     TEST_END("InputVariable Unit Test");
     return 0;
@@ -19,8 +19,13 @@
  * What we have to test is :  => results in compilation error.
  * - Inserting unsupported types
  * - Inserting supported types
+ * - Clearing and reusing a context, beyond its inline storage.
+ * - Looking up with std::string, const char* and std::string_view keys.
  */
 
+#include <string>
+#include <string_view>
+
 #include "JetToolHelpers/JetContext.h"
 #include "test/Test.h"
 
@@ -59,5 +64,34 @@ int main() {
 
     EXPECT_EXCEPTION(jc.setValue("double!", 12.25), std::invalid_argument);
 
+    // all key types find the same entry
+    const std::string key {"atchoum"};
+    ASSERT_EQUAL(jc.isAvailable(key), true);
+    ASSERT_EQUAL(jc.isAvailable(std::string_view(key)), true);
+    ASSERT_EQUAL(jc.getValue<int>(std::string_view("atchoum_suffix").substr(0, 7)), 10);
+    ASSERT_EQUAL(jc.isAvailable(std::string_view("atch")), false);
+
+    // clear() empties the context, which can then be filled again
+    jc.clear();
+    ASSERT_EQUAL(jc.size(), 0);
+    ASSERT_EQUAL(jc.isAvailable("machuPichu"), false);
+    ASSERT_EQUAL(jc.isAvailable("atchoum"), false);
+    EXPECT_EXCEPTION(jc.getValue<int>("atchoum"), std::invalid_argument);
+
+    // more entries than fit in the inline storage, with names too long for small strings
+    for (int event = 0; event < 3; event++) {
+        const std::size_t nEntries {3 * JetContext::INLINESIZE + event};
+        for (std::size_t i = 0; i < nEntries; i++)
+            ASSERT_EQUAL(jc.setValue("aVeryLongEventLevelVariableName_" + std::to_string(i), static_cast<int>(i + event)), true);
+        ASSERT_EQUAL(jc.size(), nEntries);
+        for (std::size_t i = 0; i < nEntries; i++)
+            ASSERT_EQUAL(jc.getValue<int>("aVeryLongEventLevelVariableName_" + std::to_string(i)), static_cast<int>(i + event));
+        ASSERT_EQUAL(jc.setValue("aVeryLongEventLevelVariableName_0", 1.5f), false);
+        ASSERT_EQUAL(jc.setValue("aVeryLongEventLevelVariableName_0", 1.5f, true), true);
+        ASSERT_EQUAL(jc.getValue<float>("aVeryLongEventLevelVariableName_0"), 1.5f);
+        ASSERT_EQUAL(jc.size(), nEntries);
+        jc.clear();
+    }
+
     TEST_END("JetContext Unit Test");
 }
\ No newline at end of file
@@ -1,9 +1,14 @@
 #include <iostream>
 #include <random>
 #include <limits>
+#include <vector>
+#include <cmath>
+#include <cstdint>
 
 #include "JetToolHelpers/InputVariable.h"
 #include "JetToolHelpers/HistoInput.h"
+#include "JetToolHelpers/HistoBundle.h"
+#include "JetToolHelpers/NumaTopology.h"
 
 #include "test/Test.h"
 
@@ -30,8 +35,80 @@ int main() {
         xAOD::Jet jet{distribution(generator), distribution(generator), distribution(generator), distribution(generator)};
         ASSERT_THROW(myH1D.getValue(jet, jc, value) == true);
     }*/
-    
-    
+
+    // the batch entry points must agree with getValue() jet by jet
+    HistoInput myH2D = HistoInput("Test HistoGram 2D", fileName, histName2D, "pt", "float", true, "abseta", "float", true);
+    ASSERT_THROW(myH2D.initialize() == true);
+
+    std::uniform_real_distribution<double> kinematics(-10000, 10000);
+    const std::size_t nJets {1000};
+    std::vector<double> pts(nJets), absetas(nJets), values1D(nJets), values2D(nJets);
+    for (std::size_t i = 0; i < nJets; i++) {
+        pts[i] = kinematics(generator);
+        absetas[i] = std::abs(kinematics(generator));
+    }
+    ASSERT_THROW(myH1D.getValues(pts.data(), values1D.data(), nJets) == true);
+    ASSERT_THROW(myH2D.getValues(pts.data(), absetas.data(), values2D.data(), nJets) == true);
+    for (std::size_t i = 0; i < nJets; i++) {
+        xAOD::Jet jet{pts[i], absetas[i], 0, 0};
+        ASSERT_THROW(myH1D.getValue(jet, jc, value) == true);
+        ASSERT_EQUAL(values1D[i], value);
+        ASSERT_THROW(myH2D.getValue(jet, jc, value) == true);
+        ASSERT_EQUAL(values2D[i], value);
+    }
+
+    // dimension mismatch between the batch and the histogram is refused
+    ASSERT_THROW(myH1D.getValues(pts.data(), absetas.data(), values2D.data(), nJets) == false);
+    ASSERT_THROW(myH2D.getValues(pts.data(), values1D.data(), nJets) == false);
+
+    // bundled inputs read a copy of their table and must not change their values
+    std::shared_ptr<HistoBundle> bundle {HistoBundle::create({&myH2D, &myH1D})};
+    ASSERT_THROW(bundle != nullptr);
+    ASSERT_EQUAL(bundle->getNumTables(), 2);
+    ASSERT_THROW(myH2D.getTable().get() == bundle->getTable(0));
+    ASSERT_THROW(myH1D.getTable().get() == bundle->getTable(1));
+    ASSERT_EQUAL(reinterpret_cast<std::uintptr_t>(bundle->getTable(0)) % HistoBundle::PAGESIZE, 0);
+    for (std::size_t i = 0; i < nJets; i++) {
+        xAOD::Jet jet{pts[i], absetas[i], 0, 0};
+        ASSERT_THROW(myH1D.getValue(jet, jc, value) == true);
+        ASSERT_EQUAL(values1D[i], value);
+        ASSERT_THROW(myH2D.getValue(jet, jc, value) == true);
+        ASSERT_EQUAL(values2D[i], value);
+    }
+
+    // a table of another binning is refused before any input switches to the bundle
+    ASSERT_THROW(myH2D.acceptsTables({myH1D.getTable()}) == false);
+    ASSERT_THROW(myH2D.acceptsTables({myH2D.getTable()}) == true);
+    HistoInput uninitialized("Not initialized", fileName, histName1D, "pt", "float", true);
+    ASSERT_THROW(HistoBundle::create({&myH2D, &uninitialized}) == nullptr);
+    ASSERT_THROW(myH2D.getTable().get() == bundle->getTable(0));
+
+    // replicas on huge pages, whichever are available, give the same values too
+    ASSERT_THROW(NumaTopology::getNumNodes() >= 1);
+    ASSERT_THROW(NumaTopology::getCurrentNode() < NumaTopology::getNumNodes());
+    for (const HistoPages pages : {HistoPages::Normal, HistoPages::Transparent, HistoPages::Explicit}) {
+        std::shared_ptr<HistoBundle> replicated {HistoBundle::create({&myH2D, &myH1D}, HistoBundleOptions{pages, 3})};
+        ASSERT_THROW(replicated != nullptr);
+        ASSERT_EQUAL(replicated->getNumReplicas(), 3);
+        ASSERT_THROW(replicated->getPages() <= pages);
+        ASSERT_THROW(myH2D.getTable().get() == replicated->getTable(0, 0));
+        for (std::size_t replica = 0; replica < 3; replica++) {
+            ASSERT_EQUAL(replicated->getNode(replica), static_cast<int>(replica) % NumaTopology::getNumNodes());
+            const std::size_t alignment {replicated->getPages() == HistoPages::Normal ? HistoBundle::PAGESIZE : HistoBundle::HUGEPAGESIZE};
+            ASSERT_EQUAL(reinterpret_cast<std::uintptr_t>(replicated->getTable(0, replica)) % alignment, 0);
+            for (std::size_t i = 0; i < nJets; i++) {
+                ASSERT_EQUAL(replicated->getTable(1, replica)->interpolate(myH1D.getTable()->axes[0].enforceRange(static_cast<float>(pts[i]))),
+                    myH1D.getTable()->interpolate(myH1D.getTable()->axes[0].enforceRange(static_cast<float>(pts[i]))));
+            }
+        }
+        for (std::size_t i = 0; i < nJets; i++) {
+            xAOD::Jet jet{pts[i], absetas[i], 0, 0};
+            ASSERT_THROW(myH1D.getValue(jet, jc, value) == true);
+            ASSERT_EQUAL(values1D[i], value);
+            ASSERT_THROW(myH2D.getValue(jet, jc, value) == true);
+            ASSERT_EQUAL(values2D[i], value);
+        }
+    }
 
     TEST_END("R4ComponentsTest");
     return 0;
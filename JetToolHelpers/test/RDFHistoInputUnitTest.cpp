@@ -0,0 +1,126 @@
+/**
+ * @file RDFHistoInputUnitTest.cpp
+ * @author S. Schramm, A. Freeman
+ * @brief The columns defined by RDFHistoInput must hold, for every event, the values
+ * HistoInput gives for its jets, whether the event loop runs on one thread or several.
+ *
+ * What we test for :
+ * - the 1D and 2D columns of every event equal HistoInput::getValue() on its jets,
+ *   events without jets included.
+ * - the values survive the event : taken after the loop, they aren't overwritten by
+ *   the later events processed in the same slot.
+ * - the same holds with ROOT::EnableImplicitMT, every slot writing its own buffer.
+ * - axis columns not matching the histogram dimension are rejected.
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "ROOT/RDataFrame.hxx"
+#include "ROOT/RVec.hxx"
+#include "TROOT.h"
+
+#include "JetToolHelpers/HistoFile.h"
+#include "JetToolHelpers/RDFHistoInput.h"
+#include "test/Test.h"
+
+namespace {
+    const unsigned int NENTRIES {20000};
+
+    // The jets of an entry, the same whichever slot generates them
+    std::vector<xAOD::Jet> makeJets(const ULong64_t entry) {
+        std::mt19937 gen(entry);
+        std::uniform_int_distribution<int> nJets(0, 8);
+        std::uniform_real_distribution<float> ptDist(10, 3500), etaDist(0, 5);
+        std::vector<xAOD::Jet> jets;
+        for (int jet = nJets(gen); jet > 0; jet--) {
+            const float pt {ptDist(gen)};
+            jets.push_back(xAOD::Jet{pt, etaDist(gen), 0, 10});
+        }
+        return jets;
+    }
+
+    void writeHistograms(const std::string& fileName) {
+        std::map<std::string, LoadedHisto> histos;
+        LoadedHisto& response {histos["response"]};
+        response.nDims = 1;
+        response.binnings.push_back(HistoAxisBinning{40, 20, 3000, {}});
+        for (int i = 0; i < 40; i++)
+            response.contents.push_back(0.8 + 0.1*std::log(1 + i));
+        LoadedHisto& map {histos["map"]};
+        map.nDims = 2;
+        map.binnings.push_back(HistoAxisBinning{30, 20, 3000, {}});
+        map.binnings.push_back(HistoAxisBinning{5, 0, 4.5, {0, 0.5, 1.2, 2, 3, 4.5}});
+        for (int j = 0; j < 5; j++)
+            for (int i = 0; i < 30; i++)
+                map.contents.push_back(1 + 0.01*i + 0.1*j*j);
+        ASSERT_THROW(HistoFile::write(fileName, histos) == true);
+    }
+
+    void checkColumns(const HistoInput& response, const HistoInput& map) {
+        ROOT::RDataFrame frame(NENTRIES);
+        ROOT::RDF::RNode df {frame.Define("pt", [](const ULong64_t entry) {
+                ROOT::RVec<float> pt;
+                for (const xAOD::Jet& jet : makeJets(entry))
+                    pt.push_back(jet.pt());
+                return pt;
+            }, {"rdfentry_"})
+            .Define("abseta", [](const ULong64_t entry) {
+                ROOT::RVec<float> abseta;
+                for (const xAOD::Jet& jet : makeJets(entry))
+                    abseta.push_back(jet.eta());
+                return abseta;
+            }, {"rdfentry_"})};
+        df = RDFHistoInput::defineAll(df, {{"response", &response, {"pt"}}, {"map", &map, {"pt", "abseta"}}});
+
+        // All the actions of an event loop gather the entries in the same order
+        auto entries {df.Take<ULong64_t>("rdfentry_")};
+        auto responses {df.Take<ROOT::RVec<double>>("response")};
+        auto maps {df.Take<ROOT::RVec<double>>("map")};
+        ASSERT_EQUAL(entries->size(), static_cast<std::size_t>(NENTRIES));
+        ASSERT_EQUAL(frame.GetNRuns(), 1u);
+
+        JetContext jc;
+        double expected {0};
+        for (std::size_t i = 0; i < entries->size(); i++) {
+            const std::vector<xAOD::Jet> jets {makeJets((*entries)[i])};
+            ASSERT_EQUAL((*responses)[i].size(), jets.size());
+            ASSERT_EQUAL((*maps)[i].size(), jets.size());
+            for (std::size_t jet = 0; jet < jets.size(); jet++) {
+                ASSERT_THROW(response.getValue(jets[jet], jc, expected) == true);
+                ASSERT_EQUAL((*responses)[i][jet], expected);
+                ASSERT_THROW(map.getValue(jets[jet], jc, expected) == true);
+                ASSERT_EQUAL((*maps)[i][jet], expected);
+            }
+        }
+    }
+}
+
+int main() {
+    TEST_BEGIN("RDFHistoInput Unit Test");
+
+    writeHistograms("rdf.jth");
+    HistoInput response("response", "rdf.jth", "response", "pt", "float", true);
+    HistoInput map("map", "rdf.jth", "map", "pt", "float", true, "abseta", "float", true);
+    ASSERT_THROW(response.initialize() == true);
+    ASSERT_THROW(map.initialize() == true);
+
+    // Axis columns for another dimension
+    ROOT::RDataFrame frame(1);
+    EXPECT_EXCEPTION(RDFHistoInput::define(frame, "map", map, {"pt"}), std::invalid_argument);
+
+    checkColumns(response, map);
+    ROOT::EnableImplicitMT(4);
+    checkColumns(response, map);
+    ROOT::DisableImplicitMT();
+
+    std::remove("rdf.jth");
+
+    TEST_END("RDFHistoInput Unit Test");
+    return 0;
+}
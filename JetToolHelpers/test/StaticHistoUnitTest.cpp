@@ -0,0 +1,74 @@
+/**
+ * @file StaticHistoUnitTest.cpp
+ * @author S. Schramm, A. Freeman
+ * @brief The generated tables must evaluate exactly like HistoInput reading the file.
+ *
+ * What we test for :
+ * - identical values, 1D and 2D, fixed and variable bins, inside and outside of the axes.
+ * - the tables are usable in constant expressions.
+ * - the input variables are those given to generate_tables.
+ */
+
+#include <random>
+#include <string>
+
+#include "JetToolHelpers/HistoInput.h"
+#include "JetToolHelpers/StaticHistoInput.h"
+#include "StaticTables.h"
+#include "test/Test.h"
+
+// Binning known at compile time
+static_assert(static_tables::fixed::table.axes[0].edges == nullptr);
+static_assert(static_tables::variable::table.axes[0].edges == static_tables::variable::xEdges);
+static_assert(static_tables::mixed::table.axes[0].nBins * static_tables::mixed::table.axes[1].nBins
+    == static_tables::mixed::table.nContents);
+
+template <typename Table>
+void compare(HistoInput& input, StaticHistoInput<Table>& generated) {
+    ASSERT_THROW(input.initialize() == true);
+    ASSERT_THROW(generated.initialize() == true);
+
+    std::mt19937 gen(9174);
+    std::uniform_real_distribution<double> pt(0, 3500);
+    std::uniform_real_distribution<double> eta(-5, 5);
+    JetContext jc;
+    for (int i = 0; i < 10000; i++) {
+        const xAOD::Jet jet {pt(gen), eta(gen), 0., 10.};
+        double expected {0}, value {0};
+        ASSERT_THROW(input.getValue(jet, jc, expected) == true);
+        ASSERT_THROW(generated.getValue(jet, jc, value) == true);
+        ASSERT_EQUAL(value, expected);
+    }
+}
+
+int main() {
+    TEST_BEGIN("StaticHisto Unit Test");
+
+    StaticHistoInput<static_tables::fixed> fixed("fixed");
+    double value {0};
+    JetContext jc;
+    ASSERT_THROW(fixed.getValue(xAOD::Jet{100., 1., 0., 10.}, jc, value) == false);
+
+    HistoInput fixedInput("fixed", "static_tables.root", "fixed", "pt", "float", true);
+    compare(fixedInput, fixed);
+    ASSERT_THROW(fixed.initialize() == false);
+
+    HistoInput variableInput("variable", "static_tables.root", "variable", "pt", "float", true);
+    StaticHistoInput<static_tables::variable> variable("variable");
+    compare(variableInput, variable);
+
+    HistoInput mixedInput("mixed", "static_tables.root", "mixed", "pt", "float", true, "abseta", "float", true);
+    StaticHistoInput<static_tables::mixed> mixed("mixed");
+    compare(mixedInput, mixed);
+
+    HistoInput uniformInput("uniform", "static_tables.root", "uniform", "pt", "float", true, "abseta", "float", true);
+    StaticHistoInput<static_tables::uniform> uniform("uniform");
+    compare(uniformInput, uniform);
+
+    ASSERT_THROW(std::string(static_tables::uniform::variables[1].name) == "abseta");
+    ASSERT_THROW(uniformInput.getValue(xAOD::Jet{100., 7., 0., 10.}, jc, value) == true);
+    ASSERT_EQUAL(StaticHistoInput<static_tables::uniform>::evaluate(100.f, 7.f), value);
+
+    TEST_END("StaticHisto Unit Test");
+    return 0;
+}
@@ -0,0 +1,45 @@
+/**
+ * @file StaticTablesFixture.cpp
+ * @author S. Schramm, A. Freeman
+ * @brief Writes the histograms StaticHistoUnitTest generates its tables from, run at
+ * build time before generate_tables.
+ */
+
+#include <cmath>
+#include <vector>
+
+#include "TFile.h"
+#include "TH1.h"
+#include "TH2.h"
+
+int main() {
+    TFile file("static_tables.root", "RECREATE");
+
+    TH1D fixed("fixed", "", 50, 20, 2500);
+    for (int i = 1; i <= fixed.GetNbinsX(); i++)
+        fixed.SetBinContent(i, 0.01 + 0.02/std::sqrt(fixed.GetBinCenter(i)));
+    file.WriteTObject(&fixed);
+
+    std::vector<double> ptEdges {15};
+    while (ptEdges.back() < 3000)
+        ptEdges.push_back(ptEdges.back() * 1.17);
+    TH1D variable("variable", "", ptEdges.size() - 1, ptEdges.data());
+    for (int i = 1; i <= variable.GetNbinsX(); i++)
+        variable.SetBinContent(i, 0.02*std::exp(-variable.GetBinCenter(i)/500.));
+    file.WriteTObject(&variable);
+
+    const double etaEdges[] {0, 0.3, 0.8, 1.2, 1.6, 2.1, 2.8, 3.6, 4.5};
+    TH2D mixed("mixed", "", ptEdges.size() - 1, ptEdges.data(), 8, etaEdges);
+    TH2D uniform("uniform", "", 60, 15, 2500, 40, 0, 4.5);
+    for (int i = 1; i <= mixed.GetNbinsX(); i++)
+        for (int j = 1; j <= mixed.GetNbinsY(); j++)
+            mixed.SetBinContent(i, j, 0.01*j/(1. + i*0.1));
+    for (int i = 1; i <= uniform.GetNbinsX(); i++)
+        for (int j = 1; j <= uniform.GetNbinsY(); j++)
+            uniform.SetBinContent(i, j, 0.01*j/(1. + i*0.1));
+    file.WriteTObject(&mixed);
+    file.WriteTObject(&uniform);
+
+    file.Close();
+    return 0;
+}
@@ -75,4 +75,56 @@ namespace Test {
     }
 }
 
+#ifdef JTH_TEST_WITH_ROOT
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "TFile.h"
+#include "TH2.h"
+
+#include "JetToolHelpers/HistoTable.h"
+
+namespace Test {
+    // content(i, j, x, y) of the bin (i, j), numbered from 1, centered on (x, y)
+    using BinContent = std::function<double(int, int, double, double)>;
+
+    // Write a TH1D of the given binning into file
+    inline void writeHistogram(TFile& file, const std::string& name, const HistoAxisBinning& x, const BinContent& content) {
+        std::unique_ptr<TH1D> hist {x.edges.empty()
+            ? new TH1D(name.c_str(), "", x.nBins, x.xMin, x.xMax)
+            : new TH1D(name.c_str(), "", x.nBins, x.edges.data())};
+        for (int i = 1; i <= x.nBins; i++)
+            hist->SetBinContent(i, content(i, 0, hist->GetBinCenter(i), 0));
+        file.WriteTObject(hist.get());
+    }
+
+    // Write a TH2D of the given binnings into file
+    inline void writeHistogram(TFile& file, const std::string& name, const HistoAxisBinning& x, const HistoAxisBinning& y,
+        const BinContent& content) {
+        std::unique_ptr<TH2D> hist;
+        if (x.edges.empty() && y.edges.empty())
+            hist.reset(new TH2D(name.c_str(), "", x.nBins, x.xMin, x.xMax, y.nBins, y.xMin, y.xMax));
+        else if (x.edges.empty())
+            hist.reset(new TH2D(name.c_str(), "", x.nBins, x.xMin, x.xMax, y.nBins, y.edges.data()));
+        else if (y.edges.empty())
+            hist.reset(new TH2D(name.c_str(), "", x.nBins, x.edges.data(), y.nBins, y.xMin, y.xMax));
+        else
+            hist.reset(new TH2D(name.c_str(), "", x.nBins, x.edges.data(), y.nBins, y.edges.data()));
+        for (int i = 1; i <= x.nBins; i++)
+            for (int j = 1; j <= y.nBins; j++)
+                hist->SetBinContent(i, j, content(i, j, hist->GetXaxis()->GetBinCenter(i), hist->GetYaxis()->GetBinCenter(j)));
+        file.WriteTObject(hist.get());
+    }
+
+    // Edges growing by factor from low until reaching high, for variable bins
+    inline HistoAxisBinning geometricBinning(const double low, const double high, const double factor) {
+        std::vector<double> edges {low};
+        while (edges.back() < high)
+            edges.push_back(edges.back() * factor);
+        return HistoAxisBinning{static_cast<int>(edges.size()) - 1, edges.front(), edges.back(), edges};
+    }
+}
+#endif
+
 #endif
\ No newline at end of file
@@ -0,0 +1,334 @@
+/**
+ * @file calibrate_ntuple.cpp
+ * @author S. Schramm, A. Freeman
+ * @brief Evaluates a set of HistoInputs on the jets of a flat ntuple and writes
+ * the values to a friend tree, one std::vector<float> branch per input.
+ *
+ * The work is split in pipeline stages running on their own threads and connected
+ * by bounded queues :
+ *  - reading : entries are read cluster by cluster into flat per-branch columns,
+ *    baskets are decompressed ahead of the reader by the TTreeCache on the
+ *    implicit multi-threading pool.
+ *  - evaluation : every input is evaluated on whole clusters with getValues().
+ *  - writing : the friend tree is filled event by event.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "TFile.h"
+#include "TROOT.h"
+#include "TTree.h"
+#include "TTreeCacheUnzip.h"
+
+#include "JetToolHelpers/BoundedQueue.h"
+#include "JetToolHelpers/HistoCapture.h"
+#include "JetToolHelpers/HistoInput.h"
+
+namespace {
+    // A jet branch read from the input tree, "|jet_eta|" reads the absolute value of jet_eta
+    struct JetBranch {
+        std::string name;
+        bool absolute;
+        std::vector<float>* buffer {nullptr};
+    };
+
+    // A HistoInput and the jet branches holding its axis values
+    struct Output {
+        std::string branch;
+        std::unique_ptr<HistoInput> input;
+        std::vector<std::size_t> axes;
+        std::vector<float> buffer;
+    };
+
+    // A group of consecutive entries travelling through the pipeline
+    struct Cluster {
+        std::vector<unsigned int> nJets;            // per entry
+        std::vector<std::vector<float>> columns;    // per jet branch, the jets of all entries
+        std::vector<std::vector<double>> results;   // per output, the jets of all entries
+    };
+
+    void usage(const char* name) {
+        printf("USAGE: %s [options] <input file> <tree name> <output file> <histogram file> <output>...\n", name);
+        printf("  <output> is <branch>=<histogram>:<jet branch>[,<jet branch>]\n");
+        printf("  a jet branch is a std::vector<float> branch, written |name| to use its absolute value\n");
+        printf("Options:\n");
+        printf("  --cluster-size N    minimum number of entries per cluster (default 10000)\n");
+        printf("  --queue-depth N     clusters in flight between two stages (default 4)\n");
+        printf("  --unzip-threads N   threads decompressing baskets, 0 disables (default 2)\n");
+        printf("  --capture FILE      record the axis values of every input to FILE, see HistoCapture.h\n");
+        printf("Example:\n");
+        printf("  %s in.root nominal friend.root R4_AllComponents.root jet_np1=EffectiveNP_1_AntiKt4EMTopo:jet_pt\n", name);
+    }
+
+    std::size_t addJetBranch(std::vector<JetBranch>& branches, std::string name) {
+        bool absolute {false};
+        if (name.size() > 2 && name.front() == '|' && name.back() == '|') {
+            absolute = true;
+            name = name.substr(1, name.size() - 2);
+        }
+        for (std::size_t i = 0; i < branches.size(); ++i)
+            if (branches[i].name == name && branches[i].absolute == absolute)
+                return i;
+        branches.push_back(JetBranch{name, absolute});
+        return branches.size() - 1;
+    }
+
+    bool parseOutput(const std::string& config, const std::string& histFile,
+                     std::vector<JetBranch>& branches, std::vector<Output>& outputs) {
+        const std::size_t equal {config.find('=')};
+        const std::size_t colon {config.find(':', equal)};
+        if (equal == std::string::npos || colon == std::string::npos || equal == 0) {
+            printf("ERROR: Malformed output \"%s\"\n", config.c_str());
+            return false;
+        }
+        Output output;
+        output.branch = config.substr(0, equal);
+        const std::string histName {config.substr(equal + 1, colon - equal - 1)};
+
+        std::vector<std::string> axes;
+        std::size_t begin {colon + 1};
+        while (begin <= config.size()) {
+            const std::size_t end {std::min(config.find(',', begin), config.size())};
+            axes.push_back(config.substr(begin, end - begin));
+            begin = end + 1;
+        }
+        for (const std::string& axis : axes)
+            output.axes.push_back(addJetBranch(branches, axis));
+
+        // The axis values come from the ntuple, not from the InputVariables of the HistoInput
+        if (axes.size() == 1)
+            output.input = std::make_unique<HistoInput>(output.branch, histFile, histName, axes[0], "float", false);
+        else if (axes.size() == 2)
+            output.input = std::make_unique<HistoInput>(output.branch, histFile, histName,
+                axes[0], "float", false, axes[1], "float", false);
+        else {
+            printf("ERROR: %zu axes given for output %s, only 1D and 2D histograms are supported\n", axes.size(), output.branch.c_str());
+            return false;
+        }
+        if (!output.input->initialize()) {
+            printf("ERROR: Failed to initialise %s from %s\n", histName.c_str(), histFile.c_str());
+            return false;
+        }
+        outputs.push_back(std::move(output));
+        return true;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    Long64_t clusterSize {10000};
+    std::size_t queueDepth {4};
+    unsigned int unzipThreads {2};
+    std::string captureName;
+
+    std::vector<std::string> arguments;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg {argv[i]};
+        if ((arg == "--cluster-size" || arg == "--queue-depth" || arg == "--unzip-threads") && i + 1 < argc) {
+            const long long value {std::atoll(argv[++i])};
+            if (value < 0) {
+                printf("ERROR: %s must not be negative\n", arg.c_str());
+                return 1;
+            }
+            if (arg == "--cluster-size")
+                clusterSize = value ? value : 1;
+            else if (arg == "--queue-depth")
+                queueDepth = value;
+            else
+                unzipThreads = value;
+        } else if (arg == "--capture" && i + 1 < argc)
+            captureName = argv[++i];
+        else
+            arguments.push_back(arg);
+    }
+    if (arguments.size() < 5) {
+        usage(argv[0]);
+        return 1;
+    }
+    const std::string& inputName  {arguments[0]};
+    const std::string& treeName   {arguments[1]};
+    const std::string& outputName {arguments[2]};
+    const std::string& histFile   {arguments[3]};
+
+    std::vector<JetBranch> branches;
+    std::vector<Output> outputs;
+    for (std::size_t i = 4; i < arguments.size(); ++i)
+        if (!parseOutput(arguments[i], histFile, branches, outputs))
+            return 1;
+
+    std::shared_ptr<HistoCapture> capture;
+    if (!captureName.empty()) {
+        capture = HistoCapture::create(captureName);
+        if (!capture) {
+            printf("ERROR: Failed to create the capture %s\n", captureName.c_str());
+            return 1;
+        }
+        for (Output& output : outputs)
+            output.input->setCapture(capture);
+    }
+
+    // The reader thread reads the input file while the main thread writes the output one
+    ROOT::EnableThreadSafety();
+    if (unzipThreads) {
+        ROOT::EnableImplicitMT(unzipThreads);
+        TTreeCacheUnzip::SetParallelUnzip(TTreeCacheUnzip::kEnable);
+    }
+
+    std::unique_ptr<TFile> inputFile {TFile::Open(inputName.c_str(), "READ")};
+    if (!inputFile || inputFile->IsZombie()) {
+        printf("ERROR: Failed to open the input file %s\n", inputName.c_str());
+        return 1;
+    }
+    TTree* tree {inputFile->Get<TTree>(treeName.c_str())};
+    if (!tree) {
+        printf("ERROR: Failed to retrieve the tree %s from %s\n", treeName.c_str(), inputName.c_str());
+        return 1;
+    }
+
+    // Only read what is needed, and let the cache prefetch it
+    tree->SetBranchStatus("*", false);
+    tree->SetCacheSize(64 << 20);
+    for (JetBranch& branch : branches) {
+        if (!tree->GetBranch(branch.name.c_str())) {
+            printf("ERROR: No branch %s in the tree %s\n", branch.name.c_str(), treeName.c_str());
+            return 1;
+        }
+        tree->SetBranchStatus(branch.name.c_str(), true);
+        tree->AddBranchToCache(branch.name.c_str(), true);
+        if (tree->SetBranchAddress(branch.name.c_str(), &branch.buffer) < 0) {
+            printf("ERROR: The branch %s is not a std::vector<float>\n", branch.name.c_str());
+            return 1;
+        }
+    }
+
+    std::unique_ptr<TFile> outputFile {TFile::Open(outputName.c_str(), "RECREATE")};
+    if (!outputFile || outputFile->IsZombie()) {
+        printf("ERROR: Failed to open the output file %s\n", outputName.c_str());
+        return 1;
+    }
+    // Same name as the input tree so that it can be added as a friend, owned by the output file
+    outputFile->cd();
+    TTree* friendTree {new TTree(treeName.c_str(), "JetToolHelpers calibration friend")};
+    std::vector<std::vector<float>*> outputBuffers;
+    outputBuffers.reserve(outputs.size());
+    for (Output& output : outputs) {
+        outputBuffers.push_back(&output.buffer);
+        friendTree->Branch(output.branch.c_str(), &outputBuffers.back());
+    }
+
+    const Long64_t numEntries {tree->GetEntries()};
+    printf("Processing %lld entries with %zu inputs...\n", numEntries, outputs.size());
+    const auto start {std::chrono::steady_clock::now()};
+
+    BoundedQueue<Cluster> toEvaluate(queueDepth);
+    BoundedQueue<Cluster> toWrite(queueDepth);
+    std::atomic<bool> failed {false};
+
+    std::thread reader([&] {
+        TTree::TClusterIterator clusters {tree->GetClusterIterator(0)};
+        Long64_t entry {clusters()};
+        while (entry < numEntries) {
+            // Extend to whole storage clusters so that baskets are decompressed once
+            Long64_t last {entry};
+            while (last < numEntries && last - entry < clusterSize)
+                last = clusters();
+            last = std::min(last, numEntries);
+
+            Cluster cluster;
+            cluster.nJets.reserve(last - entry);
+            cluster.columns.resize(branches.size());
+            for (; entry < last; ++entry) {
+                tree->GetEntry(entry);
+                const std::size_t nJets {branches.empty() ? 0 : branches[0].buffer->size()};
+                cluster.nJets.push_back(nJets);
+                for (std::size_t i = 0; i < branches.size(); ++i) {
+                    const std::vector<float>& jets {*branches[i].buffer};
+                    if (jets.size() != nJets) {
+                        printf("ERROR: Jet branches of different sizes in entry %lld\n", entry);
+                        failed = true;
+                        toEvaluate.close();
+                        return;
+                    }
+                    if (branches[i].absolute)
+                        for (float value : jets)
+                            cluster.columns[i].push_back(std::abs(value));
+                    else
+                        cluster.columns[i].insert(cluster.columns[i].end(), jets.begin(), jets.end());
+                }
+            }
+            if (!toEvaluate.push(std::move(cluster)))
+                return;
+        }
+        toEvaluate.close();
+    });
+
+    std::thread evaluator([&] {
+        Cluster cluster;
+        while (toEvaluate.pop(cluster)) {
+            const std::size_t nJets {cluster.columns.empty() ? 0 : cluster.columns[0].size()};
+            cluster.results.resize(outputs.size());
+            for (std::size_t i = 0; i < outputs.size(); ++i) {
+                const Output& output {outputs[i]};
+                std::vector<double>& values {cluster.results[i]};
+                values.resize(nJets);
+                const bool status {output.axes.size() == 1
+                    ? output.input->getValues(cluster.columns[output.axes[0]].data(), values.data(), nJets)
+                    : output.input->getValues(cluster.columns[output.axes[0]].data(),
+                        cluster.columns[output.axes[1]].data(), values.data(), nJets)};
+                if (!status) {
+                    printf("ERROR: Failed to evaluate %s\n", output.branch.c_str());
+                    failed = true;
+                    toEvaluate.close();
+                    toWrite.close();
+                    return;
+                }
+            }
+            cluster.columns.clear();
+            if (!toWrite.push(std::move(cluster)))
+                return;
+        }
+        toWrite.close();
+    });
+
+    // Writing stage on the main thread
+    Long64_t numWritten {0};
+    Long64_t numJets {0};
+    Cluster cluster;
+    while (toWrite.pop(cluster)) {
+        std::size_t offset {0};
+        for (const unsigned int nJets : cluster.nJets) {
+            for (std::size_t i = 0; i < outputs.size(); ++i) {
+                const double* values {cluster.results[i].data() + offset};
+                outputs[i].buffer.assign(values, values + nJets);
+            }
+            friendTree->Fill();
+            offset += nJets;
+        }
+        numWritten += cluster.nJets.size();
+        numJets += offset;
+    }
+    reader.join();
+    evaluator.join();
+    if (failed)
+        return 1;
+
+    outputFile->cd();
+    friendTree->Write();
+    outputFile->Close();
+    if (capture && !capture->close())
+        return 1;
+
+    const double seconds {std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count()};
+    printf("Processed %lld entries and %lld jets in %.2f s\n", numWritten, numJets, seconds);
+    printf("Throughput: %.4g jets/s, %.4g entries/s\n", numJets / seconds, numWritten / seconds);
+    return 0;
+}
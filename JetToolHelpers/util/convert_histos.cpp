@@ -0,0 +1,41 @@
+/**
+ * @file convert_histos.cpp
+ * @author S. Schramm, A. Freeman
+ * @brief Converts histograms of a ROOT file into the native format of HistoFile, which
+ * HistoInput reads without ROOT.
+ */
+
+#include <cstdio>
+#include <map>
+#include <string>
+
+#include "JetToolHelpers/HistoFile.h"
+#include "JetToolHelpers/RootHistoLoader.h"
+
+int main(int argc, char* argv[])
+{
+    if (argc < 4) {
+        printf("USAGE: %s <ROOT file> <output file> <histogram>...\n", argv[0]);
+        printf("Example:\n");
+        printf("  %s R4_AllComponents.root R4_AllComponents.jth EffectiveNP_1_AntiKt4EMTopo\n", argv[0]);
+        return 1;
+    }
+    const std::string inputName  {argv[1]};
+    const std::string outputName {argv[2]};
+    if (HistoLoader::getExtension(outputName) != HistoFile::EXTENSION) {
+        printf("ERROR: The output file %s must end with %s to be read by HistoInput\n", outputName.c_str(), HistoFile::EXTENSION);
+        return 1;
+    }
+
+    std::map<std::string, LoadedHisto> histos;
+    for (int i = 3; i < argc; ++i) {
+        if (!RootHistoLoader::load(inputName, argv[i], histos[argv[i]])) {
+            printf("ERROR: Failed to convert the histogram %s of %s\n", argv[i], inputName.c_str());
+            return 1;
+        }
+    }
+    if (!HistoFile::write(outputName, histos))
+        return 1;
+    printf("Converted %zu histograms into %s\n", histos.size(), outputName.c_str());
+    return 0;
+}
@@ -0,0 +1,216 @@
+/**
+ * @file generate_tables.cpp
+ * @author S. Schramm, A. Freeman
+ * @brief Writes histograms of a ROOT or .jth file into a C++ header as constexpr tables, to be
+ * evaluated by StaticHistoInput without reading the file at run time.
+ *
+ * Each histogram becomes a struct holding its edges, contents and HistoTable as constexpr
+ * members. Doubles are written as hexadecimal literals so that the tables are exactly those
+ * HistoInput compiles from the file.
+ */
+
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "JetToolHelpers/HistoLoader.h"
+
+namespace {
+    struct Variable {
+        std::string name;
+        std::string type;
+        bool isJetVar;
+    };
+
+    struct Table {
+        std::string name;
+        std::string histName;
+        std::vector<Variable> variables;
+    };
+
+    void usage(const char* name) {
+        printf("USAGE: %s <histogram file> <output header> <namespace> <table>...\n", name);
+        printf("  <table> is <name>=<histogram>:<axis>[,<axis>]\n");
+        printf("  <axis> is <variable>/<type>/<jet|event>, the arguments of the HistoInput constructors\n");
+        printf("Example:\n");
+        printf("  %s R4_AllComponents.root R4Tables.h r4 np1=EffectiveNP_1_AntiKt4EMTopo:pt/float/jet\n", name);
+    }
+
+    bool isIdentifier(const std::string& name) {
+        if (name.empty() || std::isdigit(static_cast<unsigned char>(name[0])))
+            return false;
+        for (const char c : name)
+            if (!std::isalnum(static_cast<unsigned char>(c)) && c != '_')
+                return false;
+        return true;
+    }
+
+    bool parseTable(const std::string& config, Table& table) {
+        const std::size_t equal {config.find('=')};
+        const std::size_t colon {config.find(':', equal)};
+        if (equal == std::string::npos || colon == std::string::npos || !isIdentifier(config.substr(0, equal))) {
+            printf("ERROR: Malformed table \"%s\"\n", config.c_str());
+            return false;
+        }
+        table.name = config.substr(0, equal);
+        table.histName = config.substr(equal + 1, colon - equal - 1);
+
+        std::size_t begin {colon + 1};
+        while (begin <= config.size()) {
+            const std::size_t end {std::min(config.find(',', begin), config.size())};
+            const std::string axis {config.substr(begin, end - begin)};
+            const std::size_t slash1 {axis.find('/')};
+            const std::size_t slash2 {axis.find('/', slash1 + 1)};
+            const std::string where {slash2 == std::string::npos ? "" : axis.substr(slash2 + 1)};
+            if (slash1 == std::string::npos || slash2 == std::string::npos || (where != "jet" && where != "event")) {
+                printf("ERROR: Malformed axis \"%s\" of table %s\n", axis.c_str(), table.name.c_str());
+                return false;
+            }
+            table.variables.push_back(Variable{axis.substr(0, slash1), axis.substr(slash1 + 1, slash2 - slash1 - 1), where == "jet"});
+            begin = end + 1;
+        }
+        if (table.variables.size() > 2) {
+            printf("ERROR: %zu axes given for table %s, only 1D and 2D histograms are supported\n", table.variables.size(), table.name.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    // String literal of text : quotes and backslashes escaped, other characters than the
+    // printable ones written as octal escapes
+    std::string literal(const std::string& text) {
+        std::string quoted {"\""};
+        for (const char c : text) {
+            if (c == '"' || c == '\\') {
+                quoted += '\\';
+                quoted += c;
+            } else if (std::isprint(static_cast<unsigned char>(c))) {
+                quoted += c;
+            } else {
+                char buffer[8];
+                snprintf(buffer, sizeof(buffer), "\\%03o", static_cast<unsigned char>(c));
+                quoted += buffer;
+            }
+        }
+        return quoted + "\"";
+    }
+
+    // Exact literal of a double
+    std::string literal(const double value) {
+        if (std::isnan(value))
+            return "std::numeric_limits<double>::quiet_NaN()";
+        if (std::isinf(value))
+            return value > 0 ? "std::numeric_limits<double>::infinity()" : "-std::numeric_limits<double>::infinity()";
+        char buffer[64];
+        snprintf(buffer, sizeof(buffer), "%a", value);
+        return buffer;
+    }
+
+    void writeArray(std::ostream& out, const std::string& name, const double* values, const std::size_t size) {
+        out << "        static constexpr double " << name << "[] {";
+        for (std::size_t i = 0; i < size; ++i)
+            out << (i % 8 ? " " : "\n            ") << literal(values[i]) << (i + 1 < size ? "," : "");
+        out << "\n        };\n";
+    }
+
+    void writeAxis(std::ostream& out, const HistoAxis& axis, const std::string& edges) {
+        out << "                HistoAxis::make(" << axis.nBins << ", " << literal(axis.xMin) << ", " << literal(axis.xMax) << ", "
+            << literal(axis.binWidth) << ", " << literal(axis.lowClamp) << ", " << literal(axis.highClamp) << ", "
+            << (axis.edges ? edges : "nullptr") << ")";
+    }
+
+    bool writeTable(std::ostream& out, const std::string& fileName, const Table& table) {
+        LoadedHisto histo;
+        if (!HistoLoader::load(fileName, table.histName, histo))
+            return false;
+        if (histo.nDims != static_cast<int>(table.variables.size())) {
+            printf("ERROR: %s has a dimension of %d but %zu axes were given\n", table.histName.c_str(),
+                histo.nDims, table.variables.size());
+            return false;
+        }
+        const std::shared_ptr<const HistoTable> compiled {HistoTable::create(histo.binnings, histo.contents)};
+        if (!compiled)
+            return false;
+
+        out << "    // " << literal(table.histName) << "\n";
+        out << "    struct " << table.name << " {\n";
+        out << "        static constexpr const char* histName {" << literal(table.histName) << "};\n";
+        out << "        static constexpr int nDims {" << compiled->nDims << "};\n";
+        out << "        static constexpr StaticAxisVariable variables[] {";
+        for (std::size_t i = 0; i < table.variables.size(); ++i)
+            out << (i ? ", " : "") << "{" << literal(table.variables[i].name) << ", " << literal(table.variables[i].type) << ", "
+                << (table.variables[i].isJetVar ? "true" : "false") << "}";
+        out << "};\n";
+        const char* edgeNames[2] {"xEdges", "yEdges"};
+        for (int i = 0; i < compiled->nDims; ++i)
+            if (compiled->axes[i].edges)
+                writeArray(out, edgeNames[i], compiled->axes[i].edges, compiled->axes[i].nBins + 1);
+        writeArray(out, "contents", compiled->contents, compiled->nContents);
+        out << "        static constexpr HistoTable table {HistoTable::makeUncompressed(\n";
+        out << "                " << compiled->nDims << ",\n";
+        writeAxis(out, compiled->axes[0], edgeNames[0]);
+        out << ",\n";
+        if (compiled->nDims > 1)
+            writeAxis(out, compiled->axes[1], edgeNames[1]);
+        else
+            out << "                HistoAxis{}";
+        out << ",\n";
+        out << "                contents, " << compiled->nContents << ")\n";
+        out << "        };\n";
+        out << "    };\n\n";
+        return true;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 5) {
+        usage(argv[0]);
+        return 1;
+    }
+    const std::string fileName   {argv[1]};
+    const std::string headerName {argv[2]};
+    const std::string nameSpace  {argv[3]};
+    if (!isIdentifier(nameSpace)) {
+        printf("ERROR: \"%s\" is not a valid namespace\n", nameSpace.c_str());
+        return 1;
+    }
+
+    std::vector<Table> tables(argc - 4);
+    for (int i = 4; i < argc; ++i)
+        if (!parseTable(argv[i], tables[i - 4]))
+            return 1;
+
+    // Written to memory first, a failed generation must not leave a partial header
+    std::ostringstream out;
+    out << "// Generated by generate_tables from " << fileName << ", do not edit.\n\n";
+    // From the file name too, headers may share a namespace
+    std::string guard {"JET_GENERATED_" + nameSpace + "_" + headerName.substr(headerName.find_last_of("/\\") + 1)};
+    for (char& c : guard)
+        c = std::isalnum(static_cast<unsigned char>(c)) ? std::toupper(static_cast<unsigned char>(c)) : '_';
+    out << "#ifndef " << guard << "\n#define " << guard << "\n\n";
+    out << "#include <limits>\n\n";
+    out << "#include \"JetToolHelpers/StaticHistoInput.h\"\n\n";
+    out << "namespace " << nameSpace << " {\n\n";
+    for (const Table& table : tables) {
+        if (!writeTable(out, fileName, table)) {
+            printf("ERROR: Failed to generate the table %s from %s\n", table.name.c_str(), fileName.c_str());
+            return 1;
+        }
+    }
+    out << "}\n\n#endif\n";
+
+    std::ofstream header(headerName);
+    header << out.str();
+    if (!header) {
+        printf("ERROR: Failed to write %s\n", headerName.c_str());
+        return 1;
+    }
+    printf("Generated %zu tables in %s\n", tables.size(), headerName.c_str());
+    return 0;
+}
@@ -69,6 +69,9 @@ int main (int argc, char* argv[])
     numEvents = event.getEntries();
     printf("Processing %lld events...\n", numEvents);
 
+    // One JetContext reused by all events, clear() keeps its storage
+    JetContext jc;
+
     // Loop over the events
     for (Long64_t iEntry = 0; iEntry < numEvents; ++iEntry)
     {
@@ -110,8 +113,8 @@ int main (int argc, char* argv[])
             continue;
         }
 
-        // Make an empty JetContext object
-        JetContext jc;
+        // Empty the JetContext for this event
+        jc.clear();
 
         // Print some info
         printf("Event %llu:\n",eventNumber);